@@ -4,12 +4,14 @@
 \***********************************************************************/
 
 // 20170830  Remove FET simulation
+// 20201111  Support binary hit output with G4CMPHitWriter
 
 #ifndef ChargeElectrodeSensitivity_h
 #define ChargeElectrodeSensitivity_h 1
 
 #include "G4CMPElectrodeHit.hh"
 #include "G4CMPElectrodeSensitivity.hh"
+#include "G4CMPHitWriter.hh"
 #include <memory>
 
 
@@ -33,6 +35,7 @@ protected:
 
 private:
   std::ofstream output;
+  G4CMPHitWriter binaryOutput;	// Used if fileName ends in ".bin"
   G4String fileName;
 };
 
@@ -10,6 +10,7 @@
 //		ChargeConfigManager.
 //
 // 20170816  Michael Kelsey
+// 20201111  Note binary output option for HitsFile
 
 #include "ChargeConfigMessenger.hh"
 #include "ChargeConfigManager.hh"
@@ -36,7 +37,8 @@ ChargeConfigMessenger::ChargeConfigMessenger(ChargeConfigManager* mgr)
 			      "Set filename for non-uniform electric field");
 
   hitsCmd = CreateCommand<G4UIcmdWithAString>("HitsFile",
-			      "Set filename for output of phonon hit locations");
+			      "Set filename for output of charge hit locations");
+  hitsCmd->SetGuidance("Filename ending in \".bin\" selects binary output");
 
   millerCmd = CreateCommand<G4UIcmdWithAString>("orientation",
 	"Lattice orientation (Miller indices h, k, l in direct basis)");
@@ -7,6 +7,7 @@
 //
 // 20170816  Output file name moved to example-specific configuration
 // 20170830  Remove FET simulation
+// 20201111  Support binary hit output with G4CMPHitWriter
 
 #include "ChargeElectrodeSensitivity.hh"
 #include "ChargeConfigManager.hh"
@@ -43,6 +44,12 @@ void ChargeElectrodeSensitivity::EndOfEvent(G4HCofThisEvent* HCE) {
 
   G4RunManager* runMan = G4RunManager::GetRunManager();
 
+  if (binaryOutput.IsOpen()) {
+    binaryOutput.Write(runMan->GetCurrentRun()->GetRunID(),
+		       runMan->GetCurrentEvent()->GetEventID(), hitCol);
+    return;
+  }
+
   if (output.good()) {
     for (G4CMPElectrodeHit* hit : *hitVec) {
       output << runMan->GetCurrentRun()->GetRunID() << ','
@@ -67,7 +74,15 @@ void ChargeElectrodeSensitivity::EndOfEvent(G4HCofThisEvent* HCE) {
 void ChargeElectrodeSensitivity::SetOutputFile(const G4String &fn) {
   if (fileName != fn) {
     if (output.is_open()) output.close();
+    binaryOutput.Close();
     fileName = fn;
+
+    // Binary files are written in blocks by G4CMPHitWriter
+    if (G4CMPHitWriter::IsBinaryName(fileName)) {
+      binaryOutput.Open(fileName);
+      return;
+    }
+
     output.open(fileName, std::ios_base::app);
     if (!output.good()) {
       G4ExceptionDescription msg;
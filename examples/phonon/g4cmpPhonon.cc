@@ -12,8 +12,13 @@
 // 20150112  Remove RM->Initialize() call to allow macro configuration
 // 20160111  Remove Geant4 version check since we now hard depend on 10.2+
 // 20170816  Add example-specific configuration manager
+// 20201106  Use G4MTRunManager in multithreaded builds
 
+#ifdef G4MULTITHREADED
+#include "G4MTRunManager.hh"
+#else
 #include "G4RunManager.hh"
+#endif
 #include "G4UImanager.hh"
 
 #ifdef G4VIS_USE
@@ -32,9 +37,14 @@
 
 int main(int argc,char** argv)
 {
- // Construct the run manager
+ // Construct the run manager; worker threads write separate hit files,
+ // which are merged at end of each run (see PhononRunAction)
  //
+#ifdef G4MULTITHREADED
+ G4MTRunManager * runManager = new G4MTRunManager;
+#else
  G4RunManager * runManager = new G4RunManager;
+#endif
 
  // Set mandatory initialization classes
  //
@@ -15,6 +15,7 @@ public:
   PhononActionInitialization() {;}
   virtual ~PhononActionInitialization() {;}
   virtual void Build() const;
+  virtual void BuildForMaster() const;
 };
 
 #endif	/* PhononActionInitialization_hh */
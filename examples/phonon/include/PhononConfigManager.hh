@@ -15,6 +15,7 @@
 //		changed via macro commands (see PhononConfigMessenger).
 //
 // 20170816  M. Kelsey -- Extract hit filename from G4CMPConfigManager.
+// 20201105  Add buffer size for binary hit output.
 
 #include "globals.hh"
 
@@ -28,10 +29,13 @@ public:
 
   // Access current values
   static const G4String& GetHitOutput()  { return Instance()->Hit_file; }
+  static G4int GetHitBufferSize()        { return Instance()->Hit_buffer; }
 
   // Change values (e.g., via Messenger)
   static void SetHitOutput(const G4String& name)
     { Instance()->Hit_file=name; UpdateGeometry(); }
+  static void SetHitBufferSize(G4int kB)
+    { Instance()->Hit_buffer=kB; UpdateGeometry(); }
 
   static void UpdateGeometry();
 
@@ -46,6 +50,7 @@ private:
 
 private:
   G4String Hit_file;	// Output file of e/h hits ($G4CMP_HIT_FILE)
+  G4int Hit_buffer;	// Binary hit output buffer, kB ($G4CMP_HIT_BUFFER)
 
   PhononConfigMessenger* messenger;
 };
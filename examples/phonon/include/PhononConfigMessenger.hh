@@ -13,11 +13,13 @@
 //		PhononConfigManager.
 //
 // 20170816  Michael Kelsey
+// 20201105  Add command for binary hit output buffer size
 
 #include "G4UImessenger.hh"
 
 class PhononConfigManager;
 class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
 class G4UIcommand;
 
 
@@ -31,6 +33,7 @@ public:
 private:
   PhononConfigManager* theManager;
   G4UIcmdWithAString* hitsCmd;
+  G4UIcmdWithAnInteger* bufferCmd;
 
 private:
   PhononConfigMessenger(const PhononConfigMessenger&);	// Copying is forbidden
@@ -13,6 +13,7 @@
 #define PhononDetectorConstruction_h 1
 
 #include "G4VUserDetectorConstruction.hh"
+#include "G4Cache.hh"
 #include "globals.hh"
 
 class G4Material;
@@ -27,6 +28,7 @@ public:
   
 public:
   virtual G4VPhysicalVolume* Construct();
+  virtual void ConstructSDandField();
   
 private:
   void DefineMaterials();
@@ -41,7 +43,7 @@ private:
   G4CMPSurfaceProperty* topSurfProp;
   G4CMPSurfaceProperty* botSurfProp;
   G4CMPSurfaceProperty* wallSurfProp;
-  G4CMPElectrodeSensitivity* electrodeSensitivity;
+  G4Cache<G4CMPElectrodeSensitivity*> electrodeSensitivity;  // Per thread
   G4bool fConstructed;
   G4bool fIfField;
   
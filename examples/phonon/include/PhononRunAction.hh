@@ -0,0 +1,48 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file phonon/include/PhononRunAction.hh
+/// \brief Definition of the PhononRunAction class.  On worker threads,
+///   opens and closes the per-thread hit files of PhononSensitivity.  On
+///   the master, merges those files into the configured hit file at end
+///   of run, ordered by (run, event) independent of thread scheduling.
+//
+// $Id$
+//
+// 20201106  New run action for per-thread hit output
+
+#ifndef PhononRunAction_hh
+#define PhononRunAction_hh 1
+
+#include "G4UserRunAction.hh"
+#include "G4CMPHitWriter.hh"
+#include <fstream>
+#include <vector>
+
+class PhononSensitivity;
+
+
+class PhononRunAction : public G4UserRunAction {
+public:
+  PhononRunAction() {;}
+  virtual ~PhononRunAction();
+
+  virtual void BeginOfRunAction(const G4Run* run);
+  virtual void EndOfRunAction(const G4Run* run);
+
+protected:
+  PhononSensitivity* GetSensitivity() const;	// Null on master
+
+  // Master only: combine and remove worker files
+  void MergeThreadFiles();
+  void MergeCSV(const std::vector<G4String>& inputs);
+
+private:
+  G4String mergedName;			// Kept open for whole job, so
+  G4CMPHitWriter mergedBinary;		// that runs are appended
+  std::ofstream mergedCSV;
+};
+
+#endif	/* PhononRunAction_hh */
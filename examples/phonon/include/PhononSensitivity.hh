@@ -7,6 +7,7 @@
 #define PhononSensitivity_h 1
 
 #include "G4CMPElectrodeSensitivity.hh"
+#include "G4CMPHitWriter.hh"
 
 class PhononSensitivity final : public G4CMPElectrodeSensitivity {
 public:
@@ -27,11 +28,16 @@ public:
 
   void SetOutputFile(const G4String& fn);
 
+  // Open per-thread output at start of run, close worker files at end
+  void BeginOfRun();
+  void EndOfRun();
+
 protected:
   virtual G4bool IsHit(const G4Step*, const G4TouchableHistory*) const;
 
 private:
   std::ofstream output;
+  G4CMPHitWriter binaryOutput;	// Used if fileName ends in ".bin"
   G4String fileName;
 };
 
@@ -7,9 +7,17 @@
 
 #include "PhononActionInitialization.hh"
 #include "PhononPrimaryGeneratorAction.hh"
+#include "PhononRunAction.hh"
 #include "G4CMPStackingAction.hh"
 
 void PhononActionInitialization::Build() const {
   SetUserAction(new PhononPrimaryGeneratorAction);
   SetUserAction(new G4CMPStackingAction);
-} 
+  SetUserAction(new PhononRunAction);
+}
+
+// Master merges per-thread hit files at end of run
+
+void PhononActionInitialization::BuildForMaster() const {
+  SetUserAction(new PhononRunAction);
+}
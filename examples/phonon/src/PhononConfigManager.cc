@@ -12,6 +12,7 @@
 //		changed via macro commands (see PhononConfigMessenger).
 //
 // 20170816  M. Kelsey -- Extract hit filename from G4CMPConfigManager.
+// 20201105  Add buffer size for binary hit output.
 
 #include "PhononConfigManager.hh"
 #include "PhononConfigMessenger.hh"
@@ -30,6 +31,7 @@ PhononConfigManager* PhononConfigManager::Instance() {
 
 PhononConfigManager::PhononConfigManager()
   : Hit_file(getenv("G4CMP_HIT_FILE")?getenv("G4CMP_HIT_FILE"):"phonon_hits.txt"),
+    Hit_buffer(getenv("G4CMP_HIT_BUFFER")?atoi(getenv("G4CMP_HIT_BUFFER")):1024),
     messenger(new PhononConfigMessenger(this)) {;}
 
 PhononConfigManager::~PhononConfigManager() {
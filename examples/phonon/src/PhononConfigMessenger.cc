@@ -10,24 +10,33 @@
 //		PhononConfigManager.
 //
 // 20170816  Michael Kelsey
+// 20201105  Add command for binary hit output buffer size
 
 #include "PhononConfigMessenger.hh"
 #include "PhononConfigManager.hh"
 #include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
 
 
 // Constructor and destructor
 
 PhononConfigMessenger::PhononConfigMessenger(PhononConfigManager* mgr)
   : G4UImessenger("/g4cmp/", "User configuration for G4CMP phonon example"),
-    theManager(mgr), hitsCmd(0) {
+    theManager(mgr), hitsCmd(0), bufferCmd(0) {
   hitsCmd = CreateCommand<G4UIcmdWithAString>("HitsFile",
 			      "Set filename for output of phonon hit locations");
+  hitsCmd->SetGuidance("Filename ending in \".bin\" selects binary output");
+
+  bufferCmd = CreateCommand<G4UIcmdWithAnInteger>("HitsBufferSize",
+			      "Buffer size (kB) for binary hit output");
+  bufferCmd->SetParameterName("kB", false);
+  bufferCmd->SetRange("kB>=0");
 }
 
 
 PhononConfigMessenger::~PhononConfigMessenger() {
   delete hitsCmd; hitsCmd=0;
+  delete bufferCmd; bufferCmd=0;
 }
 
 
@@ -35,4 +44,6 @@ PhononConfigMessenger::~PhononConfigMessenger() {
 
 void PhononConfigMessenger::SetNewValue(G4UIcommand* cmd, G4String value) {
   if (cmd == hitsCmd) theManager->SetHitOutput(value);
+  if (cmd == bufferCmd)
+    theManager->SetHitBufferSize(bufferCmd->GetNewIntValue(value));
 }
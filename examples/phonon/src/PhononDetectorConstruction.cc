@@ -9,6 +9,7 @@
 // $Id: a2016d29cc7d1e75482bfc623a533d20b60390da $
 //
 // 20140321  Drop passing placement transform to G4LatticePhysical
+// 20201106  Create sensitive detector in ConstructSDandField(), for MT
 
 #include "PhononDetectorConstruction.hh"
 #include "PhononSensitivity.hh"
@@ -45,7 +46,7 @@
 PhononDetectorConstruction::PhononDetectorConstruction()
   : fLiquidHelium(0), fGermanium(0), fAluminum(0), fTungsten(0),
     fWorldPhys(0), topSurfProp(0), botSurfProp(0), wallSurfProp(0),
-    electrodeSensitivity(0), fConstructed(false), fIfField(true) {;}
+    fConstructed(false), fIfField(true) {;}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
@@ -145,15 +146,6 @@ void PhononDetectorConstruction::SetupGeometry()
     G4ThreeVector(0.,0.,-1.28*cm), fAluminumLogical, "fAluminumPhysical",
     worldLogical,false,1);
 
-  //
-  // detector -- Note : Aluminum electrode sensitivity is attached to Germanium 
-  //
-  G4SDManager* SDman = G4SDManager::GetSDMpointer();
-  if (!electrodeSensitivity)
-    electrodeSensitivity = new PhononSensitivity("PhononElectrode");
-  SDman->AddNewDetector(electrodeSensitivity);
-  fGermaniumLogical->SetSensitiveDetector(electrodeSensitivity);
-
   //
   // surface between Al and Ge determines phonon reflection/absorption
 
@@ -182,3 +174,19 @@ void PhononDetectorConstruction::SetupGeometry()
   fGermaniumLogical->SetVisAttributes(simpleBoxVisAtt);
   fAluminumLogical->SetVisAttributes(simpleBoxVisAtt);
 }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void PhononDetectorConstruction::ConstructSDandField()
+{
+  //
+  // detector -- Note : Aluminum electrode sensitivity is attached to Germanium 
+  //
+  if (!electrodeSensitivity.Get()) {
+    G4CMPElectrodeSensitivity* sd = new PhononSensitivity("PhononElectrode");
+    G4SDManager::GetSDMpointer()->AddNewDetector(sd);
+    electrodeSensitivity.Put(sd);
+  }
+
+  SetSensitiveDetector("fGermaniumLogical", electrodeSensitivity.Get());
+}
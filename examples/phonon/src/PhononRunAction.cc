@@ -0,0 +1,140 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file phonon/src/PhononRunAction.cc
+/// \brief Implementation of the PhononRunAction class
+//
+// $Id$
+//
+// 20201106  New run action for per-thread hit output
+
+#include "PhononRunAction.hh"
+#include "PhononConfigManager.hh"
+#include "PhononSensitivity.hh"
+#include "G4CMPHitReader.hh"
+#include "G4Run.hh"
+#include "G4SDManager.hh"
+#include "G4Threading.hh"
+#include <cstdio>
+#include <stdlib.h>
+
+#ifdef G4MULTITHREADED
+#include "G4MTRunManager.hh"
+#endif
+
+
+PhononRunAction::~PhononRunAction() {
+  if (mergedCSV.is_open()) mergedCSV.close();
+}
+
+
+// Sensitive detectors only exist on worker (or sequential) threads
+
+PhononSensitivity* PhononRunAction::GetSensitivity() const {
+  G4VSensitiveDetector* sd =
+    G4SDManager::GetSDMpointer()->FindSensitiveDetector("PhononElectrode",
+							 false);
+  return dynamic_cast<PhononSensitivity*>(sd);
+}
+
+void PhononRunAction::BeginOfRunAction(const G4Run*) {
+  PhononSensitivity* sd = GetSensitivity();
+  if (sd) sd->BeginOfRun();
+}
+
+// G4MTRunManager calls master's EndOfRunAction after all workers are done
+
+void PhononRunAction::EndOfRunAction(const G4Run*) {
+  PhononSensitivity* sd = GetSensitivity();
+  if (sd) sd->EndOfRun();
+
+  if (G4Threading::IsMasterThread() &&
+      G4Threading::IsMultithreadedApplication()) MergeThreadFiles();
+}
+
+
+// Collect worker files in thread order, and append to job's hit file
+
+void PhononRunAction::MergeThreadFiles() {
+  G4int nThreads = 0;
+#ifdef G4MULTITHREADED
+  G4MTRunManager* mtRM = G4MTRunManager::GetMasterRunManager();
+  if (mtRM) nThreads = mtRM->GetNumberOfThreads();
+#endif
+
+  const G4String& hitFile = PhononConfigManager::GetHitOutput();
+
+  std::vector<G4String> inputs;
+  for (G4int i=0; i<nThreads; i++) {
+    G4String name = G4CMPHitWriter::ThreadFileName(hitFile, i);
+    if (std::ifstream(name).good()) inputs.push_back(name);
+  }
+
+  if (inputs.empty()) return;
+
+  if (G4CMPHitWriter::IsBinaryName(hitFile)) {
+    if (mergedName != hitFile) mergedBinary.Open(hitFile);
+    mergedName = hitFile;
+    mergedBinary.Merge(inputs);
+  } else {
+    if (mergedName != hitFile) {
+      if (mergedCSV.is_open()) mergedCSV.close();
+      mergedCSV.open(hitFile, std::ios_base::app);
+      G4CMPHitReader::WriteCSVHeader(mergedCSV);
+    }
+    mergedName = hitFile;
+    MergeCSV(inputs);
+  }
+
+  for (const G4String& name: inputs) std::remove(name.c_str());
+}
+
+
+// Text files have one hit per line, starting with "run,event,"; lines from
+// the same event are contiguous within one worker's file
+
+void PhononRunAction::MergeCSV(const std::vector<G4String>& inputs) {
+  const size_t nInputs = inputs.size();
+  std::vector<std::ifstream*> files(nInputs, 0);
+  std::vector<std::string> lines(nInputs);
+  std::vector<G4int> runs(nInputs, 0), events(nInputs, 0);
+  std::vector<G4bool> valid(nInputs, false);
+
+  auto readLine = [&](size_t i) {
+    do {
+      valid[i] = (G4bool)std::getline(*files[i], lines[i]);
+    } while (valid[i] && lines[i].empty());
+
+    if (valid[i]) {
+      char* end = 0;
+      runs[i] = strtol(lines[i].c_str(), &end, 10);
+      events[i] = (*end == ',') ? strtol(end+1, 0, 10) : 0;
+    }
+  };
+
+  for (size_t i=0; i<nInputs; i++) {
+    files[i] = new std::ifstream(inputs[i]);
+    std::getline(*files[i], lines[i]);		// Discard column titles
+    readLine(i);
+  }
+
+  while (true) {
+    size_t next = nInputs;
+    for (size_t i=0; i<nInputs; i++) {
+      if (!valid[i]) continue;
+      if (next == nInputs || runs[i] < runs[next] ||
+	  (runs[i] == runs[next] && events[i] < events[next])) next = i;
+    }
+
+    if (next == nInputs) break;		// All inputs exhausted
+
+    mergedCSV << lines[next] << '\n';
+    readLine(next);
+  }
+
+  for (size_t i=0; i<nInputs; i++) delete files[i];
+
+  mergedCSV.flush();
+}
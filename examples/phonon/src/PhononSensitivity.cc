@@ -14,13 +14,14 @@
 #include "G4RunManager.hh"
 #include "G4SDManager.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
 #include "PhononConfigManager.hh"
 #include <fstream>
 
 
 PhononSensitivity::PhononSensitivity(G4String name) :
   G4CMPElectrodeSensitivity(name), fileName("") {
-  SetOutputFile(PhononConfigManager::GetHitOutput());
+  BeginOfRun();
 }
 
 /* Move is disabled for now because old versions of GCC can't move ofstream
@@ -58,6 +59,12 @@ void PhononSensitivity::EndOfEvent(G4HCofThisEvent* HCE) {
 
   G4RunManager* runMan = G4RunManager::GetRunManager();
 
+  if (binaryOutput.IsOpen()) {
+    binaryOutput.Write(runMan->GetCurrentRun()->GetRunID(),
+		       runMan->GetCurrentEvent()->GetEventID(), hitCol);
+    return;
+  }
+
   if (output.good()) {
     for (G4CMPElectrodeHit* hit : *hitVec) {
       output << runMan->GetCurrentRun()->GetRunID() << ','
@@ -82,7 +89,15 @@ void PhononSensitivity::EndOfEvent(G4HCofThisEvent* HCE) {
 void PhononSensitivity::SetOutputFile(const G4String &fn) {
   if (fileName != fn) {
     if (output.is_open()) output.close();
+    binaryOutput.Close();
     fileName = fn;
+
+    // Binary files are written in blocks by G4CMPHitWriter
+    if (G4CMPHitWriter::IsBinaryName(fileName)) {
+      binaryOutput.Open(fileName);
+      return;
+    }
+
     output.open(fileName, std::ios_base::app);
     if (!output.good()) {
       G4ExceptionDescription msg;
@@ -99,6 +114,26 @@ void PhononSensitivity::SetOutputFile(const G4String &fn) {
   }
 }
 
+// Each worker thread writes its own file, which is merged by the master
+// (see PhononRunAction); sequential jobs write directly to the hit file
+
+void PhononSensitivity::BeginOfRun() {
+  binaryOutput.SetFlushSize(PhononConfigManager::GetHitBufferSize()*1024);
+  SetOutputFile(G4CMPHitWriter::ThreadFileName(
+		  PhononConfigManager::GetHitOutput()));
+}
+
+void PhononSensitivity::EndOfRun() {
+  if (G4Threading::IsWorkerThread()) {
+    if (output.is_open()) output.close();
+    binaryOutput.Close();
+    fileName = "";		// Reopen (new file) at next run
+  } else {
+    output.flush();
+    binaryOutput.Flush();
+  }
+}
+
 G4bool PhononSensitivity::IsHit(const G4Step* step,
                                 const G4TouchableHistory*) const {
   /* Phonons tracks are sometimes killed at the boundary in order to spawn new
@@ -0,0 +1,247 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+// Usage: benchFETHitInput [nHits] [nEvents]
+//
+// Time the hit input stage of ChargeFETDigitizerModule::PostProcess(),
+// without Ramo lookups or trace synthesis, which are the same for every
+// input format.  Synthetic hits (default 1M in 200 events) are written
+// to benchHits.bin with G4CMPHitWriter, and exported to benchHits.csv
+// with G4CMPHitReader::WriteCSV().  Each file is then read with
+//
+//   old CSV parsing	one istringstream per field (before 20201112)
+//   new CSV parsing	fields converted in place with atoi/strtod
+//   binary blocks	G4CMPHitReader, one bulk read per column
+//
+// Every reader sums charge*(x+y+z+t) over electrons and holes.  The hit
+// values are chosen to print exactly in CSV, so the three checksums must
+// be identical.
+
+#include "G4CMPHitReader.hh"
+#include "G4CMPHitWriter.hh"
+#include "G4Timer.hh"
+#include "Randomize.hh"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace {
+  const G4String binName = "benchHits.bin";
+  const G4String csvName = "benchHits.csv";
+
+  const std::vector<G4String> names = {
+    "G4CMPDriftElectron", "G4CMPDriftHole", "phononL"
+  };
+
+  const char* NextField(const char* field) {
+    field = strchr(field, ',');
+    return field ? field+1 : 0;
+  }
+
+  G4double CarrierCharge(const char* name, size_t length) {
+    for (size_t i=0; i<2; i++) {
+      if (length == names[i].size() &&
+	  strncmp(name, names[i].c_str(), length) == 0) return (i==0 ? -1. : 1.);
+    }
+    return 0.;
+  }
+}
+
+
+// Positions in 10 um steps, times in whole ns, so that CSV is exact
+
+void WriteHitFiles(size_t nHits, size_t nEvents) {
+  G4CMPHitWriter writer(binName);
+  G4CMPHitBlock block;
+  block.runID = 0;
+
+  for (size_t evt=0; evt<nEvents; evt++) {
+    block.eventID = evt;
+    block.Resize(nHits/nEvents + (evt < nHits%nEvents ? 1 : 0));
+
+    for (size_t i=0; i<block.nHits; i++) {
+      block.trackID[i] = i+1;
+      block.particle[i] = i % names.size();
+      for (G4int col=0; col<G4CMPHitWriter::NumColumns; col++) {
+	G4double value = G4int(G4UniformRand()*1000.) - 500;
+	if (col != G4CMPHitWriter::StartTime &&
+	    col != G4CMPHitWriter::FinalTime) value /= 1e5;
+	block.column[col][i] = value;
+      }
+    }
+
+    writer.Write(block, names);
+  }
+
+  writer.Close();
+
+  G4CMPHitReader reader(binName);
+  std::ofstream csv(csvName);
+  G4CMPHitReader::WriteCSVHeader(csv);
+  while (reader.ReadBlock(block)) reader.WriteCSV(csv, block);
+}
+
+
+// Field by field, as in the original PostProcess(); the column skip is
+// corrected so that the checksum can be compared
+
+G4double ReadOldCSV(size_t& nHits) {
+  std::ifstream input(csvName);
+
+  G4double sum = 0.;
+  G4double throw_away, position[3], arrivalTime;
+  G4int RunID, EventID;
+  G4String particleName;
+
+  G4String line;
+  G4String entry;
+  std::getline(input, line);
+  while (!std::getline(input, line).eof()) {
+    std::istringstream ssLine(line);
+    nHits++;
+
+    std::getline(ssLine,entry,',');
+    std::istringstream(entry) >> RunID;
+
+    std::getline(ssLine,entry,',');
+    std::istringstream(entry) >> EventID;
+
+    std::getline(ssLine,entry,',');
+    std::istringstream(entry) >> throw_away;
+
+    std::getline(ssLine,entry,',');
+    std::istringstream(entry) >> particleName;
+
+    for (size_t i=0; i<7; ++i) {
+      std::getline(ssLine,entry,',');
+      std::istringstream(entry) >> throw_away;
+    }
+
+    for (size_t i=0; i<3; ++i) {
+      std::getline(ssLine,entry,',');
+      std::istringstream(entry) >> position[i];
+    }
+
+    std::getline(ssLine,entry,',');
+    std::istringstream(entry) >> arrivalTime;
+
+    G4double charge = CarrierCharge(particleName.c_str(),
+				    particleName.size());
+    if (charge == 0.) continue;
+
+    sum += charge*(position[0]+position[1]+position[2]+arrivalTime);
+  }
+
+  return sum;
+}
+
+
+// Same parsing as ChargeFETDigitizerModule::PostProcessCSV()
+
+G4double ReadNewCSV(size_t& nHits) {
+  std::ifstream input(csvName);
+
+  G4double sum = 0.;
+  G4double position[3];
+
+  std::string line;
+  while (std::getline(input, line)) {
+    if (line.empty() || !(isdigit(line[0]) || line[0] == '-')) continue;
+    nHits++;
+
+    const char* field = line.c_str();
+    for (size_t i=0; field && i<3; ++i) field = NextField(field);
+    if (!field) continue;
+
+    G4double charge = CarrierCharge(field, strcspn(field, ","));
+    if (charge == 0.) continue;
+
+    for (size_t i=0; field && i<8; ++i) field = NextField(field);
+
+    for (size_t i=0; field && i<3; ++i) {
+      position[i] = strtod(field, 0);
+      field = NextField(field);
+    }
+    if (!field) continue;
+
+    sum += charge*(position[0]+position[1]+position[2]+strtod(field, 0));
+  }
+
+  return sum;
+}
+
+
+// Same reading as ChargeFETDigitizerModule::PostProcessBinary()
+
+G4double ReadBinary(size_t& nHits) {
+  G4CMPHitReader reader(binName);
+  G4CMPHitReader::Block block;
+  std::vector<G4double> codeCharge;
+
+  G4double sum = 0.;
+  while (reader.ReadBlock(block)) {
+    const std::vector<G4String>& codes = reader.ParticleNames();
+    for (size_t code=codeCharge.size(); code < codes.size(); ++code)
+      codeCharge.push_back(CarrierCharge(codes[code].c_str(),
+					 codes[code].size()));
+
+    const std::vector<G4double>& x = block.column[G4CMPHitWriter::FinalX];
+    const std::vector<G4double>& y = block.column[G4CMPHitWriter::FinalY];
+    const std::vector<G4double>& z = block.column[G4CMPHitWriter::FinalZ];
+    const std::vector<G4double>& t = block.column[G4CMPHitWriter::FinalTime];
+
+    nHits += block.nHits;
+    for (size_t i=0; i<block.nHits; ++i) {
+      G4double charge = codeCharge[block.particle[i]];
+      if (charge == 0.) continue;
+
+      sum += charge*(x[i]+y[i]+z[i]+t[i]);
+    }
+  }
+
+  return sum;
+}
+
+
+G4double TimeReader(const char* label, G4double (*reader)(size_t&)) {
+  G4Timer timer;
+  size_t nHits = 0;
+
+  timer.Start();
+  G4double sum = reader(nHits);
+  timer.Stop();
+
+  G4double elapsed = timer.GetRealElapsed();
+  G4cout << label << "\t" << nHits << " hits in " << elapsed << " s, "
+	 << (elapsed > 0. ? nHits/elapsed : 0.) << " hits/s, checksum "
+	 << std::setprecision(17) << sum << std::setprecision(6) << G4endl;
+
+  return sum;
+}
+
+
+int main(int argc, char* argv[]) {
+  size_t nHits = (argc>1) ? strtoul(argv[1], 0, 10) : 1000000;
+  size_t nEvents = (argc>2) ? strtoul(argv[2], 0, 10) : 200;
+  if (nEvents == 0) nEvents = 1;
+
+  G4cout << "Writing " << nHits << " hits in " << nEvents << " events to "
+	 << binName << " and " << csvName << G4endl;
+  WriteHitFiles(nHits, nEvents);
+
+  G4double oldSum = TimeReader("old CSV parsing", ReadOldCSV);
+  G4double newSum = TimeReader("new CSV parsing", ReadNewCSV);
+  G4double binSum = TimeReader("binary blocks  ", ReadBinary);
+
+  if (oldSum != binSum || newSum != binSum) {
+    G4cerr << "ERROR: checksums differ between input formats" << G4endl;
+    return 1;
+  }
+
+  return 0;
+}
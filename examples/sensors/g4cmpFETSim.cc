@@ -3,7 +3,13 @@
  * License version 3 or later. See G4CMP/LICENSE for the full license. *
 \***********************************************************************/
 
+// Usage: g4cmpFETSim <hits-file> [output-file]
+//
+// Hits may be CSV text, or binary (name ending in ".bin") as written by
+// G4CMPHitWriter; binary files replay much faster.
+
 #include "ChargeFETDigitizerModule.hh"
+#include "G4Timer.hh"
 
 int main(int argc, char** argv) {
   G4String filename;
@@ -22,7 +28,14 @@ int main(int argc, char** argv) {
   }
 
   fetsim.Build();
+
+  G4Timer timer;
+  timer.Start();
   fetsim.PostProcess(filename);
+  timer.Stop();
+
+  G4cout << "Processed " << filename << " in " << timer.GetRealElapsed()
+	 << " s" << G4endl;
 
   return 0;
 }
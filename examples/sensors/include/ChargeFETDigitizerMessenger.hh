@@ -46,6 +46,7 @@ class ChargeFETDigitizerMessenger : public G4UImessenger
     G4UIcmdWithoutParameter*   GetUnitTimeCmd;
     G4UIcmdWithADoubleAndUnit* SetPreTrigCmd;
     G4UIcmdWithoutParameter*   GetPreTrigCmd;
+    G4UIcmdWithABool*          SetTimeResolvedCmd;
     G4UIcmdWithoutParameter*   UpdateCmd;
 };
 
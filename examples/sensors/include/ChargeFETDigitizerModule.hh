@@ -7,7 +7,9 @@
 #define CHARGEFETDIGITIZERMODULE_HH
 
 #include "G4VDigitizerModule.hh"
+#include "ChargeFETFFT.hh"
 #include <fstream>
+#include <utility>
 
 class ChargeFETDigitizerMessenger;
 class G4CMPMeshElectricField;
@@ -26,6 +28,9 @@ class ChargeFETDigitizerModule : public G4VDigitizerModule
 
     void Build();
     virtual void Digitize();
+
+    // Replay hits file event by event; ".bin" files are read as written
+    // by G4CMPHitWriter, others as CSV text
     void PostProcess(const G4String& fileName);
 
     // Methods for Messenger
@@ -60,13 +65,39 @@ class ChargeFETDigitizerModule : public G4VDigitizerModule
     void     SetPreTrig(G4double n);
     G4double GetPreTrig() const {return preTrig;}
 
+    // Convolve carrier arrival times with templates, instead of treating
+    // all charge as arriving at the trigger time
+    void     SetTimeResolved(G4bool b);
+    G4bool   IsTimeResolved() const {return timeResolved;}
+
   private:
     void ReadFETConstantsFile();
     void BuildFETTemplates();
-    vector<vector<G4double> > CalculateTraces(const vector<G4double>& scaleFactors);
+    void BuildTemplateSpectra();
     void BuildRamoFields();
-    void WriteFETTraces(const vector<vector<G4double> >& FETTraces,
-                        G4int RunID, G4int EventID);
+
+    // Per-event accumulation of induced charge, by channel and arrival bin
+    void ClearArrivals();
+    void AddCarrier(G4double charge, const G4double position[4],
+                    G4double arrivalTime);
+
+    // Fill FETTraces from arrivals
+    void CalculateTraces();
+    void ScaleTemplates();		// Single arrival bin, blocked kernel
+    void ConvolveSparse();		// Few arrival bins, direct sum
+    void ConvolveFFT();			// Many arrival bins
+
+    void WriteFETTraces(G4int RunID, G4int EventID);
+    void FinishEvent(G4int RunID, G4int EventID);	// Traces, then clear
+
+    void PostProcessBinary(const G4String& fileName);
+    void PostProcessCSV(const G4String& fileName);
+    static G4double CarrierCharge(const char* name, size_t length);
+
+    // Index into contiguous storage
+    size_t TemplateIndex(size_t chan, size_t cross) const {
+      return (chan*numChannels + cross)*timeBins;
+    }
 
     ChargeFETDigitizerMessenger* messenger;
     // FET constants
@@ -77,6 +108,7 @@ class ChargeFETDigitizerModule : public G4VDigitizerModule
     size_t timeBins;
     // Enable/Disable FETSim during sim
     G4bool enabledForSD;
+    G4bool timeResolved;
     // Internal flags to not waste time on unnecessary recalculating
     G4bool rereadConfigFile;
     G4bool rebuildFETTemplates;
@@ -90,8 +122,21 @@ class ChargeFETDigitizerModule : public G4VDigitizerModule
     G4String templateFilename;
     G4String ramoFileDir;
     // FETSim Quantities
-    vector<vector<vector<G4double> > > FETTemplates; //4x4x4096 = 4 channels w/ cross-talk terms
+    vector<G4double> FETTemplates;	// [chan][cross][bin], contiguous
+    vector<std::pair<size_t,size_t> > templateTerms;	// Non-zero (chan,cross)
     vector<G4CMPMeshElectricField> RamoFields;
+    // Reused for each event
+    vector<G4double> arrivals;		// [cross][bin]
+    vector<size_t> arrivalBins;		// Occupied indices into arrivals
+    vector<G4bool> binUsed;
+    vector<G4double> FETTraces;		// [chan][bin]
+    // Time-resolved convolution
+    ChargeFETFFT fft;
+    vector<ChargeFETFFT::Complex> templateSpectra;	// [term][fftSize]
+    vector<ChargeFETFFT::Complex> arrivalSpectra;	// [cross][fftSize]
+    vector<ChargeFETFFT::Complex> traceSpectrum;
+    vector<ChargeFETFFT::Complex> fftWork;		// [fftSize]
+    vector<G4bool> hasArrivals;				// [cross]
 };
 
 #endif // CHARGEFETDIGITIZERMODULE_HH
@@ -0,0 +1,42 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+// Minimal radix-2 complex FFT, used by ChargeFETDigitizerModule to
+// convolve carrier arrival times with the FET pulse templates.  Twiddle
+// factors and bit-reversal indices are computed once per size.
+
+#ifndef CHARGEFETFFT_HH
+#define CHARGEFETFFT_HH
+
+#include "globals.hh"
+#include <complex>
+#include <vector>
+
+class ChargeFETFFT
+{
+  public:
+    typedef std::complex<G4double> Complex;
+
+    explicit ChargeFETFFT(size_t n=0) { SetSize(n); }
+
+    // Size is rounded up to a power of two
+    void   SetSize(size_t n);
+    size_t GetSize() const {return size;}
+
+    // In-place transforms; data must have GetSize() entries
+    void Forward(std::vector<Complex>& data) const { Transform(data, false); }
+    void Inverse(std::vector<Complex>& data) const;	// Includes 1/N
+
+    static size_t NextPowerOfTwo(size_t n);
+
+  private:
+    void Transform(std::vector<Complex>& data, G4bool inverse) const;
+
+    size_t size;
+    std::vector<Complex> twiddle;	// exp(-2 pi i k/N), k < N/2
+    std::vector<size_t> bitReverse;
+};
+
+#endif // CHARGEFETFFT_HH
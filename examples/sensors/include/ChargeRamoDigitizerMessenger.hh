@@ -0,0 +1,37 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+#ifndef CHARGERAMOMESSENGER_HH
+#define CHARGERAMOMESSENGER_HH 1
+
+#include "G4UImessenger.hh"
+
+class ChargeRamoDigitizerModule;
+class G4UIdirectory;
+class G4UIcmdWithoutParameter;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithABool;
+
+class ChargeRamoDigitizerMessenger : public G4UImessenger
+{
+  public:
+    ChargeRamoDigitizerMessenger(ChargeRamoDigitizerModule* digitizer);
+    ~ChargeRamoDigitizerMessenger();
+    void SetNewValue(G4UIcommand* command, G4String NewValue);
+  private:
+    ChargeRamoDigitizerModule* ramo;
+    G4UIdirectory*             ramoDir;
+    G4UIcmdWithABool*          EnableCmd;
+    G4UIcmdWithAString*        SetOutputFileCmd;
+    G4UIcmdWithAString*        SetRamoFileDirCmd;
+    G4UIcmdWithAnInteger*      SetNumChanCmd;
+    G4UIcmdWithAnInteger*      SetTimeBinCmd;
+    G4UIcmdWithADoubleAndUnit* SetUnitTimeCmd;
+    G4UIcmdWithoutParameter*   UpdateCmd;
+};
+
+#endif
@@ -0,0 +1,100 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+// Time-resolved Shockley-Ramo digitizer.  Step points of each drifting
+// charge carrier are recorded during tracking (see ChargeRamoSteppingAction);
+// at the end of the event, the Ramo (weighting) potential of each channel
+// is evaluated along the recorded paths, and the change in induced charge
+// over each step is added to the time bins spanned by that step.  Output
+// traces are the cumulative induced charge on each channel, in units of e.
+
+#ifndef CHARGERAMODIGITIZERMODULE_HH
+#define CHARGERAMODIGITIZERMODULE_HH
+
+#include "G4VDigitizerModule.hh"
+#include "G4ThreeVector.hh"
+#include <fstream>
+#include <vector>
+
+class ChargeRamoDigitizerMessenger;
+class G4CMPMeshElectricField;
+class G4Step;
+class G4String;
+
+using std::vector;
+
+class ChargeRamoDigitizerModule : public G4VDigitizerModule
+{
+  public:
+    ChargeRamoDigitizerModule(G4String modName="RamoSim");
+    virtual ~ChargeRamoDigitizerModule();
+
+    void Build();
+    virtual void Digitize();
+
+    // Record carrier step; called from stepping action during tracking.
+    // Steps left over from an event without Digitize() are discarded.
+    void AddStep(const G4Step* step);
+
+    // Compute and write traces for recorded steps, then clear them;
+    // called by Digitize(), or directly for standalone use
+    void FinishEvent(G4int RunID, G4int EventID);
+    size_t GetNumberOfSteps() const {return stepPoints.size();}
+
+    // Cumulative induced charge [chan][bin], from last Digitize()
+    const vector<G4double>& GetTraces() const {return traces;}
+
+    // Methods for Messenger
+    void     EnableRamoSim();
+    void     DisableRamoSim() {enabled = false;}
+    G4bool   RamoSimIsEnabled() const {return enabled;}
+
+    void     SetOutputFile(const G4String& name);
+    G4String GetOutputFile() const {return outputFilename;}
+
+    void     SetRamoFileDir(const G4String& name);
+    G4String GetRamoFileDir() const {return ramoFileDir;}
+
+    void     SetNumberOfChannels(size_t n);
+    size_t   GetNumberOfChannels() const {return numChannels;}
+
+    void     SetTimeBins(size_t n);
+    size_t   GetTimeBins() const {return timeBins;}
+
+    void     SetUnitTime(G4double t);
+    G4double GetUnitTime() const {return dt;}
+
+  private:
+    void BuildRamoFields();
+    void ClearSteps();
+    void CalculateTraces();
+    void AddCharge(G4double* trace, G4double dQ, G4double t0, G4double t1);
+    void WriteTraces(G4int RunID, G4int EventID);
+
+    ChargeRamoDigitizerMessenger* messenger;
+    G4double dt;
+    size_t numChannels;
+    size_t timeBins;
+    G4bool enabled;
+    G4bool rebuildRamoFields;
+    std::ofstream outputFile;
+    G4String outputFilename;
+    G4String ramoFileDir;
+    vector<G4CMPMeshElectricField> RamoFields;
+
+    // Step points for current event, in tracking order; charge is zero
+    // at the first point of each track, otherwise the carrier's charge
+    vector<G4ThreeVector> stepPoints;
+    vector<G4double> stepTimes;
+    vector<G4double> stepCharges;
+    G4int lastTrackID;
+    G4int stepEventID;			// Event in which steps were recorded
+
+    // Reused for each event
+    vector<G4double> potentials;
+    vector<G4double> traces;		// [chan][bin]
+};
+
+#endif // CHARGERAMODIGITIZERMODULE_HH
@@ -0,0 +1,32 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+// Stepping hook which passes charge carrier steps to a
+// ChargeRamoDigitizerModule.  Other particles are ignored with a cheap
+// pointer test, so the action can be left in place when the
+// digitizer is disabled.
+
+#ifndef CHARGERAMOSTEPPINGACTION_HH
+#define CHARGERAMOSTEPPINGACTION_HH
+
+#include "G4UserSteppingAction.hh"
+
+class ChargeRamoDigitizerModule;
+class G4Step;
+
+class ChargeRamoSteppingAction : public G4UserSteppingAction
+{
+  public:
+    explicit ChargeRamoSteppingAction(ChargeRamoDigitizerModule* digitizer)
+      : ramo(digitizer) {;}
+    virtual ~ChargeRamoSteppingAction() {;}
+
+    virtual void UserSteppingAction(const G4Step* step);
+
+  private:
+    ChargeRamoDigitizerModule* ramo;
+};
+
+#endif // CHARGERAMOSTEPPINGACTION_HH
@@ -81,6 +81,9 @@ ChargeFETDigitizerMessenger::ChargeFETDigitizerMessenger(
   GetPreTrigCmd = new G4UIcmdWithoutParameter("/g4cmp/FETSim/GetPreTriggerTime",this);
   GetPreTrigCmd->SetGuidance("Get pre-trigger time for pulse (if not using templates)");
 
+  SetTimeResolvedCmd = new G4UIcmdWithABool("/g4cmp/FETSim/SetTimeResolved",this);
+  SetTimeResolvedCmd->SetGuidance("Convolve carrier arrival times with pulse templates.");
+
   UpdateCmd = new G4UIcmdWithoutParameter("/g4cmp/FETSim/Update",this);
   UpdateCmd->SetGuidance("Must manually udpate FETSim after changing parameters.");
 }
@@ -109,6 +112,7 @@ ChargeFETDigitizerMessenger::~ChargeFETDigitizerMessenger()
     delete GetUnitTimeCmd;
     delete SetPreTrigCmd;
     delete GetPreTrigCmd;
+    delete SetTimeResolvedCmd;
     delete UpdateCmd;
 }
 
@@ -156,6 +160,8 @@ void ChargeFETDigitizerMessenger::SetNewValue(G4UIcommand* command, G4String New
     fet->SetPreTrig(SetPreTrigCmd->ConvertToDimensionedDouble(NewValue));
   else if (command == GetPreTrigCmd)
     fet->GetPreTrig();
+  else if (command == SetTimeResolvedCmd)
+    fet->SetTimeResolved(SetTimeResolvedCmd->GetNewBoolValue(NewValue));
   else if (command == UpdateCmd)
     fet->Build();
 }
@@ -5,7 +5,11 @@
 
 #include "ChargeFETDigitizerModule.hh"
 #include "ChargeFETDigitizerMessenger.hh"
+#include "G4CMPDriftElectron.hh"
+#include "G4CMPDriftHole.hh"
 #include "G4CMPElectrodeHit.hh"
+#include "G4CMPHitReader.hh"
+#include "G4CMPHitWriter.hh"
 #include "G4CMPMeshElectricField.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4VDigitizerModule.hh"
@@ -14,12 +18,18 @@
 #include "G4SDManager.hh"
 #include "G4Run.hh"
 #include "G4Event.hh"
+#include <algorithm>
+#include <ctype.h>
+#include <math.h>
 #include <sstream>
+#include <stdlib.h>
+#include <string.h>
 
 ChargeFETDigitizerModule::ChargeFETDigitizerModule(G4String modName) :
   G4VDigitizerModule(modName), messenger(new ChargeFETDigitizerMessenger(this)),
   decayTime(40e-6*s), dt(800e-9*s), preTrig(4096e-7*s), numChannels(4),
-  timeBins(4096), enabledForSD(false), rereadConfigFile(true),
+  timeBins(4096), enabledForSD(false), timeResolved(false),
+  rereadConfigFile(true),
   rebuildFETTemplates(true), rebuildRamoFields(true),
   outputFilename("FETOutput"),
   configFilename("config/G4CMP/FETSim/ConstantsFET"),
@@ -30,7 +40,8 @@ ChargeFETDigitizerModule::ChargeFETDigitizerModule(G4String modName) :
 ChargeFETDigitizerModule::ChargeFETDigitizerModule() :
   G4VDigitizerModule("NoSim"), messenger(nullptr),
   decayTime(40e-6*s), dt(800e-9*s), preTrig(4096e-7*s), numChannels(4),
-  timeBins(4096), enabledForSD(false), rereadConfigFile(true),
+  timeBins(4096), enabledForSD(false), timeResolved(false),
+  rereadConfigFile(true),
   rebuildFETTemplates(true), rebuildRamoFields(true),
   outputFilename("FETOutput"),
   configFilename("config/G4CMP/FETSim/ConstantsFET"),
@@ -73,32 +84,94 @@ void ChargeFETDigitizerModule::Digitize()
     static_cast<G4CMPElectrodeHitsCollection*>(HCE->GetHC(HCID));
   vector<G4CMPElectrodeHit*>* hitVec = hitCol->GetVector();
 
-  vector<G4double> scaleFactors(numChannels,0);
+  // Charge carriers are identified by definition, without string compares
+  const G4ParticleDefinition* electron = G4CMPDriftElectron::Definition();
+  const G4ParticleDefinition* hole = G4CMPDriftHole::Definition();
+
+  ClearArrivals();
+
   G4double position[4] = {0.,0.,0.,0.};
   G4ThreeVector vecPosition;
-  for(size_t chan = 0; chan < numChannels; ++chan) {
-    for(size_t hitIdx=0; hitIdx < hitVec->size(); ++hitIdx) {
-      if(hitVec->at(hitIdx)->GetParticleName()=="G4CMPDriftElectron" ||
-         hitVec->at(hitIdx)->GetParticleName()=="G4CMPDriftHole") {
-        vecPosition = hitVec->at(hitIdx)->GetFinalPosition();
-        position[0] = vecPosition.getX();
-        position[1] = vecPosition.getY();
-        position[2] = vecPosition.getZ();
-        if(hitVec->at(hitIdx)->GetParticleName()=="G4CMPDriftElectron")
-          scaleFactors[chan] -= -1 * RamoFields[chan].GetPotential(position);
-        else
-          scaleFactors[chan] -= 1 * RamoFields[chan].GetPotential(position);
-      }
-    }
+  for(size_t hitIdx=0; hitIdx < hitVec->size(); ++hitIdx) {
+    const G4CMPElectrodeHit* hit = (*hitVec)[hitIdx];
+    const G4ParticleDefinition* pd = hit->GetParticle();
+    if (pd != electron && pd != hole) continue;
+
+    G4double charge = (pd == electron) ? -1. : 1.;
+    vecPosition = hit->GetFinalPosition();
+    position[0] = vecPosition.getX();
+    position[1] = vecPosition.getY();
+    position[2] = vecPosition.getZ();
+    AddCarrier(charge, position, hit->GetFinalTime());
   }
 
-  vector<vector<G4double> > FETTraces(CalculateTraces(scaleFactors));
   G4int runID = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
   G4int eventID = G4RunManager::GetRunManager()->GetCurrentEvent()->GetEventID();
-  WriteFETTraces(FETTraces, runID, eventID);
+  FinishEvent(runID, eventID);
 }
 
 void ChargeFETDigitizerModule::PostProcess(const G4String& fileName)
+{
+  if (G4CMPHitWriter::IsBinaryName(fileName)) PostProcessBinary(fileName);
+  else PostProcessCSV(fileName);
+}
+
+// Binary hit files are read one event block at a time, with each column
+// read in bulk; particle names are only compared when new codes appear
+
+void ChargeFETDigitizerModule::PostProcessBinary(const G4String& fileName)
+{
+  G4CMPHitReader reader;
+  if (!reader.Open(fileName)) {
+    G4ExceptionDescription msg;
+    msg << "Error reading data input file from " << fileName;
+    G4Exception("ChargeFETDigitizerModule::PostProcess", "Charge002",
+    FatalException, msg);
+    return;
+  }
+
+  G4CMPHitReader::Block block;
+  vector<G4double> codeCharge;		// Indexed by particle code
+  G4double position[4] = {0.,0.,0.,0.};
+  ClearArrivals();
+
+  while (reader.ReadBlock(block)) {
+    const vector<G4String>& names = reader.ParticleNames();
+    for (size_t code=codeCharge.size(); code < names.size(); ++code)
+      codeCharge.push_back(CarrierCharge(names[code].c_str(),
+                                         names[code].size()));
+
+    const vector<G4double>& x = block.column[G4CMPHitWriter::FinalX];
+    const vector<G4double>& y = block.column[G4CMPHitWriter::FinalY];
+    const vector<G4double>& z = block.column[G4CMPHitWriter::FinalZ];
+    const vector<G4double>& t = block.column[G4CMPHitWriter::FinalTime];
+
+    for (size_t hitIdx=0; hitIdx < block.nHits; ++hitIdx) {
+      uint16_t code = block.particle[hitIdx];
+      G4double charge = (code < codeCharge.size()) ? codeCharge[code] : 0.;
+      if (charge == 0.) continue;
+
+      position[0] = x[hitIdx]*m;
+      position[1] = y[hitIdx]*m;
+      position[2] = z[hitIdx]*m;
+      AddCarrier(charge, position, t[hitIdx]*ns);
+    }
+
+    FinishEvent(block.runID, block.eventID);
+  }
+}
+
+// Text hit files have the columns of G4CMPHitWriter::ColumnTitles();
+// fields are converted in place, and traces written at each new event
+
+namespace {
+  const char* NextField(const char* field) {
+    field = strchr(field, ',');
+    return field ? field+1 : 0;
+  }
+}
+
+void ChargeFETDigitizerModule::PostProcessCSV(const G4String& fileName)
 {
   std::ifstream input(fileName);
   if (!input.good()) {
@@ -106,71 +179,229 @@ void ChargeFETDigitizerModule::PostProcess(const G4String& fileName)
     msg << "Error reading data input file from " << fileName;
     G4Exception("ChargeFETDigitizerModule::PostProcess", "Charge002",
     FatalException, msg);
+    return;
   }
-  G4double throw_away;
-  G4String particleName;
+
   G4double position[4] = {0.,0.,0.,0.};
-  G4double charge;
-  G4int RunID, EventID;
-  vector<G4double> scaleFactors(numChannels,0);
+  G4int RunID = -1, EventID = -1;
+  G4bool haveEvent = false;
+  ClearArrivals();
+
+  // Jobs appending to the same file each write a column header line
+  std::string line;
+  while (std::getline(input, line)) {
+    if (line.empty() || !(isdigit(line[0]) || line[0] == '-')) continue;
+
+    const char* field = line.c_str();
+    G4int run = atoi(field);
+    if (!(field = NextField(field))) continue;
+    G4int event = atoi(field);
+
+    if (haveEvent && (run != RunID || event != EventID))
+      FinishEvent(RunID, EventID);
+    RunID = run;
+    EventID = event;
+    haveEvent = true;
+
+    if (!(field = NextField(field))) continue;		// Track ID
+    if (!(field = NextField(field))) continue;		// Particle name
+    G4double charge = CarrierCharge(field, strcspn(field, ","));
+    if (charge == 0.) continue;
+
+    // Start energy, position and time, energy deposit, weight
+    for (size_t i=0; field && i<8; ++i) field = NextField(field);
+
+    for (size_t i=0; field && i<3; ++i) {
+      position[i] = strtod(field, 0)*m;
+      field = NextField(field);
+    }
+    if (!field) continue;
 
-  G4String line;
-  G4String entry;
-  std::getline(input, line); //Grab column headers first
-  while (!std::getline(input, line).eof()) {
-    std::istringstream ssLine(line);
+    AddCarrier(charge, position, strtod(field, 0)*ns);
+  }
 
-    std::getline(ssLine,entry,',');
-    std::istringstream(entry) >> RunID;
+  if (haveEvent) FinishEvent(RunID, EventID);
+}
 
-    std::getline(ssLine,entry,',');
-    std::istringstream(entry) >> EventID;
+// Electrons and holes by name, for post-processing; zero for others
 
-    std::getline(ssLine,entry,',');
-    std::istringstream(entry) >> throw_away;
+G4double ChargeFETDigitizerModule::CarrierCharge(const char* name,
+                                                 size_t length)
+{
+  static const G4String electron = "G4CMPDriftElectron";
+  static const G4String hole = "G4CMPDriftHole";
 
-    std::getline(ssLine,entry,',');
-    std::istringstream(entry) >> particleName;
+  if (length == electron.size() && strncmp(name, electron.c_str(), length) == 0)
+    return -1.;
+  if (length == hole.size() && strncmp(name, hole.c_str(), length) == 0)
+    return 1.;
 
-    for (size_t i=0; i<6; ++i) {
-      std::getline(ssLine,entry,',');
-      std::istringstream(entry) >> throw_away;
-    }
+  return 0.;
+}
 
-    for (size_t i=0; i<3; ++i) {
-      std::getline(ssLine,entry,',');
-      std::istringstream(entry) >> position[i];
-      position[i] *= m;
-    }
+void ChargeFETDigitizerModule::FinishEvent(G4int RunID, G4int EventID)
+{
+  CalculateTraces();
+  WriteFETTraces(RunID, EventID);
+  ClearArrivals();
+}
 
-    std::getline(ssLine,entry,',');
-    std::istringstream(entry) >> throw_away;
+void ChargeFETDigitizerModule::ClearArrivals()
+{
+  arrivals.resize(numChannels*timeBins, 0.);
+  binUsed.resize(numChannels*timeBins, false);
 
-    if (particleName == "G4CMPDriftElectron") {
-      charge = -1;
-    } else if (particleName == "G4CMPDriftElectron") {
-      charge = 1;
-    } else {
-      continue;
+  for (size_t idx: arrivalBins) {
+    arrivals[idx] = 0.;
+    binUsed[idx] = false;
+  }
+  arrivalBins.clear();
+}
+
+// Induced charge on each channel is placed in the carrier's arrival bin,
+// or in the trigger bin (zero) if not time resolved
+
+void ChargeFETDigitizerModule::AddCarrier(G4double charge,
+                                          const G4double position[4],
+                                          G4double arrivalTime)
+{
+  size_t bin = 0;
+  if (timeResolved) {
+    G4double tbin = floor(arrivalTime/dt);
+    if (tbin < 0. || tbin >= timeBins) return;	// Outside of trace
+    bin = static_cast<size_t>(tbin);
+  }
+
+  for(size_t cross = 0; cross < numChannels; ++cross) {
+    size_t idx = cross*timeBins + bin;
+    if (!binUsed[idx]) {
+      binUsed[idx] = true;
+      arrivalBins.push_back(idx);
     }
-    for(size_t chan = 0; chan < numChannels; ++chan) {
-      scaleFactors[chan] -= charge*RamoFields[chan].GetPotential(position);
+    arrivals[idx] -= charge*RamoFields[cross].GetPotential(position);
+  }
+}
+
+// Choose cheapest method to combine arrivals with the templates
+
+void ChargeFETDigitizerModule::CalculateTraces()
+{
+  FETTraces.assign(numChannels*timeBins, 0.);
+
+  if (!timeResolved) {
+    ScaleTemplates();
+    return;
+  }
+
+  // Spectra are missing if binning changed without a rebuild
+  size_t nfft = fft.GetSize();
+  if (nfft < 2*timeBins || templateSpectra.empty()) {
+    ConvolveSparse();
+    return;
+  }
+
+  // Direct sum costs timeBins per occupied bin and template; FFT costs
+  // about 2N*log2(N) per transform, and N per product
+  size_t logN = 0;
+  while ((size_t(1) << logN) < nfft) ++logN;
+
+  G4double directCost = G4double(arrivalBins.size()) * timeBins
+    * templateTerms.size() / numChannels;
+  G4double fftCost = 2.*numChannels * 2.*nfft*logN
+    + G4double(templateTerms.size()) * nfft;
+
+  if (directCost <= fftCost) ConvolveSparse();
+  else ConvolveFFT();
+}
+
+// Scale factors times templates, done in blocks of time bins so that each
+// block of the trace stays in cache while all cross terms are added
+
+void ChargeFETDigitizerModule::ScaleTemplates()
+{
+  const size_t blockSize = 512;
+
+  for (size_t first=0; first < timeBins; first += blockSize) {
+    size_t last = std::min(first+blockSize, timeBins);
+
+    for (const auto& term: templateTerms) {
+      G4double scale = arrivals[term.second*timeBins];
+      if (scale == 0.) continue;
+
+      const G4double* tmpl = &FETTemplates[TemplateIndex(term.first,
+                                                         term.second)];
+      G4double* trace = &FETTraces[term.first*timeBins];
+      for (size_t bin=first; bin < last; ++bin)
+        trace[bin] += scale*tmpl[bin];
     }
   }
+}
 
-  vector<vector<G4double> > FETTraces(CalculateTraces(scaleFactors));
-  WriteFETTraces(FETTraces, RunID, EventID);
+// Shifted copies of the template for each occupied arrival bin
+
+void ChargeFETDigitizerModule::ConvolveSparse()
+{
+  for (const auto& term: templateTerms) {
+    const G4double* tmpl = &FETTemplates[TemplateIndex(term.first,
+                                                       term.second)];
+    G4double* trace = &FETTraces[term.first*timeBins];
+
+    for (size_t idx: arrivalBins) {
+      if (idx/timeBins != term.second || arrivals[idx] == 0.) continue;
+
+      size_t start = idx % timeBins;
+      G4double scale = arrivals[idx];
+      for (size_t bin=start; bin < timeBins; ++bin)
+        trace[bin] += scale*tmpl[bin-start];
+    }
+  }
 }
 
-vector<vector<G4double> > ChargeFETDigitizerModule::CalculateTraces(
-                                    const vector<G4double>& scaleFactors)
+// Product of arrival and template spectra, summed over cross terms
+
+void ChargeFETDigitizerModule::ConvolveFFT()
 {
-  vector<vector<G4double> > FETTraces(numChannels,vector<G4double>(timeBins,0.));
-  for(size_t chan=0; chan < numChannels; ++chan)
-    for(size_t cross=0; cross < numChannels; ++cross)
-      for(size_t bin=0; bin < timeBins; ++bin)
-        FETTraces[chan][bin] += scaleFactors[cross]*FETTemplates[chan][cross][bin];
-  return FETTraces;
+  const size_t nfft = fft.GetSize();
+  arrivalSpectra.resize(numChannels*nfft);
+
+  hasArrivals.assign(numChannels, false);
+  for (size_t idx: arrivalBins) hasArrivals[idx/timeBins] = true;
+
+  fftWork.resize(nfft);
+  for (size_t cross=0; cross < numChannels; ++cross) {
+    if (!hasArrivals[cross]) continue;
+
+    std::fill(fftWork.begin(), fftWork.end(), ChargeFETFFT::Complex(0.));
+    for (size_t bin=0; bin < timeBins; ++bin)
+      fftWork[bin] = arrivals[cross*timeBins + bin];
+
+    fft.Forward(fftWork);
+    std::copy(fftWork.begin(), fftWork.end(),
+              arrivalSpectra.begin()+cross*nfft);
+  }
+
+  for (size_t chan=0; chan < numChannels; ++chan) {
+    traceSpectrum.assign(nfft, ChargeFETFFT::Complex(0.));
+
+    G4bool hasSignal = false;
+    for (size_t term=0; term < templateTerms.size(); ++term) {
+      if (templateTerms[term].first != chan) continue;
+
+      size_t cross = templateTerms[term].second;
+      if (!hasArrivals[cross]) continue;
+
+      const ChargeFETFFT::Complex* tspec = &templateSpectra[term*nfft];
+      const ChargeFETFFT::Complex* aspec = &arrivalSpectra[cross*nfft];
+      for (size_t k=0; k < nfft; ++k) traceSpectrum[k] += tspec[k]*aspec[k];
+      hasSignal = true;
+    }
+
+    if (!hasSignal) continue;
+
+    fft.Inverse(traceSpectrum);
+    for (size_t bin=0; bin < timeBins; ++bin)
+      FETTraces[chan*timeBins + bin] = traceSpectrum[bin].real();
+  }
 }
 
 void ChargeFETDigitizerModule::ReadFETConstantsFile()
@@ -228,6 +459,8 @@ void ChargeFETDigitizerModule::ReadFETConstantsFile()
           SetUnitTime(atof(varVal)*s);
         else if(varName == "preTrig")
           SetPreTrig(atof(varVal)*s);
+        else if(varName == "timeResolved")
+          SetTimeResolved(atoi(varVal) != 0);
         else if(varName == "templateFilename")
           SetTemplateFilename(varVal.substr(1,varVal.length()-2)); //strip quotes
         else if(varName == "ramoFileDir") {
@@ -247,15 +480,11 @@ void ChargeFETDigitizerModule::ReadFETConstantsFile()
 
 void ChargeFETDigitizerModule::BuildFETTemplates()
 {
-  FETTemplates = vector<vector<vector<G4double> > >
-    (numChannels, vector<vector<G4double> >
-    (numChannels, vector<G4double>(timeBins, 0) ) );
+  FETTemplates.assign(numChannels*numChannels*timeBins, 0.);
   templateFile.open(templateFilename.c_str());
   if(templateFile.good()) {
-    for(size_t i=0; i<numChannels; ++i)
-      for(size_t j=0; j<numChannels; ++j)
-        for(size_t k=0; k<timeBins; ++k)
-          templateFile >> FETTemplates[i][j][k];
+    for(size_t i=0; i<numChannels*numChannels*timeBins; ++i)
+      templateFile >> FETTemplates[i];
   } else {
     G4Exception("ChargeFETDigitizerModule::BuildFETTemplate", "Charge007",
 		JustWarning,
@@ -263,16 +492,62 @@ void ChargeFETDigitizerModule::BuildFETTemplates()
 
     for(size_t i=0; i<numChannels; ++i) {
       size_t ndt = static_cast<size_t>(preTrig/dt);
+      G4double* tmpl = &FETTemplates[TemplateIndex(i,i)];
       for(size_t j=0; j<ndt; ++j)
-        FETTemplates[i][i][j] = 0;
+        tmpl[j] = 0;
       for(size_t k=1; k<timeBins-ndt+1; ++k)
-        FETTemplates[i][i][k+ndt-1] = exp(-k*dt/decayTime);
+        tmpl[k+ndt-1] = exp(-k*dt/decayTime);
     }
   }
   templateFile.close();
+
+  // Cross-talk templates are often all zero, and can be skipped
+  templateTerms.clear();
+  for(size_t i=0; i<numChannels; ++i) {
+    for(size_t j=0; j<numChannels; ++j) {
+      const G4double* tmpl = &FETTemplates[TemplateIndex(i,j)];
+      for(size_t k=0; k<timeBins; ++k) {
+        if (tmpl[k] != 0.) {
+          templateTerms.push_back(std::make_pair(i,j));
+          break;
+        }
+      }
+    }
+  }
+
+  // Per-event buffers depend on binning
+  arrivals.assign(numChannels*timeBins, 0.);
+  binUsed.assign(numChannels*timeBins, false);
+  arrivalBins.clear();
+
+  BuildTemplateSpectra();
   rebuildFETTemplates = false;
 }
 
+// Zero-padded to avoid wrap-around, since traces are not periodic
+
+void ChargeFETDigitizerModule::BuildTemplateSpectra()
+{
+  templateSpectra.clear();
+  if (!timeResolved) return;
+
+  fft.SetSize(2*timeBins);
+  const size_t nfft = fft.GetSize();
+
+  templateSpectra.resize(templateTerms.size()*nfft);
+  fftWork.resize(nfft);
+  for (size_t term=0; term < templateTerms.size(); ++term) {
+    const G4double* tmpl = &FETTemplates[TemplateIndex(templateTerms[term].first,
+                                                       templateTerms[term].second)];
+    std::fill(fftWork.begin(), fftWork.end(), ChargeFETFFT::Complex(0.));
+    for (size_t bin=0; bin < timeBins; ++bin) fftWork[bin] = tmpl[bin];
+
+    fft.Forward(fftWork);
+    std::copy(fftWork.begin(), fftWork.end(),
+              templateSpectra.begin()+term*nfft);
+  }
+}
+
 void ChargeFETDigitizerModule::BuildRamoFields()
 {
   if (RamoFields.size()) RamoFields.clear();
@@ -293,15 +568,15 @@ void ChargeFETDigitizerModule::BuildRamoFields()
   rebuildRamoFields = false;
 }
 
-void ChargeFETDigitizerModule::WriteFETTraces(
-  const vector<vector<G4double> >& traces, G4int RunID, G4int EventID)
+void ChargeFETDigitizerModule::WriteFETTraces(G4int RunID, G4int EventID)
 {
   for(size_t chan = 0; chan < numChannels; ++chan) {
+    const G4double* trace = &FETTraces[chan*timeBins];
     outputFile << RunID << "," << EventID << "," << chan+1 << ",";
     for(size_t bin = 0; bin < timeBins-1; ++bin) {
-      outputFile << traces[chan][bin] << ",";
+      outputFile << trace[bin] << ",";
     }
-    outputFile << traces[chan][timeBins-1] << "\n";
+    outputFile << trace[timeBins-1] << "\n";
   }
 }
 
@@ -388,3 +663,13 @@ void ChargeFETDigitizerModule::SetPreTrig(G4double n)
   preTrig = n;
   rebuildFETTemplates = true;
 }
+
+void ChargeFETDigitizerModule::SetTimeResolved(G4bool b)
+{
+  if (timeResolved == b) return;
+  timeResolved = b;
+
+  // Templates themselves don't change; only their spectra are needed
+  if (rebuildFETTemplates) return;
+  BuildTemplateSpectra();
+}
@@ -0,0 +1,73 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+#include "ChargeFETFFT.hh"
+#include "G4PhysicalConstants.hh"
+#include <math.h>
+#include <utility>
+
+size_t ChargeFETFFT::NextPowerOfTwo(size_t n)
+{
+  size_t p = 1;
+  while (p < n) p <<= 1;
+  return p;
+}
+
+void ChargeFETFFT::SetSize(size_t n)
+{
+  size = (n > 0) ? NextPowerOfTwo(n) : 0;
+
+  twiddle.resize(size/2);
+  for (size_t k=0; k<size/2; ++k) {
+    G4double phase = -twopi*k/size;
+    twiddle[k] = Complex(cos(phase), sin(phase));
+  }
+
+  size_t nbits = 0;
+  while ((size_t(1) << nbits) < size) ++nbits;
+
+  bitReverse.resize(size);
+  for (size_t i=0; i<size; ++i) {
+    size_t r = 0;
+    for (size_t b=0; b<nbits; ++b) r |= ((i >> b) & 1) << (nbits-1-b);
+    bitReverse[i] = r;
+  }
+}
+
+void ChargeFETFFT::Inverse(std::vector<Complex>& data) const
+{
+  Transform(data, true);
+
+  G4double norm = 1./size;
+  for (size_t i=0; i<size; ++i) data[i] *= norm;
+}
+
+// Iterative Cooley-Tukey; inverse uses conjugate twiddles
+
+void ChargeFETFFT::Transform(std::vector<Complex>& data, G4bool inverse) const
+{
+  if (data.size() != size) {
+    G4Exception("ChargeFETFFT::Transform", "Charge010", FatalErrorInArgument,
+		"Data length does not match FFT size.");
+    return;
+  }
+
+  for (size_t i=0; i<size; ++i) {
+    if (i < bitReverse[i]) std::swap(data[i], data[bitReverse[i]]);
+  }
+
+  for (size_t len=2; len<=size; len <<= 1) {
+    size_t half = len/2;
+    size_t step = size/len;
+    for (size_t start=0; start<size; start += len) {
+      for (size_t k=0; k<half; ++k) {
+	Complex w = inverse ? std::conj(twiddle[k*step]) : twiddle[k*step];
+	Complex t = w * data[start+k+half];
+	data[start+k+half] = data[start+k] - t;
+	data[start+k] += t;
+      }
+    }
+  }
+}
@@ -0,0 +1,81 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+#include "ChargeRamoDigitizerMessenger.hh"
+#include "ChargeRamoDigitizerModule.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithABool.hh"
+
+ChargeRamoDigitizerMessenger::ChargeRamoDigitizerMessenger(
+                          ChargeRamoDigitizerModule* digitizer) : ramo(digitizer)
+{
+  ramoDir = new G4UIdirectory("/g4cmp/RamoSim/");
+  ramoDir->SetGuidance("Time-resolved Shockley-Ramo digitizer commands");
+
+  EnableCmd = new G4UIcmdWithABool("/g4cmp/RamoSim/Enable",this);
+  EnableCmd->SetGuidance("Enable or disable induced charge traces during run.");
+  EnableCmd->SetDefaultValue(true);
+
+  SetOutputFileCmd = new G4UIcmdWithAString("/g4cmp/RamoSim/SetOutputFile",this);
+  SetOutputFileCmd->SetGuidance("Set path to induced charge output file.");
+
+  SetRamoFileDirCmd = new G4UIcmdWithAString("/g4cmp/RamoSim/SetRamoFileDir",this);
+  SetRamoFileDirCmd->SetGuidance("Set path to Ramo potential files.");
+
+  SetNumChanCmd = new G4UIcmdWithAnInteger("/g4cmp/RamoSim/SetNumberOfChannels",this);
+  SetNumChanCmd->SetGuidance("Number of channels needs to match number of Ramo potential files.");
+  SetNumChanCmd->SetParameterName("N",false);
+  SetNumChanCmd->SetRange("N>0");
+
+  SetTimeBinCmd = new G4UIcmdWithAnInteger("/g4cmp/RamoSim/SetNumberOfBins",this);
+  SetTimeBinCmd->SetGuidance("Set number of time bins in traces");
+  SetTimeBinCmd->SetParameterName("N",false);
+  SetTimeBinCmd->SetRange("N>0");
+
+  SetUnitTimeCmd = new G4UIcmdWithADoubleAndUnit("/g4cmp/RamoSim/SetUnitTime",this);
+  SetUnitTimeCmd->SetGuidance("Set width of trace time bins");
+  SetUnitTimeCmd->SetParameterName("dt",false);
+  SetUnitTimeCmd->SetRange("dt>0");
+  SetUnitTimeCmd->SetUnitCategory("Time");
+
+  UpdateCmd = new G4UIcmdWithoutParameter("/g4cmp/RamoSim/Update",this);
+  UpdateCmd->SetGuidance("Reload Ramo potentials after changing parameters.");
+}
+
+ChargeRamoDigitizerMessenger::~ChargeRamoDigitizerMessenger()
+{
+    delete ramoDir;
+    delete EnableCmd;
+    delete SetOutputFileCmd;
+    delete SetRamoFileDirCmd;
+    delete SetNumChanCmd;
+    delete SetTimeBinCmd;
+    delete SetUnitTimeCmd;
+    delete UpdateCmd;
+}
+
+void ChargeRamoDigitizerMessenger::SetNewValue(G4UIcommand* command, G4String NewValue)
+{
+  if (command == EnableCmd) {
+    if (EnableCmd->GetNewBoolValue(NewValue)) ramo->EnableRamoSim();
+    else ramo->DisableRamoSim();
+  }
+  else if (command == SetOutputFileCmd)
+    ramo->SetOutputFile(NewValue);
+  else if (command == SetRamoFileDirCmd)
+    ramo->SetRamoFileDir(NewValue);
+  else if (command == SetNumChanCmd)
+    ramo->SetNumberOfChannels(SetNumChanCmd->GetNewIntValue(NewValue));
+  else if (command == SetTimeBinCmd)
+    ramo->SetTimeBins(SetTimeBinCmd->GetNewIntValue(NewValue));
+  else if (command == SetUnitTimeCmd)
+    ramo->SetUnitTime(SetUnitTimeCmd->GetNewDoubleValue(NewValue));
+  else if (command == UpdateCmd)
+    ramo->Build();
+}
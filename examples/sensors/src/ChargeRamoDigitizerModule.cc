@@ -0,0 +1,250 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+#include "ChargeRamoDigitizerModule.hh"
+#include "ChargeRamoDigitizerMessenger.hh"
+#include "G4CMPMeshElectricField.hh"
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Track.hh"
+#include <algorithm>
+#include <math.h>
+#include <sstream>
+
+ChargeRamoDigitizerModule::ChargeRamoDigitizerModule(G4String modName) :
+  G4VDigitizerModule(modName),
+  messenger(new ChargeRamoDigitizerMessenger(this)),
+  dt(800e-9*s), numChannels(4), timeBins(4096), enabled(false),
+  rebuildRamoFields(true), outputFilename("RamoOutput"),
+  ramoFileDir("config/G4CMP/FETSim"), lastTrackID(-1), stepEventID(-1)
+{}
+
+ChargeRamoDigitizerModule::~ChargeRamoDigitizerModule()
+{
+  delete messenger;
+  if (outputFile.is_open()) outputFile.close();
+}
+
+void ChargeRamoDigitizerModule::Build()
+{
+  SetOutputFile(outputFilename);
+  if (rebuildRamoFields)
+    BuildRamoFields();
+}
+
+void ChargeRamoDigitizerModule::EnableRamoSim()
+{
+  enabled = true;
+  if (RamoFields.size() == 0) { // Need to initiate first build.
+    Build();
+  }
+}
+
+// Only positions, times and charge are kept; Ramo potentials are
+// evaluated in one pass per channel at the end of the event
+
+void ChargeRamoDigitizerModule::AddStep(const G4Step* step)
+{
+  if (!enabled) return;
+
+  // Event ID is -1 outside of event processing (standalone use)
+  const G4Event* event =
+    G4EventManager::GetEventManager()->GetConstCurrentEvent();
+  G4int eventID = event ? event->GetEventID() : -1;
+  if (eventID != stepEventID) {
+    ClearSteps();
+    stepEventID = eventID;
+  }
+
+  const G4Track* track = step->GetTrack();
+  if (track->GetTrackID() != lastTrackID || track->GetCurrentStepNumber() == 1) {
+    const G4StepPoint* pre = step->GetPreStepPoint();
+    stepPoints.push_back(pre->GetPosition());
+    stepTimes.push_back(pre->GetGlobalTime());
+    stepCharges.push_back(0.);
+    lastTrackID = track->GetTrackID();
+  }
+
+  const G4StepPoint* post = step->GetPostStepPoint();
+  stepPoints.push_back(post->GetPosition());
+  stepTimes.push_back(post->GetGlobalTime());
+  stepCharges.push_back(track->GetParticleDefinition()->GetPDGCharge()/eplus);
+}
+
+void ChargeRamoDigitizerModule::ClearSteps()
+{
+  stepPoints.clear();
+  stepTimes.clear();
+  stepCharges.clear();
+  lastTrackID = -1;
+}
+
+void ChargeRamoDigitizerModule::Digitize()
+{
+  if (!enabled) return;
+
+  G4int runID = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+  G4int eventID = G4RunManager::GetRunManager()->GetCurrentEvent()->GetEventID();
+  FinishEvent(runID, eventID);
+}
+
+void ChargeRamoDigitizerModule::FinishEvent(G4int RunID, G4int EventID)
+{
+  CalculateTraces();
+  WriteTraces(RunID, EventID);
+  ClearSteps();
+}
+
+// Induced charge on electrode is Q = -q*phi(x), so each step adds
+// -q*(phi(post)-phi(pre))
+
+void ChargeRamoDigitizerModule::CalculateTraces()
+{
+  traces.assign(numChannels*timeBins, 0.);
+  if (stepPoints.empty()) return;
+
+  for (size_t chan=0; chan < RamoFields.size() && chan < numChannels; ++chan) {
+    RamoFields[chan].GetPotential(stepPoints, potentials);
+
+    G4double* trace = &traces[chan*timeBins];
+    for (size_t k=1; k < stepPoints.size(); ++k) {
+      if (stepCharges[k] == 0.) continue;	// Start of new track
+
+      G4double dQ = -stepCharges[k] * (potentials[k] - potentials[k-1]);
+      if (dQ != 0.) AddCharge(trace, dQ, stepTimes[k-1]/dt, stepTimes[k]/dt);
+    }
+
+    for (size_t bin=1; bin < timeBins; ++bin) trace[bin] += trace[bin-1];
+  }
+}
+
+// Spread charge uniformly over the bins covered by [t0,t1] (in bins);
+// charge induced before the trace starts goes in the first bin
+
+void ChargeRamoDigitizerModule::AddCharge(G4double* trace, G4double dQ,
+                                          G4double t0, G4double t1)
+{
+  const G4double tmax = timeBins;
+  if (t0 >= tmax) return;			// After end of trace
+
+  t0 = std::max(t0, 0.);
+  t1 = std::max(t1, 0.);
+
+  size_t first = static_cast<size_t>(floor(t0));
+  if (t1 <= t0 || t1 < first+1.) {		// Step within one bin
+    trace[first] += dQ;
+    return;
+  }
+
+  G4double rate = dQ / (t1-t0);
+  G4double lo = t0;
+  for (size_t bin=first; bin < timeBins && lo < t1; ++bin) {
+    G4double hi = std::min(bin+1., t1);
+    trace[bin] += rate*(hi-lo);
+    lo = hi;
+  }
+}
+
+void ChargeRamoDigitizerModule::BuildRamoFields()
+{
+  if (RamoFields.size()) RamoFields.clear();
+
+  for(size_t i=0; i < numChannels; ++i) {
+    std::stringstream name;
+    name << ramoFileDir << "/EpotRamoChan" << i+1;
+    std::ifstream ramoFile(name.str().c_str());
+    if(ramoFile.good()) {
+      ramoFile.close();
+      RamoFields.emplace_back(name.str());
+    } else {
+      ramoFile.close();
+      G4cerr << "ChargeRamoDigitizerModule::BuildRamoFields(): ERROR: Could"
+        << " not open Ramo files for each channel." << G4endl;
+    }
+  }
+  rebuildRamoFields = false;
+}
+
+void ChargeRamoDigitizerModule::WriteTraces(G4int RunID, G4int EventID)
+{
+  if (!outputFile.is_open()) return;
+
+  for(size_t chan = 0; chan < numChannels; ++chan) {
+    const G4double* trace = &traces[chan*timeBins];
+    outputFile << RunID << "," << EventID << "," << chan+1 << ",";
+    for(size_t bin = 0; bin < timeBins-1; ++bin) {
+      outputFile << trace[bin] << ",";
+    }
+    outputFile << trace[timeBins-1] << "\n";
+  }
+}
+
+void ChargeRamoDigitizerModule::SetOutputFile(const G4String& fn)
+{
+  if (outputFilename != fn || !outputFile.is_open()) {
+    if (outputFile.is_open()) outputFile.close();
+    outputFilename = fn;
+    outputFile.open(outputFilename, std::ios_base::app);
+    if (!outputFile.good()) {
+      G4ExceptionDescription msg;
+      msg << "Error opening output file, " << outputFilename << ".\n"
+          << "Will continue simulation.";
+      G4Exception("ChargeRamoDigitizerModule::SetOutputFile", "Charge011",
+                  JustWarning, msg);
+      outputFile.close();
+    } else {
+      outputFile << "Run ID,Event ID,Channel,Induced Charge [e] ("
+                 << timeBins << " bins)" << G4endl;
+    }
+  }
+}
+
+void ChargeRamoDigitizerModule::SetRamoFileDir(const G4String& name)
+{
+  if (ramoFileDir == name) return;
+  ramoFileDir = name;
+  rebuildRamoFields = true;
+}
+
+void ChargeRamoDigitizerModule::SetNumberOfChannels(size_t n)
+{
+  if (n == 0) {
+    G4Exception("ChargeRamoDigitizerModule::SetNumberOfChannels", "Charge012",
+                JustWarning, "Number of channels must be positive.");
+    return;
+  }
+
+  if (numChannels == n) return;
+  numChannels = n;
+  rebuildRamoFields = true;
+}
+
+void ChargeRamoDigitizerModule::SetTimeBins(size_t n)
+{
+  if (n == 0) {
+    G4Exception("ChargeRamoDigitizerModule::SetTimeBins", "Charge013",
+                JustWarning, "Number of time bins must be positive.");
+    return;
+  }
+
+  timeBins = n;
+}
+
+void ChargeRamoDigitizerModule::SetUnitTime(G4double t)
+{
+  if (t <= 0.) {
+    G4Exception("ChargeRamoDigitizerModule::SetUnitTime", "Charge014",
+                JustWarning, "Time bin width must be positive.");
+    return;
+  }
+
+  dt = t;
+}
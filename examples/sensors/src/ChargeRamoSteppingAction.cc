@@ -0,0 +1,18 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+#include "ChargeRamoSteppingAction.hh"
+#include "ChargeRamoDigitizerModule.hh"
+#include "G4CMPUtils.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+
+void ChargeRamoSteppingAction::UserSteppingAction(const G4Step* step)
+{
+  if (!ramo || !ramo->RamoSimIsEnabled()) return;
+
+  if (G4CMP::IsChargeCarrier(step->GetTrack()->GetParticleDefinition()))
+    ramo->AddStep(step);
+}
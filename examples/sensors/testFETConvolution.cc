@@ -0,0 +1,112 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+// Usage: testFETConvolution [timeBins] [nArrivals]
+//
+// Convolve random carrier arrivals with a FET-like pulse template, once
+// by direct sum of shifted templates and once with ChargeFETFFT, zero
+// padded to 2*timeBins as in ChargeFETDigitizerModule::ConvolveFFT().
+// The two traces must agree to within rounding of the FFT.
+
+#include "ChargeFETFFT.hh"
+#include "Randomize.hh"
+#include <algorithm>
+#include <cmath>
+#include <stdlib.h>
+#include <vector>
+
+namespace {
+  const G4double tolerance = 1e-12;	// Relative to largest trace value
+}
+
+
+// Fast rise and slow decay, in units of bins, normalized to unit peak
+
+std::vector<G4double> MakeTemplate(size_t timeBins) {
+  const G4double rise = 5., fall = 0.1*timeBins;
+
+  std::vector<G4double> tmpl(timeBins);
+  for (size_t bin=0; bin<timeBins; bin++)
+    tmpl[bin] = std::exp(-G4double(bin)/fall) - std::exp(-G4double(bin)/rise);
+
+  G4double peak = *std::max_element(tmpl.begin(), tmpl.end());
+  for (G4double& v: tmpl) v /= peak;
+
+  return tmpl;
+}
+
+std::vector<G4double> ConvolveDirect(const std::vector<G4double>& arrivals,
+				     const std::vector<G4double>& tmpl) {
+  const size_t timeBins = tmpl.size();
+  std::vector<G4double> trace(timeBins, 0.);
+
+  for (size_t start=0; start<timeBins; start++) {
+    if (arrivals[start] == 0.) continue;
+    for (size_t bin=start; bin<timeBins; bin++)
+      trace[bin] += arrivals[start]*tmpl[bin-start];
+  }
+
+  return trace;
+}
+
+std::vector<G4double> ConvolveFFT(const std::vector<G4double>& arrivals,
+				  const std::vector<G4double>& tmpl) {
+  const size_t timeBins = tmpl.size();
+  ChargeFETFFT fft(2*timeBins);
+  const size_t nfft = fft.GetSize();
+
+  std::vector<ChargeFETFFT::Complex> tspec(nfft, 0.), aspec(nfft, 0.);
+  std::copy(tmpl.begin(), tmpl.end(), tspec.begin());
+  std::copy(arrivals.begin(), arrivals.end(), aspec.begin());
+
+  fft.Forward(tspec);
+  fft.Forward(aspec);
+  for (size_t k=0; k<nfft; k++) aspec[k] *= tspec[k];
+  fft.Inverse(aspec);
+
+  std::vector<G4double> trace(timeBins);
+  for (size_t bin=0; bin<timeBins; bin++) trace[bin] = aspec[bin].real();
+
+  return trace;
+}
+
+
+int main(int argc, char* argv[]) {
+  size_t timeBins = (argc>1) ? strtoul(argv[1], 0, 10) : 4096;
+  size_t nArrivals = (argc>2) ? strtoul(argv[2], 0, 10) : 1000;
+
+  G4cout << "Testing ChargeFETFFT convolution with " << timeBins
+	 << " time bins, " << nArrivals << " carriers" << G4endl;
+
+  // Electrons and holes, arriving anywhere in the trace
+  std::vector<G4double> arrivals(timeBins, 0.);
+  for (size_t i=0; i<nArrivals; i++) {
+    size_t bin = std::min(size_t(G4UniformRand()*timeBins), timeBins-1);
+    arrivals[bin] += (G4UniformRand() < 0.5 ? -1. : 1.) * G4UniformRand();
+  }
+
+  std::vector<G4double> tmpl = MakeTemplate(timeBins);
+  std::vector<G4double> direct = ConvolveDirect(arrivals, tmpl);
+  std::vector<G4double> viaFFT = ConvolveFFT(arrivals, tmpl);
+
+  G4double maxValue = 0., maxDiff = 0.;
+  for (size_t bin=0; bin<timeBins; bin++) {
+    maxValue = std::max(maxValue, std::fabs(direct[bin]));
+    maxDiff = std::max(maxDiff, std::fabs(viaFFT[bin]-direct[bin]));
+  }
+
+  G4double relDiff = (maxValue > 0.) ? maxDiff/maxValue : maxDiff;
+  G4cout << "Largest trace value " << maxValue << ", largest difference "
+	 << maxDiff << " (relative " << relDiff << ")" << G4endl;
+
+  if (relDiff > tolerance) {
+    G4cerr << "ERROR: FFT and direct convolution differ by " << relDiff
+	   << ", more than " << tolerance << G4endl;
+    return 1;
+  }
+
+  G4cout << "All checks passed" << G4endl;
+  return 0;
+}
@@ -0,0 +1,156 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+// Usage: testRamoSim [nEvents]
+//
+// Drive ChargeRamoDigitizerModule through ChargeRamoSteppingAction with
+// hand-made electron steps, outside of a Geant4 run.  Two linear Ramo
+// potentials across a 1 cm cube are written to the current directory
+// (EpotRamoChan1, EpotRamoChan2), so the induced charge can be checked
+// exactly.  Each event drifts one electron through half the cube, then
+// FinishEvent() must leave no recorded steps behind.
+
+#include "ChargeRamoDigitizerModule.hh"
+#include "ChargeRamoSteppingAction.hh"
+#include "G4CMPDriftElectron.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Track.hh"
+#include <cmath>
+#include <fstream>
+#include <stdlib.h>
+
+namespace {
+  G4int nErrors = 0;		// Increment counter at failed checks
+
+  const G4double halfSize = 5.*mm;	// Cube is [-5,5] mm on each axis
+  const size_t nBins = 100;
+  const G4double binWidth = 10.*ns;
+}
+
+
+// Channel 1 potential rises from 0 to 1 along z, channel 2 falls
+
+void WriteRamoFiles() {
+  std::ofstream chan1("EpotRamoChan1"), chan2("EpotRamoChan2");
+
+  const G4int nGrid = 5;
+  for (G4int i=0; i<nGrid; i++) {
+    for (G4int j=0; j<nGrid; j++) {
+      for (G4int k=0; k<nGrid; k++) {
+	G4double x = (-1. + 2.*i/(nGrid-1)) * halfSize/m;
+	G4double y = (-1. + 2.*j/(nGrid-1)) * halfSize/m;
+	G4double z = (-1. + 2.*k/(nGrid-1)) * halfSize/m;
+	G4double v = G4double(k)/(nGrid-1);
+
+	chan1 << x << " " << y << " " << z << " " << v << "\n";
+	chan2 << x << " " << y << " " << z << " " << 1.-v << "\n";
+      }
+    }
+  }
+}
+
+G4double RamoPotential(size_t chan, const G4ThreeVector& pos) {
+  G4double v = (pos.z()+halfSize) / (2.*halfSize);
+  return (chan == 0) ? v : 1.-v;
+}
+
+
+// Electron moves in nSteps equal steps from start to end over [t0,t1]
+
+void DriftElectron(ChargeRamoSteppingAction& stepping, G4int trackID,
+		   const G4ThreeVector& start, const G4ThreeVector& end,
+		   G4double t0, G4double t1, G4int nSteps) {
+  G4DynamicParticle* dyn =
+    new G4DynamicParticle(G4CMPDriftElectron::Definition(),
+			  (end-start).unit(), 1.*eV);
+  G4Track track(dyn, t0, start);
+  track.SetTrackID(trackID);
+
+  G4Step step;
+  step.SetTrack(&track);
+
+  for (G4int i=0; i<nSteps; i++) {
+    track.IncrementCurrentStepNumber();
+
+    step.GetPreStepPoint()->SetPosition(start + (end-start)*i/nSteps);
+    step.GetPreStepPoint()->SetGlobalTime(t0 + (t1-t0)*i/nSteps);
+    step.GetPostStepPoint()->SetPosition(start + (end-start)*(i+1)/nSteps);
+    step.GetPostStepPoint()->SetGlobalTime(t0 + (t1-t0)*(i+1)/nSteps);
+
+    stepping.UserSteppingAction(&step);
+  }
+
+  step.SetTrack(0);		// Track is owned here, not by step
+}
+
+void Check(const char* what, G4double value, G4double expect) {
+  if (std::fabs(value-expect) > 1e-6) {
+    G4cerr << "ERROR: " << what << " " << value << ", expected " << expect
+	   << G4endl;
+    nErrors++;
+  }
+}
+
+
+int main(int argc, char* argv[]) {
+  G4int nEvents = (argc>1) ? atoi(argv[1]) : 3;
+
+  G4cout << "Testing ChargeRamoDigitizerModule with " << nEvents
+	 << " events" << G4endl;
+
+  WriteRamoFiles();
+
+  ChargeRamoDigitizerModule ramo("RamoTest");
+  ramo.SetRamoFileDir(".");
+  ramo.SetNumberOfChannels(2);
+  ramo.SetTimeBins(nBins);
+  ramo.SetUnitTime(binWidth);
+  ramo.SetOutputFile("RamoTestOutput");
+  ramo.EnableRamoSim();
+
+  ChargeRamoSteppingAction stepping(&ramo);
+
+  // Drift from z=-2.5 mm to z=+2.5 mm between 100 and 600 ns
+  G4ThreeVector start(1.*mm, -1.*mm, -2.5*mm), end(1.*mm, -1.*mm, 2.5*mm);
+  G4double t0 = 100.*ns, t1 = 600.*ns;
+
+  for (G4int evt=0; evt<nEvents; evt++) {
+    DriftElectron(stepping, 1, start, end, t0, t1, 10+evt);
+    if (ramo.GetNumberOfSteps() == 0) {
+      G4cerr << "ERROR: event " << evt << " recorded no steps" << G4endl;
+      nErrors++;
+    }
+
+    ramo.FinishEvent(0, evt);
+    if (ramo.GetNumberOfSteps() != 0) {
+      G4cerr << "ERROR: event " << evt << " left " << ramo.GetNumberOfSteps()
+	     << " steps after FinishEvent()" << G4endl;
+      nErrors++;
+    }
+
+    // Electron (q = -1) induces Q = +(phi(end)-phi(start)) on each channel
+    const vector<G4double>& traces = ramo.GetTraces();
+    for (size_t chan=0; chan<2; chan++) {
+      G4double dPhi = RamoPotential(chan, end) - RamoPotential(chan, start);
+      const G4double* trace = &traces[chan*nBins];
+
+      Check("Charge before drift", trace[size_t(t0/binWidth)-1], 0.);
+      Check("Charge at mid-drift", trace[size_t(0.5*(t0+t1)/binWidth)-1],
+	    0.5*dPhi);
+      Check("Charge after drift", trace[nBins-1], dPhi);
+    }
+  }
+
+  if (nErrors > 0) {
+    G4cerr << nErrors << " checks failed" << G4endl;
+    return 1;
+  }
+
+  G4cout << "All checks passed" << G4endl;
+  return 0;
+}
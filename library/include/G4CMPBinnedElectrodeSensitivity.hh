@@ -0,0 +1,86 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/include/G4CMPBinnedElectrodeSensitivity.hh
+/// \brief Definition of the G4CMPBinnedElectrodeSensitivity class.  An
+///   alternative to G4CMPElectrodeSensitivity which accumulates weighted
+///   energy into fixed per-channel, per-time-bin arrays, rather than one
+///   G4CMPElectrodeHit per absorbed track.  No hits collection is made,
+///   and memory use is set by the binning, not by the size of the event.
+///
+///   Channels are taken from the copy number of the volume the track
+///   enters (the electrode); subclasses may override ChannelOf().
+///   Arrays are cleared in Initialize(); users should read them from an
+///   EndOfEvent() override or from their event action.
+///
+// $Id$
+//
+// 20201108  New class for aggregated electrode output
+
+#ifndef G4CMPBinnedElectrodeSensitivity_hh
+#define G4CMPBinnedElectrodeSensitivity_hh 1
+
+#include "G4CMPElectrodeSensitivity.hh"
+#include <vector>
+
+class G4Step;
+
+
+class G4CMPBinnedElectrodeSensitivity : public G4CMPElectrodeSensitivity {
+public:
+  G4CMPBinnedElectrodeSensitivity(G4String name, size_t nChannels,
+				  size_t nBins, G4double binWidth,
+				  G4double startTime=0.);
+  virtual ~G4CMPBinnedElectrodeSensitivity() {;}
+
+  // Changing binning resizes (and clears) the arrays
+  void SetChannels(size_t nChannels);
+  void SetTimeBins(size_t nBins, G4double binWidth, G4double startTime=0.);
+
+  // Copy number depth for default channel assignment (0 = entered volume)
+  void SetChannelDepth(G4int depth) { channelDepth = depth; }
+
+  size_t GetNumberOfChannels() const { return nChan; }
+  size_t GetNumberOfBins() const { return nBin; }
+  G4double GetBinWidth() const { return width; }
+  G4double GetStartTime() const { return tStart; }
+
+  // Contiguous time bins for one channel, [GetNumberOfBins()]
+  const G4double* GetChannel(size_t chan) const {
+    return &energy[chan*nBin];
+  }
+
+  G4double GetEnergy(size_t chan, size_t bin) const {
+    return energy[chan*nBin+bin];
+  }
+
+  // Energy from hits outside of the channel or time range
+  G4double GetLostEnergy() const { return lostEnergy; }
+
+  virtual void Initialize(G4HCofThisEvent*) override;
+
+protected:
+  virtual G4bool ProcessHits(G4Step*, G4TouchableHistory*) override;
+
+  // Channel index for hit; values outside [0,nChannels) are discarded
+  virtual G4int ChannelOf(const G4Step* step) const;
+
+  // Quantity accumulated for hit, default is weighted energy deposit
+  virtual G4double HitValue(const G4Step* step) const;
+
+  void Clear();
+
+private:
+  size_t nChan;
+  size_t nBin;
+  G4double width;
+  G4double tStart;
+  G4int channelDepth;
+
+  std::vector<G4double> energy;		// Channel-major, [nChan*nBin]
+  G4double lostEnergy;
+};
+
+#endif	/* G4CMPBinnedElectrodeSensitivity_hh */
@@ -18,12 +18,17 @@
 //
 // 20170925  Add direct access to individual positions in cloud, binning
 // 20180831  Fix compiler warning on GetPositionBin()
+// 20201026  Generate points in batches, skipping boundary checks inside
+//		safety radius; replace packed zzzyyyxxx bin index with
+//		hash lookup of (i,j,k) bins, numbered sequentially.
+// 20201030  Draw random numbers from per-thread G4CMPRandomStream
 
 #ifndef G4CMPChargeCloud_hh
 #define G4CMPChargeCloud_hh 1
 
 #include "globals.hh"
 #include "G4ThreeVector.hh"
+#include <unordered_map>
 #include <vector>
 
 class G4LatticeLogical;
@@ -66,8 +71,10 @@ public:
   const std::vector<G4ThreeVector>& GetCloud() const { return theCloud; }
   const G4ThreeVector& GetPosition(G4int i) const { return theCloud[i]; }
 
+  // Bins are numbered sequentially from zero as they are filled
   const std::vector<G4int>& GetCloudBins() const { return theCloudBins; }
   G4int GetPositionBin(G4int i) const { return theCloudBins[i]; }
+  G4int GetNumberOfBins() const { return (G4int)theBinCenters.size(); }
   G4ThreeVector GetBinCenter(G4int ibin) const;
 
   G4double GetRadius() const { return cloudRadius; }
@@ -91,14 +98,35 @@ protected:
   G4double radiusScale;			// Cloud radius per e/h pair (cbrt)
   G4double binSpacing;			// Bin size for primary clumping
 
-  // Convert local position to bin index (pass-by-value for use as temporary)
-  G4int GetBinIndex(G4ThreeVector localPos) const;
+  // Fill buffers with points in sphere, relative to center
+  void GeneratePoints(G4int npos, G4double rmax);
+
+  // Convert local position to bin index, adding new bin if necessary
+  G4int GetBinIndex(const G4ThreeVector& localPos);
+
+  // Pack (i,j,k) bin coordinates for hash lookup
+  typedef unsigned long long BinKey;
+  BinKey MakeBinKey(const G4ThreeVector& localPos) const;
+
+  struct BinHash {		// Mix bits so nearby bins are well spread
+    size_t operator()(BinKey key) const {
+      key ^= key >> 33;
+      key *= 0xff51afd7ed558ccdULL;
+      key ^= key >> 33;
+      return (size_t)key;
+    }
+  };
 
 private:
   std::vector<G4ThreeVector> theCloud;	// Buffer to carry generated points
   G4double cloudRadius;			// Radius used to generate distribution
   G4ThreeVector localCenter;		// Local center point of distribution
   std::vector<G4int> theCloudBins;	// Buffer for bin indices at points
+
+  std::vector<G4double> xBuf, yBuf, zBuf, rBuf;	// Batched point generation
+
+  std::unordered_map<BinKey, G4int, BinHash> theBinMap; // (i,j,k) to index
+  std::vector<G4ThreeVector> theBinCenters;	// Centers, by index
 };
 
 #endif	/* G4CMPChargeCloud_hh */
@@ -38,9 +38,16 @@
 // 20200426  G4CMP-196: Change "impact ionization" to "trap ionization"
 // 20200501  G4CMP-196: Change trap-ionization MFP names, "eTrap" -> "DTrap",
 //		"hTrap" -> "ATrap".
+// 20201029  Add number of energy-weighted clusters for secondary positions
+// 20201101  Add per-event track budgets for adaptive downsampling
+// 20201112  Add batch size for staged creation of deposit tracks
 // 20200504  G4CMP-195:  Reduce length of charge-trapping parameter names
 // 20200530  G4CMP-202:  Provide separate master and worker instances
 // 20200614  G4CMP-211:  Add functionality to print settings
+// 20201018  Add scale factor for inline phonon downconversion cascade
+// 20201019  Add flag to combine phonon scattering and downconversion
+// 20201021  Add flag for fast ballistic phonon flights between surfaces
+// 20201022  Add phonon Russian roulette and splitting thresholds
 
 #include "globals.hh"
 #include <iosfwd>
@@ -67,9 +74,15 @@ public:
   static G4int GetVerboseLevel()         { return Instance()->verbose; }
   static G4int GetMaxChargeBounces()	 { return Instance()->ehBounces; }
   static G4int GetMaxPhononBounces()	 { return Instance()->pBounces; }
+  static G4int GetSecondaryClusters()	 { return Instance()->nClusters; }
+  static G4int GetPhononBudget()	 { return Instance()->phononBudget; }
+  static G4int GetChargeBudget()	 { return Instance()->chargeBudget; }
+  static G4int GetTrackBatch()		 { return Instance()->trackBatch; }
   static G4bool UseKVSolver()            { return Instance()->useKVsolver; }
   static G4bool FanoStatisticsEnabled()  { return Instance()->fanoEnabled; }
   static G4bool CreateChargeCloud()      { return Instance()->chargeCloud; }
+  static G4bool CombinePhononBulk()      { return Instance()->phononBulk; }
+  static G4bool UseFastBallistic()       { return Instance()->fastBallistic; }
   static G4double GetSurfaceClearance()  { return Instance()->clearance; }
   static G4double GetMinStepScale()      { return Instance()->stepScale; }
   static G4double GetMinPhononEnergy()   { return Instance()->EminPhonons; }
@@ -78,6 +91,10 @@ public:
   static G4double GetGenPhonons()        { return Instance()->genPhonons; }
   static G4double GetGenCharges()        { return Instance()->genCharges; }
   static G4double GetLukeSampling()      { return Instance()->lukeSample; }
+  static G4double GetCascadeScale()      { return Instance()->cascadeScale; }
+  static G4double GetRouletteEnergy()    { return Instance()->rouletteEnergy; }
+  static G4double GetSplitWeight()       { return Instance()->splitWeight; }
+  static G4double GetSplitDistance()     { return Instance()->splitDistance; }
   static const G4String& GetLatticeDir() { return Instance()->LatticeDir; }
   static const G4String& GetIVRateModel() { return Instance()->IVRateModel; }
   static const G4double& GetETrappingMFP() { return Instance()->eTrapMFP; }
@@ -93,6 +110,10 @@ public:
   static void SetVerboseLevel(G4int value) { Instance()->verbose = value; }
   static void SetMaxChargeBounces(G4int value) { Instance()->ehBounces = value; }
   static void SetMaxPhononBounces(G4int value) { Instance()->pBounces = value; }
+  static void SetSecondaryClusters(G4int value) { Instance()->nClusters = value; }
+  static void SetPhononBudget(G4int value) { Instance()->phononBudget = value; }
+  static void SetChargeBudget(G4int value) { Instance()->chargeBudget = value; }
+  static void SetTrackBatch(G4int value) { Instance()->trackBatch = value; }
   static void SetSurfaceClearance(G4double value) { Instance()->clearance = value; }
   static void SetMinStepScale(G4double value) { Instance()->stepScale = value; }
   static void SetMinPhononEnergy(G4double value) { Instance()->EminPhonons = value; }
@@ -101,10 +122,16 @@ public:
   static void SetGenPhonons(G4double value) { Instance()->genPhonons = value; }
   static void SetGenCharges(G4double value) { Instance()->genCharges = value; }
   static void SetLukeSampling(G4double value) { Instance()->lukeSample = value; }
+  static void SetCascadeScale(G4double value) { Instance()->cascadeScale = value; }
+  static void SetRouletteEnergy(G4double value) { Instance()->rouletteEnergy = value; }
+  static void SetSplitWeight(G4double value) { Instance()->splitWeight = value; }
+  static void SetSplitDistance(G4double value) { Instance()->splitDistance = value; }
   static void UseKVSolver(G4bool value) { Instance()->useKVsolver = value; }
   static void EnableFanoStatistics(G4bool value) { Instance()->fanoEnabled = value; }
   static void SetIVRateModel(G4String value) { Instance()->IVRateModel = value; }
   static void CreateChargeCloud(G4bool value) { Instance()->chargeCloud = value; }
+  static void CombinePhononBulk(G4bool value) { Instance()->phononBulk = value; }
+  static void UseFastBallistic(G4bool value) { Instance()->fastBallistic = value; }
 
   static void SetETrappingMFP(G4double value) { Instance()->eTrapMFP = value; }
   static void SetHTrappingMFP(G4double value) { Instance()->hTrapMFP = value; }
@@ -147,6 +174,10 @@ private:
   G4int fPhysicsModelID; // ID key to get aux. track info.
   G4int ehBounces;	// Maximum e/h reflections ($G4CMP_EH_BOUNCES)
   G4int pBounces;	// Maximum phonon reflections ($G4CMP_PHON_BOUNCES)
+  G4int nClusters;	// Secondary position clusters ($G4CMP_SECONDARY_CLUSTERS)
+  G4int phononBudget;	// Target phonon tracks per event ($G4CMP_PHONON_BUDGET)
+  G4int chargeBudget;	// Target e/h tracks per event ($G4CMP_CHARGE_BUDGET)
+  G4int trackBatch;	// Tracks created at once from deposit ($G4CMP_TRACK_BATCH)
   G4String version;	// Version name string extracted from .g4cmp-version
   G4String LatticeDir;	// Lattice data directory ($G4LATTICEDATA)
   G4String IVRateModel;	// Model for IV rate ($G4CMP_IV_RATE_MODEL)
@@ -162,11 +193,17 @@ private:
   G4double genPhonons;	 // Rate to create primary phonons ($G4CMP_MAKE_PHONONS)
   G4double genCharges;	 // Rate to create primary e/h pairs ($G4CMP_MAKE_CHARGES)
   G4double lukeSample;   // Rate to create Luke phonons ($G4CMP_LUKE_SAMPLE)
+  G4double cascadeScale; // Inline downconversion if MFP*scale < safety ($G4CMP_DOWNCONV_CASCADE)
+  G4double rouletteEnergy; // Roulette phonons below energy*weight ($G4CMP_ROULETTE_ENERGY)
+  G4double splitWeight;	 // Split phonons above weight ($G4CMP_SPLIT_WEIGHT)
+  G4double splitDistance; // Split only within distance of surface ($G4CMP_SPLIT_DISTANCE)
   G4double EminPhonons;	 // Minimum energy to track phonons ($G4CMP_EMIN_PHONONS)
   G4double EminCharges;	 // Minimum energy to track e/h ($G4CMP_EMIN_CHARGES)
   G4bool useKVsolver;	 // Use K-Vg eigensolver ($G4CMP_USE_KVSOLVER)
   G4bool fanoEnabled;	 // Apply Fano statistics to ionization energy deposits ($G4CMP_FANO_ENABLED)
   G4bool chargeCloud;    // Produce e/h pairs around position ($G4CMP_CHARGE_CLOUD) 
+  G4bool phononBulk;     // Single process for scattering, downconversion ($G4CMP_PHONON_BULK)
+  G4bool fastBallistic;  // Phonon reflections computed within one step ($G4CMP_FAST_BALLISTIC)
 
   G4VNIELPartition* nielPartition; // Function class to compute non-ionizing ($G4CMP_NIEL_FUNCTION)
 
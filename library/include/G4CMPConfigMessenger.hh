@@ -38,6 +38,13 @@
 // 20200501  G4CMP-196: Change trap-ionization MFP names, "eTrap" -> "DTrap",
 //		"hTrap" -> "ATrap".
 // 20200614  G4CMP-211:  Add functionality to print settings
+// 20201018  Add command to enable inline downconversion cascade
+// 20201019  Add command to combine phonon scattering and downconversion
+// 20201021  Add command for fast ballistic phonon flights
+// 20201022  Add commands for phonon Russian roulette and splitting
+// 20201029  Add command for energy-weighted secondary clusters
+// 20201101  Add commands for per-event phonon and charge track budgets
+// 20201112  Add command for batch size of staged deposit tracks
 
 #include "G4UImessenger.hh"
 
@@ -66,6 +73,10 @@ private:
   G4UIcmdWithAnInteger* verboseCmd;
   G4UIcmdWithAnInteger* ehBounceCmd;
   G4UIcmdWithAnInteger* pBounceCmd;
+  G4UIcmdWithAnInteger* clusterCmd;
+  G4UIcmdWithAnInteger* phononBudgetCmd;
+  G4UIcmdWithAnInteger* chargeBudgetCmd;
+  G4UIcmdWithAnInteger* trackBatchCmd;
   G4UIcmdWithADoubleAndUnit* clearCmd;
   G4UIcmdWithADoubleAndUnit* minEPhononCmd;
   G4UIcmdWithADoubleAndUnit* minEChargeCmd;
@@ -80,12 +91,18 @@ private:
   G4UIcmdWithADouble* makePhononCmd;
   G4UIcmdWithADouble* makeChargeCmd;
   G4UIcmdWithADouble* lukePhononCmd;
+  G4UIcmdWithADouble* cascadeCmd;
+  G4UIcmdWithADouble* splitWeightCmd;
+  G4UIcmdWithADoubleAndUnit* rouletteECmd;
+  G4UIcmdWithADoubleAndUnit* splitDistCmd;
   G4UIcmdWithAString* dirCmd;
   G4UIcmdWithAString* ivRateModelCmd;
   G4UIcmdWithAString* nielPartitionCmd;
   G4UIcmdWithABool*   kvmapCmd;
   G4UIcmdWithABool*   fanoStatsCmd;
   G4UIcmdWithABool*   ehCloudCmd;
+  G4UIcmdWithABool*   phononBulkCmd;
+  G4UIcmdWithABool*   fastBallisticCmd;
 
 private:
   G4CMPConfigMessenger(const G4CMPConfigMessenger&);	// Copying is forbidden
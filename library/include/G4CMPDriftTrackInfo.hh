@@ -12,32 +12,22 @@
 // $Id$
 //
 // 20161111 Initial commit - R. Agnese
+// 20201028 Use thread-local G4Allocator for memory management
 
 #ifndef G4CMPDriftTrackInfo_hh
 #define G4CMPDriftTrackInfo_hh 1
 
 #include "G4CMPVTrackInfo.hh"
-/*
 #include "G4Allocator.hh"
 
-class G4CMPDriftTrackInfo;
-
-extern G4Allocator<G4CMPDriftTrackInfo> G4CMPDriftTrackInfoAllocator;
-*/
-
 class G4CMPDriftTrackInfo: public G4CMPVTrackInfo {
 public:
   G4CMPDriftTrackInfo() = delete;
   G4CMPDriftTrackInfo(const G4LatticePhysical* lat, G4int valIdx);
 
-/*
-  void *operator new(size_t) noexcept {
-    return static_cast<void*>(G4CMPDriftTrackInfoAllocator.MallocSingle());
-  }
-  void operator delete(void* info) noexcept {
-    G4CMPDriftTrackInfoAllocator.FreeSingle(static_cast<G4CMPDriftTrackInfo*>(info));
-  }
-*/
+  // Memory allocation using G4Allocator<>; implemented below
+  inline void* operator new(size_t);
+  inline void  operator delete(void*);
 
   G4int ValleyIndex() const                                { return valleyIdx; }
   void SetValleyIndex(G4int valIdx);
@@ -48,4 +38,20 @@ private:
   G4int valleyIdx;
 };
 
+
+// Allocator is created on first use in each thread
+
+extern G4ThreadLocal
+G4Allocator<G4CMPDriftTrackInfo>* G4CMPDriftTrackInfoAllocator;
+
+inline void* G4CMPDriftTrackInfo::operator new(size_t) {
+  if (!G4CMPDriftTrackInfoAllocator)
+    G4CMPDriftTrackInfoAllocator = new G4Allocator<G4CMPDriftTrackInfo>;
+  return (void*) G4CMPDriftTrackInfoAllocator->MallocSingle();
+}
+
+inline void G4CMPDriftTrackInfo::operator delete(void* info) {
+  G4CMPDriftTrackInfoAllocator->FreeSingle((G4CMPDriftTrackInfo*) info);
+}
+
 #endif
@@ -4,6 +4,7 @@
 \***********************************************************************/
 
 // 20200510  M. Kelsey -- G4CMP-201: Allocator must be thread-local
+// 20201107  Store particle definition instead of name; group numeric data
 
 #ifndef G4CMPElectrodeHit_h
 #define G4CMPElectrodeHit_h 1
@@ -15,6 +16,7 @@
 
 class G4AttDef;
 class G4AttValue;
+class G4ParticleDefinition;
 
 class G4CMPElectrodeHit : public G4VHit {
 public:
@@ -53,19 +55,24 @@ public:
   void SetTrackID(G4int id) { trackID = id; }
   G4int GetTrackID() const { return trackID; }
 
-  void SetParticleName(G4String name) { particleName = name; }
-  G4String GetParticleName() const { return particleName; }
+  // Particle is stored by pointer, so identity tests need no string compare
+  void SetParticle(const G4ParticleDefinition* pd) { particle = pd; }
+  const G4ParticleDefinition* GetParticle() const { return particle; }
+
+  // Name interface is kept for output; setter looks up particle table
+  void SetParticleName(const G4String& name);
+  const G4String& GetParticleName() const;
 
 private:
+  G4ThreeVector startPos;	// Doubles first, to avoid padding
+  G4ThreeVector finalPos;
   G4double startTime;
   G4double finalTime;
   G4double startE;
   G4double EDep;
   G4double weight;
-  G4ThreeVector startPos;
-  G4ThreeVector finalPos;
+  const G4ParticleDefinition* particle;
   G4int trackID;
-  G4String particleName;
 };
 
 typedef G4THitsCollection<G4CMPElectrodeHit> G4CMPElectrodeHitsCollection;
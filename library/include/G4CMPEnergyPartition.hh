@@ -23,6 +23,13 @@
 // 20200218  Support writing DoPartion() internals to event summary data
 // 20200222  Add control flag to turn off creating summary data
 // 20200805  Add bias across volume to estimate Luke gain downsampling
+// 20201023  Add binomial sampling of surviving particles for downsampling
+// 20201024  Add function to create multiple phonons of given polarization
+// 20201025  Keep downsampling factors locally, pass to secondary tracks
+// 20201031  Add reusable buffers for primaries and secondaries
+// 20201101  Add adjustment of sampling factors to per-event track budget
+// 20201110  Record energy of phonons skipped below tracking threshold
+// 20201112  Stage records beyond one batch in G4CMPPendingTracks
 
 #ifndef G4CMPEnergyPartition_hh
 #define G4CMPEnergyPartition_hh 1
@@ -30,6 +37,7 @@
 #include "globals.hh"
 #include "G4CMPProcessUtils.hh"
 #include "G4ThreeVector.hh"
+#include "G4TouchableHandle.hh"
 #include <vector>
 
 class G4CMPChargeCloud;
@@ -70,6 +78,20 @@ public:
   void UseDownsampling(G4bool value) { applyDownsampling = value; }
   G4bool UseDownsampling() const { return applyDownsampling; }
 
+  // Preset downsampling factors (negative to use G4CMPConfigManager)
+  void SetSampling(G4double phonon, G4double charge, G4double luke);
+  void SetSampling(const G4Track& track);	// From track's parent deposit
+  void ResetSampling() { SetSampling(-1., -1., -1.); }
+
+  G4double GetPhononSampling() const;
+  G4double GetChargeSampling() const;
+  G4double GetLukeSampling() const;
+
+  // Weighted energy of phonons below the tracking threshold, which are
+  // not returned by GetPrimaries() or GetSecondaries(); relative to the
+  // parent track weight for secondaries.  Callers should deposit it.
+  G4double GetSkippedEnergy() const { return skippedEnergy; }
+
   // Placement volume may be used to get material and lattice
   void UseVolume(const G4VPhysicalVolume* volume);
 
@@ -95,7 +117,9 @@ public:
   // Some processes can specify non-ionizing energy directly
   void DoPartition(G4double eIon, G4double eNIEL);
 
-  // Return either primary or secondary particles from partitioning
+  // Return either primary or secondary particles from partitioning.  The
+  // event and particle change versions create at most one batch of tracks
+  // (see G4CMPConfigManager::GetTrackBatch()), and stage the rest.
   void GetPrimaries(std::vector<G4PrimaryParticle*>& primaries) const;
 
   void GetPrimaries(G4Event* event, const G4ThreeVector& pos, G4double time,
@@ -109,6 +133,9 @@ public:
   // Assign energy-dependent sampling factors for phonons and charge carriers
   void ComputeDownsampling(G4double eIon, G4double eNIEL);
 
+  // Reduce sampling factors to fit within remaining per-event track budget
+  void ApplyTrackBudget(G4double eIon, G4double eNIEL);
+
   // Fraction of total energy deposit in material which goes to e/h pairs
   G4double LindhardScalingFactor(G4double energy, G4double Z=0,
 				 G4double A=0) const;
@@ -120,12 +147,29 @@ protected:
   void GenerateCharges(G4double energy);
   void AddChargePair(G4double ePair);
 
+  // Number of particles kept from nTotal with downsampling scale
+  size_t SampleSurvivors(size_t nTotal, G4double scale) const;
+
   void GeneratePhonons(G4double energy);
   void AddPhonon(G4double ePhon);
+  void AddPhonons(G4int mode, G4double ePhon, size_t n);
 
   G4PrimaryVertex* CreateVertex(G4Event* event, const G4ThreeVector& pos,
 				G4double time) const;
 
+  // Create up to nMax particles; return index of first record not used
+  size_t FillPrimaries(std::vector<G4PrimaryParticle*>& primaries,
+		       size_t nMax) const;
+
+  size_t FillSecondaries(std::vector<G4Track*>& secondaries,
+			 G4double trkWeight, size_t nMax) const;
+
+  // Pass records from "first" on to G4CMPPendingTracks (no parent for
+  // primaries), to be tracked after those already created
+  void StageRecords(size_t first, const G4TouchableHandle& touch,
+		    const G4ThreeVector& pos, G4double time,
+		    G4double trkWeight, const G4Track* parent) const;
+
   // Create buffer save DoPartition() computations
   G4CMPPartitionData* CreateSummary();
 
@@ -138,6 +182,9 @@ protected:
   G4double holeFraction;	// Energy from e/h pair taken by hole (50%)
   G4int nParticlesMinimum;	// Minimum production when downsampling
   G4bool applyDownsampling;	// Flag whether to do downsampling calcualtions
+  G4double phononSampling;	// Downsampling factors for current deposit;
+  G4double chargeSampling;	// never written back to G4CMPConfigManager
+  G4double lukeSampling;
 
   G4CMPChargeCloud* cloud;	// Distribute e/h around central position
   size_t nCharges;		// Actual (downsampled) number of e+h for cloud
@@ -162,6 +209,12 @@ protected:
   };
     
   std::vector<Data> particles;	// Combined phonons and charge carriers
+
+  // Output buffers reused between calls; always empty on return
+  mutable std::vector<G4PrimaryParticle*> primaryBuffer;
+  mutable std::vector<G4Track*> secondaryBuffer;
+
+  mutable G4double skippedEnergy;	// Phonons below tracking threshold
 };
 
 #endif	/* G4CMPEnergyPartition_hh */
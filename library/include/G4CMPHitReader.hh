@@ -0,0 +1,72 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/include/G4CMPHitReader.hh
+/// \brief Definition of the G4CMPHitReader class.  Reads back event blocks
+///   written by G4CMPHitWriter, one event at a time, and can export them
+///   as CSV text matching the examples' hit output.
+///
+// $Id$
+//
+// 20201105  New class for binary hit input
+// 20201106  Move block definition to G4CMPHitWriter.hh, for merging
+
+#ifndef G4CMPHitReader_hh
+#define G4CMPHitReader_hh 1
+
+#include "globals.hh"
+#include "G4CMPHitWriter.hh"
+#include <fstream>
+#include <iosfwd>
+#include <stdint.h>
+#include <vector>
+
+
+class G4CMPHitReader {
+public:
+  typedef G4CMPHitBlock Block;
+
+public:
+  explicit G4CMPHitReader(const G4String& name="");
+  virtual ~G4CMPHitReader() {;}
+
+  // Open file and check header; returns false if not a hit file
+  G4bool Open(const G4String& name);
+  G4bool Good() const { return input.good(); }
+  const G4String& GetFileName() const { return fileName; }
+
+  // Fill next event from file; returns false at end of file
+  G4bool ReadBlock(Block& block);
+
+  // Particle names seen so far, indexed by code
+  const G4String& ParticleName(uint16_t code) const;
+  const std::vector<G4String>& ParticleNames() const { return particleNames; }
+
+  // Write block as CSV lines, and column titles for header line
+  void WriteCSV(std::ostream& os, const Block& block) const;
+  static void WriteCSVHeader(std::ostream& os);
+
+protected:
+  template <class T> G4bool Read(T& value) {
+    return (G4bool)input.read(reinterpret_cast<char*>(&value), sizeof(T));
+  }
+
+  template <class T> G4bool ReadColumn(std::vector<T>& column) {
+    if (column.empty()) return true;
+    return (G4bool)input.read(reinterpret_cast<char*>(column.data()),
+			      column.size()*sizeof(T));
+  }
+
+private:
+  G4String fileName;
+  std::ifstream input;
+  std::vector<G4String> particleNames;
+
+  // Copying is forbidden
+  G4CMPHitReader(const G4CMPHitReader&);
+  G4CMPHitReader& operator=(const G4CMPHitReader&);
+};
+
+#endif	/* G4CMPHitReader_hh */
@@ -0,0 +1,159 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/include/G4CMPHitWriter.hh
+/// \brief Definition of the G4CMPHitWriter class.  Buffered output of
+///   G4CMPElectrodeHitsCollection in a compact binary columnar format,
+///   for use in place of one formatted text line per hit.
+///
+///   Each writer owns its file and buffer, and is meant to be used from
+///   a single thread (e.g., by a worker-thread sensitive detector).
+///
+///   File layout, all values in host byte order:
+///	char[8]  "G4CMPHIT"
+///	uint32   format version
+///	uint32   0x01020304 (byte order check)
+///   followed by one block per event:
+///	int32    run ID, event ID
+///	uint32   number of hits, number of new particle names
+///	{uint16 code, uint16 length, char[length]} for each new name
+///	int32    track ID		[nHits]
+///	uint16   particle code	[nHits]
+///	float64  one column each	[nHits], see HitColumn
+///
+///   Particle codes are assigned in order of first appearance in a file.
+///
+///   In multithreaded jobs, each worker writes its own file (see
+///   ThreadFileName()), and the master uses Merge() at end of run to
+///   combine them in (run, event) order.
+///
+// $Id$
+//
+// 20201105  New class for binary hit output
+// 20201106  Add per-thread file names, block copying, and ordered merge
+// 20201107  Look up hit particle codes by definition pointer
+
+#ifndef G4CMPHitWriter_hh
+#define G4CMPHitWriter_hh 1
+
+#include "globals.hh"
+#include "G4CMPElectrodeHit.hh"
+#include <fstream>
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+class G4ParticleDefinition;
+struct G4CMPHitBlock;
+
+
+class G4CMPHitWriter {
+public:
+  // Floating point columns, stored in CSV units (eV, m, ns)
+  enum HitColumn { StartEnergy, StartX, StartY, StartZ, StartTime,
+		   EnergyDeposit, Weight, FinalX, FinalY, FinalZ, FinalTime,
+		   NumColumns };
+
+  static const char Magic[8];
+  static const uint32_t Version;
+  static const uint32_t ByteOrder;
+
+  // Titles of all columns, including run, event, track and particle
+  static const std::vector<G4String>& ColumnTitles();
+
+  // Files ending in ".bin" are expected to be in this format
+  static G4bool IsBinaryName(const G4String& name);
+
+  // Insert worker thread ID before extension ("hits.bin" -> "hits_t3.bin");
+  // name is returned unchanged for master or sequential (ID < 0)
+  static G4String ThreadFileName(const G4String& name);
+  static G4String ThreadFileName(const G4String& name, G4int threadID);
+
+public:
+  explicit G4CMPHitWriter(const G4String& name="", size_t flushBytes=1<<20);
+  virtual ~G4CMPHitWriter();
+
+  // Start new file (overwriting existing), closing any current file
+  void Open(const G4String& name);
+  void Close();
+
+  G4bool IsOpen() const { return output.is_open(); }
+  G4bool Good() const { return output.good(); }
+  const G4String& GetFileName() const { return fileName; }
+
+  // Buffer is written to file when it exceeds this size (bytes)
+  void SetFlushSize(size_t bytes) { flushSize = bytes; }
+  size_t GetFlushSize() const { return flushSize; }
+
+  // Append one event to the buffer, writing out if full
+  void Write(G4int runID, G4int eventID,
+	     const G4CMPElectrodeHitsCollection* hits);
+
+  // Append event read from another file, with that file's particle names
+  void Write(const G4CMPHitBlock& block, const std::vector<G4String>& names);
+
+  // Append all events from input files, ordered by (run, event); each
+  // input must itself be in order, as written by one thread
+  void Merge(const std::vector<G4String>& inputs);
+
+  void Flush();
+
+protected:
+  uint16_t ParticleCode(const G4String& name);	// Assigns new codes
+  uint16_t ParticleCode(const G4ParticleDefinition* pd);
+
+  // Copy value into buffer as raw bytes
+  template <class T> void Append(const T& value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes+sizeof(T));
+  }
+
+  void AppendColumn(const std::vector<G4CMPElectrodeHit*>& hits,
+		    HitColumn column);
+
+  // Block header and new particle names; codes must already be assigned
+  void AppendHeader(G4int runID, G4int eventID, size_t nHits,
+		    size_t firstNewName);
+
+private:
+  G4String fileName;
+  std::ofstream output;
+  size_t flushSize;
+
+  std::vector<char> buffer;			// Serialized blocks
+  std::map<G4String, uint16_t> particleCodes;	// Interned for this file
+  std::vector<G4String> particleNames;		// Indexed by code
+  std::map<const G4ParticleDefinition*, uint16_t> definitionCodes;
+  std::vector<uint16_t> hitCodes;		// Codes for current event
+  std::vector<uint16_t> inputCodes;		// Codes for merged file names
+
+  // Copying is forbidden
+  G4CMPHitWriter(const G4CMPHitWriter&);
+  G4CMPHitWriter& operator=(const G4CMPHitWriter&);
+};
+
+
+
+// Contents of one event block, stored by column
+
+struct G4CMPHitBlock {
+  G4int runID;
+  G4int eventID;
+  size_t nHits;
+  std::vector<G4int> trackID;
+  std::vector<uint16_t> particle;
+  std::vector<G4double> column[G4CMPHitWriter::NumColumns];
+
+  G4CMPHitBlock() : runID(-1), eventID(-1), nHits(0) {;}
+  void Resize(size_t n);
+
+  // Ordering used to merge files from different threads
+  G4bool Precedes(const G4CMPHitBlock& other) const {
+    return (runID < other.runID ||
+	    (runID == other.runID && eventID < other.eventID));
+  }
+};
+
+#endif	/* G4CMPHitWriter_hh */
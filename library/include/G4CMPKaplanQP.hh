@@ -19,6 +19,12 @@
 //		mutation of E argument in PhononEnergyRand().
 // 20200701  G4CMP-217: New function to handle QP energy absorption below
 //		minimum for QP -> phonon -> new QP pair chain (3*bandgap).
+// 20201102  Add bounded PDFs of substituted variables for exact sampling.
+//		Add accessor for bandgap energy.
+// 20201103  Add precomputed film constants; KaplanPhononQP() caches one
+//		instance per properties table.
+// 20201104  Reuse cascade buffers between calls; add summary-only
+//		AbsorbPhonon() with histogram of reflected energies.
 
 #ifndef G4CMPKaplanQP_hh
 #define G4CMPKaplanQP_hh 1
@@ -51,12 +57,33 @@ public:
 
   // Configure thin film (QET, metalization, etc.) for phonon absorption
   void SetFilmProperties(G4MaterialPropertiesTable* prop);
+  G4MaterialPropertiesTable* GetFilmProperties() const {
+    return filmProperties;
+  }
+
+  G4double GetGapEnergy() const { return gapEnergy; }
 
   // Do absorption on sensor/metalization film
   // Returns absorbed energy, fills list of re-emitted phonons
   G4double AbsorbPhonon(G4double energy,
 			std::vector<G4double>& reflectedEnergies) const;
 
+  // Accumulated results, for when re-emitted phonons are not tracked
+  struct Summary {
+    Summary(G4double maxEnergy=0., G4int nBins=0);
+    void Clear();
+    void Fill(G4double reflectedE);		// Last bin includes overflow
+
+    G4double absorbed;			// Total energy deposited in film
+    G4double reflected;			// Total energy re-emitted
+    G4int nReflected;			// Number of re-emitted phonons
+    G4double binWidth;			// Reflected energy histogram
+    std::vector<G4int> histogram;
+  };
+
+  // Returns absorbed energy, adds absorbed and re-emitted to summary
+  G4double AbsorbPhonon(G4double energy, Summary& summary) const;
+
 protected:
   // Compute the probability of a phonon reentering the crystal without breaking
   // any Cooper pairs.
@@ -91,11 +118,18 @@ protected:
   // Compute quasiparticle energy distribution from broken Cooper pair.
   G4double QPEnergyRand(G4double Energy) const;
   G4double QPEnergyPDF(G4double E, G4double x) const;
+
+  // QP PDF for x = c + a*sin(theta), c = E/2, a = c-gap, b = c+gap
+  G4double QPThetaPDF(G4double c, G4double a, G4double b,
+		      G4double theta) const;
   
   // Compute phonon energy distribution from quasiparticle in superconductor.
   G4double PhononEnergyRand(G4double Energy) const;
   G4double PhononEnergyPDF(G4double E, G4double x) const;
 
+  // Phonon PDF for y = sqrt(x*x - gap*gap), x = final QP energy
+  G4double PhononYPDF(G4double E, G4double x) const;
+
   // Encapsulate below-bandgap logic
   G4bool IsSubgap(G4double energy) const { return energy < 2.*gapEnergy; }
 
@@ -110,6 +144,23 @@ private:
   G4double phononLifetime;	// Lifetime of phonons in film at 2*delta
   G4double phononLifetimeSlope;	// Energy dependence of phonon lifetime
   G4double vSound;		// Speed of sound in film
+
+  G4double gapSquared;		// Precomputed from film quantities above
+  G4double lowQPEnergy;		// lowQPLimit*gapEnergy
+  G4double escapeScale;		// 2*thickness/mfp at 2*delta
+
+  // Cascade buffers reused between calls; capacity is kept
+  mutable std::vector<G4double> qpBuffer;
+  mutable std::vector<G4double> phonBuffer;
+  mutable std::vector<G4double> scratchBuffer;	// For replacing either list
+  mutable std::vector<G4double> reflectBuffer;	// For summary-only absorption
 };
 
+// Summary-only version of KaplanPhononQP, for use without reflected tracks
+namespace G4CMP {
+  G4double KaplanPhononQP(G4double energy,
+			  G4MaterialPropertiesTable* prop,
+			  G4CMPKaplanQP::Summary& summary);
+}
+
 #endif	/* G4CMPKaplanQP_hh */
@@ -19,6 +19,8 @@
 // 20190509  Migrate to 2D/3D mesh base class, handle dimensional reduction
 // 20190612  Mesh pointer ctor should set axes to kUndefined
 // 20200520  For thread-safety, move reusable "pos" buffer here
+// 20201109  Add batched GetPotential() for points along a path
+// 20201111  Correct description of batched GetPotential()
 
 #ifndef G4CMPMeshElectricField_h 
 #define G4CMPMeshElectricField_h 1
@@ -71,6 +73,11 @@ public:
   // Call through to interpolator (e.g., for use with FET code)
   virtual G4double GetPotential(const G4double Point[3]) const;
 
+  // Evaluate sequence of points (e.g., steps along a track) in one call,
+  // without warnings for points outside the mesh
+  void GetPotential(const std::vector<G4ThreeVector>& points,
+		    std::vector<G4double>& values) const;
+
   // Get access to mesh interpolator for client access or copying
   const G4CMPVMeshInterpolator* GetInterpolator() const { return Interp; }
 
@@ -14,6 +14,8 @@
 //
 // 20200217  Michael Kelsey (TAMU) <kelsey@slac.stanford.edu>
 // 20200316  Add hit position; improve energy quantity calculations.
+// 20201101  Record track weights and Luke sampling used for deposit
+// 20201110  Record energy of phonons below tracking threshold
 
 #ifndef G4CMPPartitionData_hh
 #define G4CMPPartitionData_hh 1
@@ -48,6 +50,10 @@ public:		// Simple container, provide direct access to information
   G4double phononEnergy;	// Energy assigned for primary phonons
   G4double phononGenerated;	// Weighted sum of generated phonons
   G4int numberOfPhonons;	// Number of phonons created (downsampled)
+  G4double chargeWeight;	// Weight of each e/h track (true/generated)
+  G4double phononWeight;	// Weight of each phonon track (true/generated)
+  G4double lukeSampling;	// Luke phonon sampling passed to e/h tracks
+  G4double phononSkipped;	// Weighted energy of untracked low-E phonons
 
 public:
   G4CMPPartitionData(const G4CMPPartitionData&) = default;
@@ -10,6 +10,8 @@
 // $Id$
 //
 // 20200219  Michael Kelsey (TAMU) <kelsey@slac.stanford.edu>
+// 20201101  Count tracks created in current event, for track budgets
+// 20201112  Identify event by run and event count, for repeated runs
 
 #ifndef G4CMPPartitionSummary_hh
 #define G4CMPPartitionSummary_hh 1
@@ -46,11 +48,28 @@ public:
   // Erase all entries in table
   static void Clear() { Instance()->clear(); }
 
+  // Count phonon and e/h tracks created in the current event
+  static void CountPhonons(G4double n) { Instance()->update()->nPhonons += n; }
+  static void CountCharges(G4double n) { Instance()->update()->nCharges += n; }
+
+  static G4double PhononsThisEvent() { return Instance()->update()->nPhonons; }
+  static G4double ChargesThisEvent() { return Instance()->update()->nCharges; }
+
+  // Production probability to keep phonon tracks near budget (1 if under)
+  static G4double PhononBudgetScale();
+
 private:
-  G4CMPPartitionSummary() {;}
+  G4CMPPartitionSummary()
+    : runID(-1), eventID(-1), nPhonons(0.), nCharges(0.) {;}
   void clear();				// Deletes existing table entries
+  G4CMPPartitionSummary* update();	// Resets counters for new event
 
   G4CMPPartitionVector summary;		// Filled by client code
+
+  G4int runID;				// Run and event (count in run) for
+  G4int eventID;			//   which tracks are counted
+  G4double nPhonons;
+  G4double nCharges;
 };
 
 #endif	/* G4CMPPartitionSummary_hh */
@@ -0,0 +1,122 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/include/G4CMPPendingTracks.hh
+/// \brief Singleton buffer of compact particle records from energy
+///   deposits, which G4CMPEnergyPartition does not make into tracks
+///   immediately.  G4CMPStackingAction::NewStage() turns them into
+///   G4Tracks a batch at a time, each time the stacks have been emptied.
+///
+///   Staged tracks are pushed directly onto the stack, so G4EventManager
+///   does not number them.  They are numbered down from the largest track
+///   ID instead, which cannot collide with the IDs Geant4 assigns.
+///
+// $Id$
+//
+// 20201112  New class for staged creation of tracks from large deposits
+
+#ifndef G4CMPPendingTracks_hh
+#define G4CMPPendingTracks_hh 1
+
+#include "globals.hh"
+#include "G4ThreadLocalSingleton.hh"
+#include "G4ThreeVector.hh"
+#include "G4TouchableHandle.hh"
+#include "G4TrackVector.hh"
+#include <vector>
+
+class G4ParticleDefinition;
+class G4Track;
+class G4VProcess;
+
+
+class G4CMPPendingTracks {
+  friend class G4ThreadLocalSingleton<G4CMPPendingTracks>;
+
+public:
+  static G4CMPPendingTracks* Instance();		// Singleton object
+  virtual ~G4CMPPendingTracks() {;}
+
+  // Tracks are staged if a non-zero batch size is configured, and if
+  // G4CMPStackingAction is available to create them
+  static G4bool Enabled();
+
+  // Start a new deposit; particles added after this share its volume,
+  // time, weights, sampling factors and parentage
+  static void NewDeposit(const G4TouchableHandle& touch,
+			 const G4ThreeVector& pos, G4double time,
+			 G4double phononWeight, G4double chargeWeight,
+			 const G4double samples[3], G4int parentID=0,
+			 const G4VProcess* creator=0) {
+    Instance()->newDeposit(touch, pos, time, phononWeight, chargeWeight,
+			   samples, parentID, creator);
+  }
+
+  // Add particle to current deposit, at given (global) position
+  static void Add(G4ParticleDefinition* pd, const G4ThreeVector& dir,
+		  G4double ekin, const G4ThreeVector& pos) {
+    Instance()->add(pd, dir, ekin, pos);
+  }
+
+  // Number of particles not yet made into tracks
+  static size_t Entries() { return Instance()->entries(); }
+
+  // Create up to nMax tracks from the oldest records, appended to list
+  static size_t CreateTracks(G4TrackVector& tracks, size_t nMax) {
+    return Instance()->createTracks(tracks, nMax);
+  }
+
+  // Discard all records (e.g., if event was aborted)
+  static void Clear() { Instance()->clear(); }
+
+private:
+  G4CMPPendingTracks()
+    : nextRecord(0), nextTrackID(0), runID(-1), eventID(-1) {;}
+
+  void newDeposit(const G4TouchableHandle& touch, const G4ThreeVector& pos,
+		  G4double time, G4double phononWeight, G4double chargeWeight,
+		  const G4double samples[3], G4int parentID,
+		  const G4VProcess* creator);
+  void add(G4ParticleDefinition* pd, const G4ThreeVector& dir,
+	   G4double ekin, const G4ThreeVector& pos);
+  size_t entries() const { return records.size() - nextRecord; }
+  size_t createTracks(G4TrackVector& tracks, size_t nMax);
+  void clear();
+
+  void update();			// Discard records left from old event
+
+  // Parameters shared by all particles from one energy deposit
+  struct Deposit {
+    G4TouchableHandle touch;		// Volume for lattice and clearance
+    G4ThreeVector position;		// Central position of deposit
+    G4double time;
+    G4double weight[2];			// Phonons, charge carriers
+    G4double samples[3];		// Phonon, charge, Luke downsampling
+    G4int parentID;			// Zero for primaries
+    const G4VProcess* creator;
+  };
+
+  struct Record {
+    G4ParticleDefinition* pd;
+    G4ThreeVector dir;
+    G4ThreeVector pos;
+    G4double ekin;
+    size_t deposit;			// Index into deposit list
+
+    Record(G4ParticleDefinition* part, const G4ThreeVector& d,
+	   const G4ThreeVector& p, G4double E, size_t idep)
+      : pd(part), dir(d), pos(p), ekin(E), deposit(idep) {;}
+  };
+
+  std::vector<Deposit> deposits;
+  std::vector<Record> records;
+  size_t nextRecord;			// First record not yet made into track
+
+  G4int nextTrackID;			// Counts down from largest track ID
+  G4int runID;				// Run and event (count in run) for
+  G4int eventID;			//   which records were added
+};
+
+#endif	/* G4CMPPendingTracks_hh */
@@ -10,6 +10,8 @@
 //
 // 20160903  Add inheritance from G4CMPBoundaryUtils, remove redundant functions
 // 20160906  Follow constness of G4CMPBoundaryUtils
+// 20201021  Add fast ballistic mode, following reflections within one step
+// 20201112  Add GetBulkRate() from registered processes, for fast flights
 
 #ifndef G4CMPPhononBoundaryProcess_h
 #define G4CMPPhononBoundaryProcess_h 1
@@ -41,6 +43,22 @@ protected:
   virtual void DoReflection(const G4Track& aTrack, const G4Step& aStep,
 			    G4ParticleChange& aParticleChange);
 
+  // Specular or diffuse reflection; returns false if no inward direction
+  G4bool ReflectWaveVector(G4int mode, const G4ThreeVector& waveVector,
+			   const G4ThreeVector& surfNorm,
+			   G4ThreeVector& reflectedKDir) const;
+
+  // Fast ballistic mode:  For simple solids, follow the phonon from the
+  // reflection point across the crystal and through further reflections,
+  // until it is absorbed, reaches a different surface, or would interact
+  virtual G4bool UseFastBallistic(const G4Step& aStep) const;
+  virtual void DoFastFlights(const G4Track& aTrack, const G4Step& aStep,
+			     const G4ThreeVector& surfacePoint,
+			     G4ParticleChange& aParticleChange);
+
+  // Total rate of phonon bulk processes registered for track's particle
+  G4double GetBulkRate(const G4Track& aTrack) const;
+
 private:
   // hide assignment operator as private
   G4CMPPhononBoundaryProcess(G4CMPPhononBoundaryProcess&);
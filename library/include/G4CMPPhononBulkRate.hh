@@ -0,0 +1,44 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/include/G4CMPPhononBulkRate.hh
+/// \brief Compute combined rate for phonon isotope scattering and
+///	   anharmonic decay (downconversion).  The individual rates from
+///	   the most recent call are kept for use in selecting the process.
+//
+// $Id$
+//
+// 20201019  New rate model for G4PhononBulkInteraction
+// 20201112  Add rate for energy and polarization, for use without tracks
+
+#ifndef G4CMPPhononBulkRate_hh
+#define G4CMPPhononBulkRate_hh 1
+
+#include "G4CMPVScatteringRate.hh"
+
+
+class G4CMPPhononBulkRate : public G4CMPVScatteringRate {
+public:
+  G4CMPPhononBulkRate()
+    : G4CMPVScatteringRate("PhononBulk"), scatRate(0.), downRate(0.) {;}
+  virtual ~G4CMPPhononBulkRate() {;}
+
+  // Sum of isotope scattering and downconversion rates
+  virtual G4double Rate(const G4Track& aTrack) const;
+
+  // Same sum for phonon of given energy and polarization in current
+  // lattice, for phonons which are not (yet) tracks
+  G4double Rate(G4double energy, G4int mode) const;
+
+  // Individual rates computed in most recent call to Rate()
+  G4double GetScatteringRate() const     { return scatRate; }
+  G4double GetDownconversionRate() const { return downRate; }
+
+private:
+  mutable G4double scatRate;	// Cache values for process selection
+  mutable G4double downRate;
+};
+
+#endif	/* G4CMPPhononBulkRate_hh */
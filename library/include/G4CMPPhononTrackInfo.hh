@@ -13,18 +13,19 @@
 //
 // 20161111 Initial commit - R. Agnese
 // 20170728 M. Kelsey -- Replace "k" function args with "theK" (-Wshadow)
+// 20201020  Cache group velocity, recomputed only when wavevector changes
+// 20201028  Use thread-local G4Allocator for memory management
+// 20201112  Wavevector and cached velocity are global; pass touchable
 
 #ifndef G4CMPPhononTrackInfo_hh
 #define G4CMPPhononTrackInfo_hh 1
 
 #include "G4CMPVTrackInfo.hh"
+#include "G4AffineTransform.hh"
+#include "G4Allocator.hh"
 #include "G4ThreeVector.hh"
 
-/* NOTE: Avoiding use of G4Allocator for performance reasons
-#include "G4Allocator.hh"
-class G4CMPPhononTrackInfo;
-extern G4Allocator<G4CMPPhononTrackInfo> G4CMPPhononTrackInfoAllocator;
-*/
+class G4VTouchable;
 
 
 class G4CMPPhononTrackInfo : public G4CMPVTrackInfo {
@@ -32,25 +33,61 @@ public:
   G4CMPPhononTrackInfo() = delete;
   G4CMPPhononTrackInfo(const G4LatticePhysical* lat, G4ThreeVector k);
 
-/* NOTE: Avoiding use of G4Allocator for performance reasons
-  void *operator new(size_t) noexcept {
-    return static_cast<void*>(G4CMPPhononTrackInfoAllocator.MallocSingle());
-  }
-
-  void operator delete(void* info) noexcept {
-    G4CMPPhononTrackInfoAllocator.FreeSingle(static_cast<G4CMPPhononTrackInfo*>(info));
-  }
-*/
+  // Memory allocation using G4Allocator<>; implemented below
+  inline void* operator new(size_t);
+  inline void  operator delete(void*);
 
-  void SetK(G4ThreeVector theK)          { waveVec = theK; }
-  void SetWaveVector(G4ThreeVector theK) { waveVec = theK; }
+  void SetK(G4ThreeVector theK)          { SetWaveVector(theK); }
+  void SetWaveVector(G4ThreeVector theK) { waveVec = theK; velMode = -1; }
   G4ThreeVector k() const                { return waveVec; }
   G4ThreeVector WaveVector() const       { return waveVec; }
 
+  // Wavevector is stored in the global frame.  Group velocity (also
+  // global) is computed via lattice's MapKtoV() in the frame of the
+  // touchable's solid; a null touchable is treated as an unrotated volume.
+  // Values are cached until wavevector, polarization, lattice or volume
+  // placement change.  If lattice not specified, the track's own lattice
+  // will be used.
+  const G4ThreeVector& VelocityDir(G4int mode, const G4VTouchable* touch,
+				   const G4LatticePhysical* lat=0) const {
+    FillVelocity(mode, touch, lat); return velDir;
+  }
+
+  G4double GroupSpeed(G4int mode, const G4VTouchable* touch,
+		      const G4LatticePhysical* lat=0) const {
+    FillVelocity(mode, touch, lat); return velSpeed;
+  }
+
   virtual void Print() const override;
 
+private:
+  void FillVelocity(G4int mode, const G4VTouchable* touch,
+		    const G4LatticePhysical* lat) const;
+
 private:
   G4ThreeVector waveVec;
+
+  mutable G4int velMode;		// Polarization used for velocity cache
+  mutable const G4LatticePhysical* velLattice;
+  mutable G4AffineTransform velToLocal;	// Placement used for velocity
+  mutable G4ThreeVector velDir;		// Unit vector along group velocity
+  mutable G4double velSpeed;		// Magnitude of group velocity
 };
 
+
+// Allocator is created on first use in each thread
+
+extern G4ThreadLocal
+G4Allocator<G4CMPPhononTrackInfo>* G4CMPPhononTrackInfoAllocator;
+
+inline void* G4CMPPhononTrackInfo::operator new(size_t) {
+  if (!G4CMPPhononTrackInfoAllocator)
+    G4CMPPhononTrackInfoAllocator = new G4Allocator<G4CMPPhononTrackInfo>;
+  return (void*) G4CMPPhononTrackInfoAllocator->MallocSingle();
+}
+
+inline void G4CMPPhononTrackInfo::operator delete(void* info) {
+  G4CMPPhononTrackInfoAllocator->FreeSingle((G4CMPPhononTrackInfo*) info);
+}
+
 #endif
@@ -0,0 +1,58 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/include/G4CMPPhononWeightControl.hh
+/// \brief Definition of the G4CMPPhononWeightControl process, to apply
+///	   Russian roulette to phonons with small energy times weight, and
+///	   to split high-weight phonons approaching the crystal surfaces,
+///	   where the sensors are located.  Thresholds are set in
+///	   G4CMPConfigManager; the process does nothing if they are zero.
+//
+// $Id$
+//
+// 20201022  New process for phonon Russian roulette and splitting
+// 20201112  Apply roulette and splitting on boundary steps as well
+
+#ifndef G4CMPPhononWeightControl_hh
+#define G4CMPPhononWeightControl_hh 1
+
+#include "G4VPhononProcess.hh"
+
+class G4Step;
+class G4Track;
+class G4VParticleChange;
+
+
+class G4CMPPhononWeightControl : public G4VPhononProcess {
+public:
+  G4CMPPhononWeightControl(const G4String& name="PhononWeight");
+  virtual ~G4CMPPhononWeightControl() {;}
+
+  virtual G4double
+  PostStepGetPhysicalInteractionLength(const G4Track&, G4double,
+				       G4ForceCondition*);
+
+  virtual G4VParticleChange* PostStepDoIt(const G4Track&, const G4Step&);
+
+protected:
+  G4bool RouletteEnabled() const;
+  G4bool SplittingEnabled() const;
+
+  // Kill track, or increase its weight; returns false if track is killed
+  G4bool ApplyRoulette(const G4Track& track, G4double& weight);
+
+  // Replace track with equal copies if near (or reflected from) the
+  // surface, reducing weight
+  void ApplySplitting(const G4Track& track, const G4Step& step,
+		      G4double& weight);
+
+  virtual G4double GetMeanFreePath(const G4Track&,G4double,G4ForceCondition*);
+
+private:
+  G4CMPPhononWeightControl(const G4CMPPhononWeightControl&);	// Copying is forbidden
+  G4CMPPhononWeightControl& operator=(const G4CMPPhononWeightControl&);
+};
+
+#endif	/* G4CMPPhononWeightControl_hh */
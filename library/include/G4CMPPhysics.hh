@@ -9,12 +9,16 @@
 // Usage:  [physics-list]->AddPhysics(new G4CMPPhysics);
 //
 // 20150309  M. Kelsey -- Add function to find and wrap *Ionisation processes
+// 20201019  Add function to register combined or separate phonon processes
 
 #ifndef G4CMPPhysics_hh
 #define G4CMPPhysics_hh 1
 
 #include "G4VPhysicsConstructor.hh"
 
+class G4ParticleDefinition;
+class G4VProcess;
+
 
 class G4CMPPhysics : public G4VPhysicsConstructor {
 public:
@@ -28,6 +32,10 @@ public:
 protected:
   void AddSecondaryProduction();	// All charged particles make e/h, phn
 
+  // Null pointers are skipped, so either set of processes may be used
+  void RegisterPhononBulk(G4VProcess* scat, G4VProcess* down,
+			  G4VProcess* bulk, G4ParticleDefinition* particle);
+
 private:
   G4CMPPhysics(const G4CMPPhysics& rhs);		// Copying is forbidden
   G4CMPPhysics& operator=(const G4CMPPhysics& rhs);
@@ -0,0 +1,62 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/include/G4CMPPrimaryInfo.hh
+/// \brief Definition of the G4CMPPrimaryInfo class.  Attached to primary
+///   particles created by G4CMPEnergyPartition::GetPrimaries(), to carry
+///   the deposit's downsampling factors to the track information, the
+///   same way GetSecondaries() sets them directly on secondary tracks.
+///   G4CMPStackingAction copies the factors when the track is created.
+///
+// $Id$
+//
+// 20201111  New class to carry deposit sampling factors on primaries
+
+#ifndef G4CMPPrimaryInfo_hh
+#define G4CMPPrimaryInfo_hh 1
+
+#include "G4Types.hh"
+#include "G4Allocator.hh"
+#include "G4VUserPrimaryParticleInformation.hh"
+
+
+class G4CMPPrimaryInfo : public G4VUserPrimaryParticleInformation {
+public:
+  G4CMPPrimaryInfo(G4double phonon, G4double charge, G4double luke)
+    : phononSample(phonon), chargeSample(charge), lukeSample(luke) {;}
+  virtual ~G4CMPPrimaryInfo() {;}
+
+  // One per primary particle; use G4Allocator<> to avoid heap traffic
+  inline void* operator new(size_t);
+  inline void  operator delete(void*);
+
+  G4double PhononSampling() const { return phononSample; }
+  G4double ChargeSampling() const { return chargeSample; }
+  G4double LukeSampling() const   { return lukeSample; }
+
+  virtual void Print() const;
+
+private:
+  G4double phononSample;	// Sampling of phonons from energy deposit
+  G4double chargeSample;	// Sampling of charges from energy deposit
+  G4double lukeSample;		// Sampling of Luke phonon emission
+};
+
+
+// Data and memory management
+
+extern G4ThreadLocal G4Allocator<G4CMPPrimaryInfo>* G4CMPPrimaryInfo_Allocator;
+
+inline void* G4CMPPrimaryInfo::operator new(size_t) {
+  if (!G4CMPPrimaryInfo_Allocator)
+    G4CMPPrimaryInfo_Allocator = new G4Allocator<G4CMPPrimaryInfo>;
+  return (void*) G4CMPPrimaryInfo_Allocator->MallocSingle();
+}
+
+inline void G4CMPPrimaryInfo::operator delete(void* info) {
+  G4CMPPrimaryInfo_Allocator->FreeSingle((G4CMPPrimaryInfo*) info);
+}
+
+#endif	/* G4CMPPrimaryInfo_hh */
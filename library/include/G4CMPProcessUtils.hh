@@ -33,6 +33,7 @@
 // 20170603  Drop deprecated functions; don't deprecate transforms.
 // 20170620  Drop local caching of transforms; call through to G4CMPUtils.
 // 20170806  Move ChargeCarrierTimeStep() here from DriftProcess.
+// 20201020  Add phonon group velocity accessors using track info cache.
 
 #ifndef G4CMPProcessUtils_hh
 #define G4CMPProcessUtils_hh 1
@@ -196,6 +197,19 @@ public:
   // Values passed may be zero to suppress particular states
   G4int ChoosePhononPolarization() const;		// Use DOS values from lattice
 
+  // Phonon group velocity (local frame) in current lattice; values are
+  // cached in track info (global frame), and only recomputed when
+  // wavevector changes
+  G4ThreeVector GetLocalPhononVelocityDir(const G4Track& track) const;
+  G4ThreeVector GetLocalPhononVelocityDir(const G4Track* track) const {
+    return GetLocalPhononVelocityDir(*track);
+  }
+
+  G4double GetPhononGroupSpeed(const G4Track& track) const;
+  G4double GetPhononGroupSpeed(const G4Track* track) const {
+    return GetPhononGroupSpeed(*track);
+  }
+
   // Map charge carrier momentum to valley index
   G4int GetValleyIndex(const G4Track& track) const;
   inline G4int GetValleyIndex(const G4Track* track) const {
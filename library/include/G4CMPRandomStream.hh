@@ -0,0 +1,103 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/include/G4CMPRandomStream.hh
+/// \brief Definition of the G4CMPRandomStream counter-based random engine.
+///   Per-thread Philox-4x32-10 generator used for G4CMP internal sampling
+///   (energy partitioning, charge clouds, secondary placement).  Each
+///   stream is keyed by the event, track, step and using process, so
+///   results do not depend on the order in which threads process tracks.
+///
+///   The event key is drawn once per event (run and event ID) from the
+///   Geant4 engine, which is reseeded deterministically by the run manager
+///   for every event.  Repeated selection for the same track step gets a
+///   new stream for each call.
+///
+// $Id$
+//
+// 20201030  New counter-based random stream for reproducible sampling
+// 20201111  Add Gaussian draws with per-stream cache; add event-level stream
+// 20201112  Key on run and event ID; count repeated calls within one step
+
+#ifndef G4CMPRandomStream_hh
+#define G4CMPRandomStream_hh 1
+
+#include "globals.hh"
+#include "G4ThreadLocalSingleton.hh"
+#include "G4ThreeVector.hh"
+#include "CLHEP/Random/RandomEngine.h"
+#include <stdint.h>
+
+class G4Track;
+
+
+class G4CMPRandomStream : public CLHEP::HepRandomEngine {
+  friend class G4ThreadLocalSingleton<G4CMPRandomStream>;
+
+public:
+  static G4CMPRandomStream* Instance();		// Per-thread engine
+  virtual ~G4CMPRandomStream() {;}
+
+  // Select stream for track's current step; "use" separates processes,
+  // and repeated calls in the same step get successive streams
+  static void SetStream(const G4Track& track, G4int use=0);
+  void SetStream(uint64_t evtKey, G4int trackID, G4int stepID, G4int use,
+		 G4int call=0);
+
+  // Select event-level stream, unless one was already chosen in this event;
+  // for use outside of tracking (e.g., primary generators)
+  static void SelectEventStream(G4int use=0);
+
+  // Isotropic unit vector, like G4RandomDirection(), from this stream
+  G4ThreeVector RandomDirection();
+
+  // Gaussian values from this stream; unlike G4RandGauss::shoot(engine),
+  // the spare value of each pair is discarded when the stream changes
+  G4double Gauss(G4double mean=0., G4double sigma=1.);
+  void GaussArray(G4int size, G4double* vect, G4double mean=0.,
+		  G4double sigma=1.);
+
+  // HepRandomEngine interface
+  virtual double flat();
+  virtual void flatArray(const int size, double* vect);
+  virtual void setSeed(long seed, int=0);
+  virtual void setSeeds(const long* seeds, int=0);
+  virtual void saveStatus(const char filename[]="G4CMPRandomStream.conf") const;
+  virtual void restoreStatus(const char filename[]="G4CMPRandomStream.conf");
+  virtual void showStatus() const;
+  virtual std::string name() const { return "G4CMPRandomStream"; }
+
+private:
+  G4CMPRandomStream();
+
+  void NextBlock();			// Encrypt counter, then increment it
+  void UpdateEventKey();		// Draw new key at start of event
+
+  G4int runID;				// Run and event for which eventKey
+  G4int eventID;			//   was drawn
+  uint64_t eventKey;
+
+  G4int stepTrackID;			// Last track step selected, and
+  G4int stepNumber;			//   number of calls for that step
+  G4int stepCalls;
+
+  uint32_t key[2];			// Philox key (event)
+  uint32_t counter[4];			// Block index, call+use, step, track
+  uint32_t block[4];			// Output of last encrypted counter
+  G4int nextWord;			// Next unused word in block
+
+  G4bool streamSet;			// Stream chosen explicitly
+  G4int streamRunID;			// Run and event in which stream
+  G4int streamEventID;			//   was chosen
+
+  G4bool haveGauss;			// Second value of Box-Muller pair
+  G4double nextGauss;
+
+  // Copying is forbidden
+  G4CMPRandomStream(const G4CMPRandomStream&);
+  G4CMPRandomStream& operator=(const G4CMPRandomStream&);
+};
+
+#endif	/* G4CMPRandomStream_hh */
@@ -12,6 +12,8 @@
 //
 // 20150310  Michael Kelsey
 // 20160825  Replace implementation with use of G4CMPEnergyPartition
+// 20201029  Add optional energy-weighted clusters of secondaries along step
+// 20201030  Random index drawn from G4CMPRandomStream
 
 #ifndef G4CMPSecondaryProduction_hh
 #define G4CMPSecondaryProduction_hh 1
@@ -21,6 +23,7 @@
 #include "G4ThreeVector.hh"
 #include <vector>
 
+class G4CMPChargeCloud;
 class G4CMPEnergyPartition;
 class G4DynamicParticle;
 class G4ParticleDefinition;
@@ -54,6 +57,12 @@ protected:
   void AddSecondaries(const G4Step& stepData);
   void GeneratePositions(const G4Step& stepData, size_t npos);
 
+  // Place secondaries in clusters spaced by energy loss along step
+  void GenerateClusters(const G4Step& stepData, size_t npos, size_t nclus);
+
+  // Fractional distance along step for given fraction of energy loss
+  G4double EnergyLossFraction(G4double qloss, G4double slope) const;
+
 public:
   static size_t RandomIndex(size_t imax);	// Used to randomize secondaries
 
@@ -61,6 +70,8 @@ private:
   G4CMPEnergyPartition* partitioner;		// Creates secondary kinematics
   std::vector<G4Track*> theSecs;		// List of created secondaries
   std::vector<G4ThreeVector> posSecs;		// Positions along trajectory
+  std::vector<G4double> randBuf;		// Random numbers for positions
+  G4CMPChargeCloud* cloud;			// Spread charges around clusters
 
   // No copying allowed
   G4CMPSecondaryProduction(const G4CMPSecondaryProduction& right);
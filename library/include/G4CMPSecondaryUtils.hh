@@ -13,18 +13,34 @@
 // 20170620 M. Kelsey -- Replace PV arg with Touchable, for transforms
 // 20170815 M. Kelsey -- Move AdjustSecondaryPosition to GeometryUtils
 // 20170928 M. Kelsey -- Replace "polarization" with "mode"
+// 20201027 Add SecondaryContext to share lattice, clearance across batches
 #ifndef G4CMPSecondaryUtils_hh
 #define G4CMPSecondaryUtils_hh 1
 
 #include "globals.hh"
 #include "G4ThreeVector.hh"
 
+class G4LatticePhysical;
 class G4ParticleDefinition;
 class G4Track;
 class G4VTouchable;
 
 
 namespace G4CMP {
+  // Volume information shared by many secondaries created in one step.
+  // Positions closer than "safety" to "center" skip the clearance check.
+  struct SecondaryContext {
+    const G4VTouchable* touch;
+    const G4LatticePhysical* lattice;
+    G4ThreeVector center;		// Global position for safety
+    G4double safety;
+
+    explicit SecondaryContext(const G4VTouchable* touchable);
+    SecondaryContext(const G4VTouchable* touchable, const G4ThreeVector& pos);
+
+    G4ThreeVector ApplyClearance(const G4ThreeVector& pos) const;
+  };
+
   G4Track* CreateSecondary(const G4Track& track, G4ParticleDefinition* pd,
 			   const G4ThreeVector& waveVec,
 			   G4double energy);
@@ -42,6 +58,26 @@ namespace G4CMP {
 			       G4int valley, G4double time,
 			       const G4ThreeVector& p,
 			       const G4ThreeVector& pos);
+
+  // Batch versions: lattice and surface safety are taken from context
+  G4Track* CreateSecondary(const SecondaryContext& ctx,
+			   G4ParticleDefinition* pd,
+			   const G4ThreeVector& waveVec, G4double energy,
+			   G4double time, const G4ThreeVector& pos);
+
+  G4Track* CreatePhonon(const SecondaryContext& ctx, G4int mode,
+			const G4ThreeVector& waveVec, G4double energy,
+			G4double time, const G4ThreeVector& pos);
+  
+  G4Track* CreateChargeCarrier(const SecondaryContext& ctx, G4int charge,
+			       G4int valley, G4double Ekin, G4double time,
+			       const G4ThreeVector& pdir,
+			       const G4ThreeVector& pos);
+
+  G4Track* CreateChargeCarrier(const SecondaryContext& ctx, G4int charge,
+			       G4int valley, G4double time,
+			       const G4ThreeVector& p,
+			       const G4ThreeVector& pos);
 }
 
 #endif	/* G4CMPSecondaryUtils_hh */
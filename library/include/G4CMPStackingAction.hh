@@ -9,6 +9,8 @@
 // $Id$
 //
 // 20170525  M. Kelsey -- Add default "rule of five" copy/move operators
+// 20201111  Add SetSampling() to copy factors from G4CMPPrimaryInfo
+// 20201112  Add NewStage() to create tracks staged by G4CMPPendingTracks
 
 #ifndef G4CMPStackingAction_h
 #define G4CMPStackingAction_h 1
@@ -16,6 +18,7 @@
 #include "globals.hh"
 #include "G4UserStackingAction.hh"
 #include "G4CMPProcessUtils.hh"
+#include "G4TrackVector.hh"
 
 class G4Track;
 
@@ -28,12 +31,19 @@ public:
 public:
   virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* aTrack);
 
+  // Create next batch of staged tracks once the stacks are empty
+  virtual void NewStage();
+
 protected:
   void SetPhononVelocity(const G4Track* theTrack) const;
 
   void SetChargeCarrierMass(const G4Track* theTrack) const;
   void SetElectronEnergy(const G4Track* aTrack) const;
 
+  void SetSampling(const G4Track* aTrack) const;	// From primary info
+
+  G4TrackVector stagedTracks;		// Buffer reused for each new stage
+
 public:
   G4CMPStackingAction(const G4CMPStackingAction&) = default;
   G4CMPStackingAction(G4CMPStackingAction&&) = default;
@@ -12,6 +12,7 @@
 // $Id$
 //
 // 20161111 Initial commit - R. Agnese
+// 20201025 Carry downsampling factors from energy partitioning
 
 #ifndef G4CMPVTrackInfo_hh
 #define G4CMPVTrackInfo_hh 1
@@ -31,11 +32,21 @@ public:
   const G4LatticePhysical* Lattice() const                   { return lattice; }
   void SetLattice(const G4LatticePhysical* lat)               { lattice = lat; }
 
+  // Downsampling factors from the energy deposit which produced the track;
+  // negative (unset) values fall back to G4CMPConfigManager settings
+  G4double PhononSampling() const;
+  G4double ChargeSampling() const;
+  G4double LukeSampling() const;
+  void SetSampling(G4double phonon, G4double charge, G4double luke);
+
   virtual void Print() const override;
 
 private:
   size_t reflCount = 0; // Number of times track has been reflected
   const G4LatticePhysical* lattice; // The lattice the track is currently in
+  G4double phononSample = -1.;	// Sampling of phonons from energy deposit
+  G4double chargeSample = -1.;	// Sampling of charges from energy deposit
+  G4double lukeSample = -1.;	// Sampling of Luke phonon emission
 };
 
 #endif
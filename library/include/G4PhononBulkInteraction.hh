@@ -0,0 +1,58 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/include/G4PhononBulkInteraction.hh
+/// \brief Definition of the G4PhononBulkInteraction class
+///   Combines phonon isotope scattering and downconversion into a single
+///   process, with one interaction length sampled from the total rate.
+///   At the interaction point, one of the two is chosen according to
+///   their relative rates, and the actual work is delegated to instances
+///   of G4PhononScattering and G4PhononDownconversion.
+//
+// $Id$
+//
+// 20201019  New process to replace separate scattering and downconversion
+// 20201112  Share loaded track data with delegates, instead of reloading
+
+#ifndef G4PhononBulkInteraction_h
+#define G4PhononBulkInteraction_h 1
+
+#include "G4VPhononProcess.hh"
+
+class G4CMPPhononBulkRate;
+class G4PhononDownconversion;
+class G4PhononScattering;
+
+
+class G4PhononBulkInteraction : public G4VPhononProcess {
+public:
+  G4PhononBulkInteraction(const G4String& processName="phononBulk");
+  virtual ~G4PhononBulkInteraction();
+
+  virtual G4VParticleChange* PostStepDoIt(const G4Track&, const G4Step&);
+
+  // Pass track and verbosity configuration through to delegates, without
+  // repeating LoadDataForTrack() for each
+  virtual void StartTracking(G4Track* track);
+  virtual void EndTracking();
+
+protected:
+  // Keep function here as call-back to avoid getting old toolkit version
+  virtual G4double GetMeanFreePath(const G4Track& trk, G4double prevstep,
+				   G4ForceCondition* cond) {
+    return G4CMPVProcess::GetMeanFreePath(trk, prevstep, cond);
+  }
+
+private:
+  G4CMPPhononBulkRate* bulkRate;	// Owned by base class
+  G4PhononScattering* scattering;
+  G4PhononDownconversion* downconversion;
+
+  // hide assignment operator as private 
+  G4PhononBulkInteraction(G4PhononBulkInteraction&);
+  G4PhononBulkInteraction& operator=(const G4PhononBulkInteraction& right);
+};
+
+#endif	/* G4PhononBulkInteraction_h */
@@ -9,11 +9,19 @@
 // $Id$
 //
 // 20170805  Replace GetMeanFreePath() with scattering-rate model
+// 20201018  Add optional inline cascade for products far from surfaces
+// 20201101  Thin daughter phonons when event exceeds phonon track budget
+// 20201112  Use G4CMPPhononBulkRate for rates in inline cascade
 
 #ifndef G4PhononDownconversion_h
 #define G4PhononDownconversion_h 1
 
 #include "G4VPhononProcess.hh"
+#include "G4ThreeVector.hh"
+#include <vector>
+
+class G4CMPPhononBulkRate;
+class G4VSolid;
 
 class G4PhononDownconversion : public G4VPhononProcess {
 public:
@@ -40,12 +48,41 @@ private:
   inline double MakeTTDeviation(G4double, G4double) const;
   inline double MakeTDeviation(G4double, G4double) const;
 
+  // Kinematics of phonons decayed or scattered without creating tracks
+  struct Phonon {
+    G4int mode;
+    G4ThreeVector k;		// Wavevector direction
+    G4ThreeVector pos;		// Local coordinates when used in cascade
+    G4double energy;
+    G4double time;
+
+    Phonon() : mode(0), energy(0.), time(0.) {;}
+  };
+
+  // Fill daughter energies, directions and polarizations from parent
+  void DecayTT(const Phonon& parent, Phonon& sec1, Phonon& sec2);
+  void DecayLT(const Phonon& parent, Phonon& sec1, Phonon& sec2);
+
   void MakeTTSecondaries(const G4Track&);
   void MakeLTSecondaries(const G4Track&);
 
+  // Decay products far from the surface are processed in place; only
+  // survivors which might reach a surface are turned into tracks
+  void MakeCascadeSecondaries(const G4Track&);
+  G4bool PropagateInline(const G4VSolid* solid, Phonon& phon) const;
+
+  // Add daughter track, or drop it when over the phonon track budget
+  void AddDaughter(const G4Track& parent, G4Track* sec);
+
 private:
   G4double fBeta, fGamma, fLambda, fMu;	// Local buffers for calculations
   G4double fvLvT;			// Ratio of sound speeds
+  G4double fKeepProb;			// Daughter survival for track budget
+  G4int fDaughters;			// Daughters produced, before thinning
+
+  std::vector<Phonon> cascade;		// Buffers reused for inline cascade
+  std::vector<Phonon> survivors;
+  G4CMPPhononBulkRate* cascadeRate;	// Bulk rates for cascade phonons
 
   // hide assignment operator as private 
   G4PhononDownconversion(G4PhononDownconversion&);
@@ -0,0 +1,103 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/src/G4CMPBinnedElectrodeSensitivity.cc
+/// \brief Implementation of the G4CMPBinnedElectrodeSensitivity class
+//
+// $Id$
+//
+// 20201108  New class for aggregated electrode output
+// 20201111  Validate binning in constructor; send NaN times to lost energy
+
+#include "G4CMPBinnedElectrodeSensitivity.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4Track.hh"
+#include "G4VTouchable.hh"
+#include <algorithm>
+#include <math.h>
+
+
+// Constructor and binning
+
+G4CMPBinnedElectrodeSensitivity::
+G4CMPBinnedElectrodeSensitivity(G4String name, size_t nChannels,
+				size_t nBins, G4double binWidth,
+				G4double startTime)
+  : G4CMPElectrodeSensitivity(name), nChan(nChannels), nBin(0), width(0.),
+    tStart(0.), channelDepth(0), lostEnergy(0.) {
+  SetTimeBins(nBins, binWidth, startTime);	// Validates width
+}
+
+void G4CMPBinnedElectrodeSensitivity::SetChannels(size_t nChannels) {
+  nChan = nChannels;
+  energy.assign(nChan*nBin, 0.);
+  lostEnergy = 0.;
+}
+
+void G4CMPBinnedElectrodeSensitivity::SetTimeBins(size_t nBins,
+						  G4double binWidth,
+						  G4double startTime) {
+  if (binWidth <= 0.) {
+    G4Exception("G4CMPBinnedElectrodeSensitivity::SetTimeBins", "Binned001",
+		FatalErrorInArgument, "Time bin width must be positive.");
+    return;
+  }
+
+  nBin = nBins;
+  width = binWidth;
+  tStart = startTime;
+  energy.assign(nChan*nBin, 0.);
+  lostEnergy = 0.;
+}
+
+
+// No hits collection is created; arrays are reused for each event
+
+void G4CMPBinnedElectrodeSensitivity::Initialize(G4HCofThisEvent*) {
+  Clear();
+}
+
+void G4CMPBinnedElectrodeSensitivity::Clear() {
+  std::fill(energy.begin(), energy.end(), 0.);
+  lostEnergy = 0.;
+}
+
+
+// Add hit value to its channel and time bin
+
+G4bool G4CMPBinnedElectrodeSensitivity::ProcessHits(G4Step* aStep,
+						    G4TouchableHistory* ROhist) {
+  if (!IsHit(aStep, ROhist)) return true;
+
+  G4double value = HitValue(aStep);
+  if (value == 0.) return true;
+
+  G4int chan = ChannelOf(aStep);
+  G4double tbin = floor((aStep->GetPostStepPoint()->GetGlobalTime()-tStart)
+			/ width);
+
+  // Written to reject NaN as well as out-of-range times
+  if (chan < 0 || chan >= (G4int)nChan || !(tbin >= 0. && tbin < nBin)) {
+    lostEnergy += value;
+  } else {
+    energy[chan*nBin + (size_t)tbin] += value;
+  }
+
+  return true;
+}
+
+// Electrode is the volume being entered, at the boundary
+
+G4int G4CMPBinnedElectrodeSensitivity::ChannelOf(const G4Step* step) const {
+  const G4VTouchable* touch = step->GetPostStepPoint()->GetTouchable();
+  if (!touch || touch->GetHistoryDepth() < channelDepth) return -1;
+
+  return touch->GetCopyNumber(channelDepth);
+}
+
+G4double G4CMPBinnedElectrodeSensitivity::HitValue(const G4Step* step) const {
+  return step->GetTrack()->GetWeight() * step->GetNonIonizingEnergyDeposit();
+}
@@ -12,19 +12,26 @@
 ///   sphere will be "folded" inward at bounding surfaces.
 ///
 // $Id$
+//
+// 20201026  Generate points in batches, skipping boundary checks inside
+//		safety radius; replace packed zzzyyyxxx bin index with
+//		hash lookup of (i,j,k) bins, numbered sequentially.
+// 20201030  Draw random numbers from per-thread G4CMPRandomStream
 
 #include "G4CMPChargeCloud.hh"
 #include "G4CMPGeometryUtils.hh"
+#include "G4CMPRandomStream.hh"
 #include "G4LatticeLogical.hh"
 #include "G4LatticeManager.hh"
 #include "G4LatticePhysical.hh"
 #include "G4LogicalVolume.hh"
-#include "G4RandomDirection.hh"
+#include "G4PhysicalConstants.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4VPhysicalVolume.hh"
 #include "G4VSolid.hh"
 #include "G4VTouchable.hh"
-#include "Randomize.hh"
+#include <cmath>
+#include <float.h>
 #include <math.h>
 
 
@@ -117,9 +124,17 @@ G4CMPChargeCloud::Generate(G4int npos, const G4ThreeVector& center) {
   theCloudBins.clear();
   theCloudBins.reserve(npos);
 
+  theBinMap.clear();
+  theBinCenters.clear();
+
+  GeneratePoints(npos, cloudRadius);
+
+  // Points closer to center than nearest surface can't be outside volume
+  G4double safety = (theSolid ? theSolid->DistanceToOut(localCenter) : DBL_MAX);
+
   for (G4int i=0; i<npos; i++) {
-    theCloud.push_back(GeneratePoint(cloudRadius)+localCenter);
-    if (theSolid) AdjustToVolume(theCloud.back());	// Checkout boundaries
+    theCloud.push_back(G4ThreeVector(xBuf[i],yBuf[i],zBuf[i])+localCenter);
+    if (rBuf[i] >= safety) AdjustToVolume(theCloud.back());
 
     theCloudBins.push_back(GetBinIndex(theCloud.back()));
 
@@ -152,13 +167,49 @@ G4double G4CMPChargeCloud::ComputeRadius(G4int npos) const {
 }
 
 
+// Fill buffers with random points in sphere, relative to center
+// NOTE:  Same distribution as GeneratePoint(), drawn in separate passes
+
+void G4CMPChargeCloud::GeneratePoints(G4int npos, G4double rmax) {
+  rBuf.resize(npos);
+  xBuf.resize(npos);
+  yBuf.resize(npos);
+  zBuf.resize(npos);
+
+  G4CMPRandomStream* rng = G4CMPRandomStream::Instance();
+  rng->flatArray(npos, rBuf.data());
+  rng->flatArray(npos, zBuf.data());
+  rng->flatArray(npos, xBuf.data());
+
+  for (G4int i=0; i<npos; i++) {		// Linear from r=0 to rmax
+    rBuf[i] = rmax*(1.-sqrt(1.-rBuf[i]*rBuf[i]));
+  }
+
+  // Isotropic directions; cos(theta) and phi stored temporarily
+  for (G4int i=0; i<npos; i++) {
+    zBuf[i] = 2.*zBuf[i] - 1.;
+    xBuf[i] = twopi*xBuf[i];
+  }
+
+  G4double sinth = 0.;
+  for (G4int i=0; i<npos; i++) {
+    sinth = sqrt((1.-zBuf[i])*(1.+zBuf[i]));
+    yBuf[i] = rBuf[i]*sinth*sin(xBuf[i]);
+    xBuf[i] = rBuf[i]*sinth*cos(xBuf[i]);
+    zBuf[i] *= rBuf[i];
+  }
+}
+
+
 // Generate random point in specified sphere
 
 G4ThreeVector G4CMPChargeCloud::GeneratePoint(G4double rmax) const {
-  G4double rndm = G4UniformRand();
+  G4CMPRandomStream* rng = G4CMPRandomStream::Instance();
+
+  G4double rndm = rng->flat();
   G4double r = rmax*(1.-sqrt(1.-rndm*rndm));	// Linear from r=0 to rmax
 
-  return r*G4RandomDirection();
+  return r*rng->RandomDirection();
 }
 
 
@@ -184,25 +235,39 @@ void G4CMPChargeCloud::AdjustToVolume(G4ThreeVector& point) const {
 // Conversions between local position and bin index (ijk)
 // Binning is done in units of 4 lattice spacings, centered on (0,0,0)
 
-G4int G4CMPChargeCloud::GetBinIndex(G4ThreeVector pos) const {
-  // NOTE:  Argument passed by value for use in computations below
+G4int G4CMPChargeCloud::GetBinIndex(const G4ThreeVector& pos) {
+  auto ins = theBinMap.emplace(MakeBinKey(pos), (G4int)theBinCenters.size());
+  if (ins.second) {		// New bin; compute and store its center
+    G4ThreeVector rel = (pos - localCenter) / binSpacing;
+    theBinCenters.push_back(G4ThreeVector(std::floor(rel.x()+0.5),
+					  std::floor(rel.y()+0.5),
+					  std::floor(rel.z()+0.5))*binSpacing
+			    + localCenter);
+
+    // Bin centers are reported in same coordinates as points
+    if (theTouchable)
+      G4CMP::RotateToGlobalPosition(theTouchable, theBinCenters.back());
+  }
+
+  return ins.first->second;
+}
+
+// Each (i,j,k) is offset to be non-negative, and packed into 21 bits
 
-  // Convert local position in volume to bin index (w/(0,0,0) at bin center)
-  pos -= localCenter;
-  pos += G4ThreeVector(cloudRadius+binSpacing/2., cloudRadius+binSpacing/2.,
-		       cloudRadius+binSpacing/2.);
+G4CMPChargeCloud::BinKey
+G4CMPChargeCloud::MakeBinKey(const G4ThreeVector& pos) const {
+  static const long long offset = 1LL<<20;
+  static const BinKey mask = (1ULL<<21) - 1;
 
-  pos /= binSpacing;
+  G4ThreeVector rel = (pos - localCenter) / binSpacing;
+  BinKey i = (BinKey)((long long)std::floor(rel.x()+0.5) + offset) & mask;
+  BinKey j = (BinKey)((long long)std::floor(rel.y()+0.5) + offset) & mask;
+  BinKey k = (BinKey)((long long)std::floor(rel.z()+0.5) + offset) & mask;
 
-  // Bin index (ijk) allows up to 64 billion unit cells in cloud
-  return (int(pos.z())*1000 + int(pos.y()))*1000 + int(pos.x());
+  return (k<<42) | (j<<21) | i;
 }
 
 G4ThreeVector G4CMPChargeCloud::GetBinCenter(G4int ibin) const {
-  G4ThreeVector pbin((ibin%1000 - 0.5)*binSpacing - cloudRadius,
-		     ((ibin/1000)%1000 - 0.5)*binSpacing - cloudRadius,
-		     (ibin/1000000 - 0.5)*binSpacing - cloudRadius);
-  pbin += localCenter;
-
-  return pbin;
+  return ((ibin>=0 && ibin<GetNumberOfBins()) ? theBinCenters[ibin]
+	  : localCenter);
 }
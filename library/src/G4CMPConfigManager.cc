@@ -33,6 +33,13 @@
 // 20200530  G4CMP-202:  Provide separate master and worker instances
 // 20200614  G4CMP-211:  Add functionality to print settings
 // 20200614  G4CMP-210:  Add missing initializers to copy constructor
+// 20201018  Add scale factor for inline phonon downconversion cascade
+// 20201019  Add flag to combine phonon scattering and downconversion
+// 20201021  Add flag for fast ballistic phonon flights between surfaces
+// 20201022  Add phonon Russian roulette and splitting thresholds
+// 20201029  Add number of energy-weighted clusters for secondary positions
+// 20201101  Add per-event track budgets for adaptive downsampling
+// 20201112  Add batch size for staged creation of deposit tracks
 
 #include "G4CMPConfigManager.hh"
 #include "G4CMPConfigMessenger.hh"
@@ -73,6 +80,10 @@ G4CMPConfigManager::G4CMPConfigManager()
   : verbose(getenv("G4CMP_DEBUG")?atoi(getenv("G4CMP_DEBUG")):0),
     ehBounces(getenv("G4CMP_EH_BOUNCES")?atoi(getenv("G4CMP_EH_BOUNCES")):1),
     pBounces(getenv("G4CMP_PHON_BOUNCES")?atoi(getenv("G4CMP_PHON_BOUNCES")):100),
+    nClusters(getenv("G4CMP_SECONDARY_CLUSTERS")?atoi(getenv("G4CMP_SECONDARY_CLUSTERS")):0),
+    phononBudget(getenv("G4CMP_PHONON_BUDGET")?atoi(getenv("G4CMP_PHONON_BUDGET")):0),
+    chargeBudget(getenv("G4CMP_CHARGE_BUDGET")?atoi(getenv("G4CMP_CHARGE_BUDGET")):0),
+    trackBatch(getenv("G4CMP_TRACK_BATCH")?atoi(getenv("G4CMP_TRACK_BATCH")):10000),
     LatticeDir(getenv("G4LATTICEDATA")?getenv("G4LATTICEDATA"):"./CrystalMaps"),
     IVRateModel(getenv("G4CMP_IV_RATE_MODEL")?getenv("G4CMP_IV_RATE_MODEL"):"Quadratic"),
     eTrapMFP(getenv("G4CMP_ETRAPPING_MFP")?strtod(getenv("G4CMP_ETRAPPING_MFP"),0)*mm:DBL_MAX),
@@ -87,11 +98,17 @@ G4CMPConfigManager::G4CMPConfigManager()
     genPhonons(getenv("G4CMP_MAKE_PHONONS")?strtod(getenv("G4CMP_MAKE_PHONONS"),0):1.),
     genCharges(getenv("G4CMP_MAKE_CHARGES")?strtod(getenv("G4CMP_MAKE_CHARGES"),0):1.),
     lukeSample(getenv("G4CMP_LUKE_SAMPLE")?strtod(getenv("G4CMP_LUKE_SAMPLE"),0):1.),
+    cascadeScale(getenv("G4CMP_DOWNCONV_CASCADE")?strtod(getenv("G4CMP_DOWNCONV_CASCADE"),0):0.),
+    rouletteEnergy(getenv("G4CMP_ROULETTE_ENERGY")?strtod(getenv("G4CMP_ROULETTE_ENERGY"),0)*eV:0.),
+    splitWeight(getenv("G4CMP_SPLIT_WEIGHT")?strtod(getenv("G4CMP_SPLIT_WEIGHT"),0):0.),
+    splitDistance(getenv("G4CMP_SPLIT_DISTANCE")?strtod(getenv("G4CMP_SPLIT_DISTANCE"),0)*mm:0.),
     EminPhonons(getenv("G4CMP_EMIN_PHONONS")?strtod(getenv("G4CMP_EMIN_PHONONS"),0)*eV:0.),
     EminCharges(getenv("G4CMP_EMIN_CHARGES")?strtod(getenv("G4CMP_EMIN_CHARGES"),0)*eV:0.),
     useKVsolver(getenv("G4CMP_USE_KVSOLVER")?atoi(getenv("G4CMP_USE_KVSOLVER")):0),
     fanoEnabled(getenv("G4CMP_FANO_ENABLED")?atoi(getenv("G4CMP_FANO_ENABLED")):1),
     chargeCloud(getenv("G4CMP_CHARGE_CLOUD")?atoi(getenv("G4CMP_CHARGE_CLOUD")):0),
+    phononBulk(getenv("G4CMP_PHONON_BULK")?atoi(getenv("G4CMP_PHONON_BULK")):0),
+    fastBallistic(getenv("G4CMP_FAST_BALLISTIC")?atoi(getenv("G4CMP_FAST_BALLISTIC")):0),
     nielPartition(0), messenger(new G4CMPConfigMessenger(this)) {
   fPhysicsModelID = G4PhysicsModelCatalog::Register("G4CMP process");
 
@@ -112,6 +129,8 @@ G4CMPConfigManager::~G4CMPConfigManager() {
 G4CMPConfigManager::G4CMPConfigManager(const G4CMPConfigManager& master)
   : verbose(master.verbose), fPhysicsModelID(master.fPhysicsModelID), 
     ehBounces(master.ehBounces), pBounces(master.pBounces), 
+    nClusters(master.nClusters), phononBudget(master.phononBudget),
+    chargeBudget(master.chargeBudget), trackBatch(master.trackBatch),
     version(master.version), LatticeDir(master.LatticeDir), 
     IVRateModel(master.IVRateModel), eTrapMFP(master.eTrapMFP),
     hTrapMFP(master.hTrapMFP), eDTrapIonMFP(master.eDTrapIonMFP),
@@ -119,9 +138,13 @@ G4CMPConfigManager::G4CMPConfigManager(const G4CMPConfigManager& master)
     hATrapIonMFP(master.hATrapIonMFP), clearance(master.clearance), 
     stepScale(master.stepScale), sampleEnergy(master.sampleEnergy), 
     genPhonons(master.genPhonons), genCharges(master.genCharges), 
-    lukeSample(master.lukeSample), EminPhonons(master.EminPhonons), 
+    lukeSample(master.lukeSample), cascadeScale(master.cascadeScale),
+    rouletteEnergy(master.rouletteEnergy), splitWeight(master.splitWeight),
+    splitDistance(master.splitDistance),
+    EminPhonons(master.EminPhonons), 
     EminCharges(master.EminCharges), useKVsolver(master.useKVsolver), 
     fanoEnabled(master.fanoEnabled), chargeCloud(master.chargeCloud), 
+    phononBulk(master.phononBulk), fastBallistic(master.fastBallistic),
     nielPartition(master.nielPartition),
     messenger(new G4CMPConfigMessenger(this)) {;}
 
@@ -166,6 +189,10 @@ void G4CMPConfigManager::printConfig(std::ostream& os) const {
      << "\nG4CMP_DEBUG " << verbose
      << "\nG4CMP_EH_BOUNCES " << ehBounces
      << "\nG4CMP_PHON_BOUNCES " << pBounces
+     << "\nG4CMP_SECONDARY_CLUSTERS " << nClusters
+     << "\nG4CMP_PHONON_BUDGET " << phononBudget
+     << "\nG4CMP_CHARGE_BUDGET " << chargeBudget
+     << "\nG4CMP_TRACK_BATCH " << trackBatch
      << "\nG4CMP_IV_RATE_MODEL " << IVRateModel
      << "\nG4CMP_ETRAPPING_MFP " << eTrapMFP
      << "\nG4CMP_HTRAPPING_MFP " << hTrapMFP
@@ -179,11 +206,17 @@ void G4CMPConfigManager::printConfig(std::ostream& os) const {
      << "\nG4CMP_MAKE_PHONONS " << genPhonons
      << "\nG4CMP_MAKE_CHARGES " << genCharges
      << "\nG4CMP_LUKE_SAMPLE " << lukeSample
+     << "\nG4CMP_DOWNCONV_CASCADE " << cascadeScale
+     << "\nG4CMP_ROULETTE_ENERGY " << rouletteEnergy
+     << "\nG4CMP_SPLIT_WEIGHT " << splitWeight
+     << "\nG4CMP_SPLIT_DISTANCE " << splitDistance
      << "\nG4CMP_EMIN_PHONONS " << EminPhonons
      << "\nG4CMP_EMIN_CHARGES " << EminCharges
      << "\nG4CMP_USE_KVSOLVER " << useKVsolver
      << "\nG4CMP_FANO_ENABLED " << fanoEnabled
      << "\nG4CMP_CHARGE_CLOUD " << chargeCloud
+     << "\nG4CMP_PHONON_BULK " << phononBulk
+     << "\nG4CMP_FAST_BALLISTIC " << fastBallistic
      << "\nG4CMP_NIEL_FUNCTION "
      << (nielPartition ? typeid(*nielPartition).name() : "---")
      << "\nfPhysicsModelID " << fPhysicsModelID
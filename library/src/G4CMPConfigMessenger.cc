@@ -34,6 +34,13 @@
 //		"hTrap" -> "ATrap".
 // 20200504  G4CMP-195:  Reduce length of charge-trapping parameter names
 // 20200614  G4CMP-211:  Add functionality to print settings
+// 20201018  Add command to enable inline downconversion cascade
+// 20201019  Add command to combine phonon scattering and downconversion
+// 20201021  Add command for fast ballistic phonon flights
+// 20201022  Add commands for phonon Russian roulette and splitting
+// 20201029  Add command for energy-weighted secondary clusters
+// 20201101  Add commands for per-event phonon and charge track budgets
+// 20201112  Add command for batch size of staged deposit tracks
 
 #include "G4CMPConfigMessenger.hh"
 #include "G4CMPConfigManager.hh"
@@ -51,12 +58,14 @@ G4CMPConfigMessenger::G4CMPConfigMessenger(G4CMPConfigManager* mgr)
   : G4UImessenger("/g4cmp/",
 		  "User configuration for G4CMP phonon/charge carrier library"),
     theManager(mgr), versionCmd(0), printCmd(0), verboseCmd(0), ehBounceCmd(0),
-    pBounceCmd(0), clearCmd(0), minEPhononCmd(0), minEChargeCmd(0),
+    pBounceCmd(0), clusterCmd(0), phononBudgetCmd(0), chargeBudgetCmd(0),
+    trackBatchCmd(0), clearCmd(0), minEPhononCmd(0), minEChargeCmd(0),
     sampleECmd(0), trapEMFPCmd(0), trapHMFPCmd(0), eDTrapIonMFPCmd(0),
     eATrapIonMFPCmd(0), hDTrapIonMFPCmd(0), hATrapIonMFPCmd(0), minstepCmd(0),
-    makePhononCmd(0), makeChargeCmd(0), lukePhononCmd(0), dirCmd(0),
+    makePhononCmd(0), makeChargeCmd(0), lukePhononCmd(0), cascadeCmd(0),
+    splitWeightCmd(0), rouletteECmd(0), splitDistCmd(0), dirCmd(0),
     ivRateModelCmd(0), nielPartitionCmd(0), kvmapCmd(0), fanoStatsCmd(0),
-    ehCloudCmd(0) {
+    ehCloudCmd(0), phononBulkCmd(0), fastBallisticCmd(0) {
   verboseCmd = CreateCommand<G4UIcmdWithAnInteger>("verbose",
 					   "Enable diagnostic messages");
 
@@ -97,6 +106,36 @@ G4CMPConfigMessenger::G4CMPConfigMessenger(G4CMPConfigManager* mgr)
   lukePhononCmd = CreateCommand<G4UIcmdWithADouble>("sampleLuke",
 		    "Set rate of Luke actual phonon production");
 
+  cascadeCmd = CreateCommand<G4UIcmdWithADouble>("downconversionCascade",
+		    "Downconvert phonons inline far from volume surfaces");
+  cascadeCmd->SetGuidance("Products of phonon downconversion are decayed");
+  cascadeCmd->SetGuidance("and scattered inline, without creating tracks,");
+  cascadeCmd->SetGuidance("while their mean free path times this factor is");
+  cascadeCmd->SetGuidance("less than the distance to the volume surface.");
+  cascadeCmd->SetGuidance("Zero (the default) disables the cascade.");
+  cascadeCmd->SetParameterName("scale",false);
+  cascadeCmd->SetRange("scale>=0");
+
+  rouletteECmd = CreateCommand<G4UIcmdWithADoubleAndUnit>("phononRouletteEnergy",
+          "Russian roulette for phonons below this energy times weight");
+  rouletteECmd->SetGuidance("Surviving phonons have their weight increased");
+  rouletteECmd->SetGuidance("to conserve the expected energy.  Zero (the");
+  rouletteECmd->SetGuidance("default) disables roulette.");
+  rouletteECmd->SetUnitCategory("Energy");
+
+  splitWeightCmd = CreateCommand<G4UIcmdWithADouble>("phononSplitWeight",
+          "Split phonons with weight above this value near surfaces");
+  splitWeightCmd->SetGuidance("Phonons are split into copies with weight");
+  splitWeightCmd->SetGuidance("no greater than this value, when they come");
+  splitWeightCmd->SetGuidance("within phononSplitDistance of the surface.");
+  splitWeightCmd->SetGuidance("Zero (the default) disables splitting.");
+  splitWeightCmd->SetParameterName("weight",false);
+  splitWeightCmd->SetRange("weight>=0");
+
+  splitDistCmd = CreateCommand<G4UIcmdWithADoubleAndUnit>("phononSplitDistance",
+          "Distance from volume surface at which to split phonons");
+  splitDistCmd->SetUnitCategory("Length");
+
   minEPhononCmd = CreateCommand<G4UIcmdWithADoubleAndUnit>("minEPhonons",
           "Minimum energy for creating or tracking phonons");
 
@@ -109,6 +148,44 @@ G4CMPConfigMessenger::G4CMPConfigMessenger(G4CMPConfigManager* mgr)
   pBounceCmd = CreateCommand<G4UIcmdWithAnInteger>("phononBounces",
 		  "Maximum number of reflections allowed for phonons");
 
+  clusterCmd = CreateCommand<G4UIcmdWithAnInteger>("secondaryClusters",
+		  "Group secondaries into energy-weighted clusters along step");
+  clusterCmd->SetGuidance("Phonons and charge carriers from each step are");
+  clusterCmd->SetGuidance("placed in up to this many clusters, spaced by");
+  clusterCmd->SetGuidance("energy loss along the step.  Charges in each");
+  clusterCmd->SetGuidance("cluster are spread in a charge cloud.  Zero (the");
+  clusterCmd->SetGuidance("default) spreads secondaries uniformly instead.");
+  clusterCmd->SetParameterName("N",false);
+  clusterCmd->SetRange("N>=0");
+
+  phononBudgetCmd = CreateCommand<G4UIcmdWithAnInteger>("phononTrackBudget",
+		  "Target number of phonon tracks per event");
+  phononBudgetCmd->SetGuidance("Downsampling of primary, Luke and downconverted");
+  phononBudgetCmd->SetGuidance("phonons is adjusted for each energy deposit to");
+  phononBudgetCmd->SetGuidance("stay near this many tracks in each event.  Zero");
+  phononBudgetCmd->SetGuidance("(the default) uses only the fixed sampling.");
+  phononBudgetCmd->SetParameterName("N",false);
+  phononBudgetCmd->SetRange("N>=0");
+
+  chargeBudgetCmd = CreateCommand<G4UIcmdWithAnInteger>("chargeTrackBudget",
+		  "Target number of charge carrier tracks per event");
+  chargeBudgetCmd->SetGuidance("Downsampling of e/h pairs is adjusted for each");
+  chargeBudgetCmd->SetGuidance("energy deposit to stay near this many tracks");
+  chargeBudgetCmd->SetGuidance("in each event.  Zero (the default) uses only");
+  chargeBudgetCmd->SetGuidance("the fixed sampling.");
+  chargeBudgetCmd->SetParameterName("N",false);
+  chargeBudgetCmd->SetRange("N>=0");
+
+  trackBatchCmd = CreateCommand<G4UIcmdWithAnInteger>("trackBatchSize",
+		  "Maximum tracks created at once from an energy deposit");
+  trackBatchCmd->SetGuidance("Phonons and charge carriers beyond this number");
+  trackBatchCmd->SetGuidance("are kept as compact records, and tracked in");
+  trackBatchCmd->SetGuidance("batches of this size once the tracks already");
+  trackBatchCmd->SetGuidance("stacked have finished.  Zero creates all tracks");
+  trackBatchCmd->SetGuidance("immediately.");
+  trackBatchCmd->SetParameterName("N",false);
+  trackBatchCmd->SetRange("N>=0");
+
   kvmapCmd = CreateCommand<G4UIcmdWithABool>("useKVsolver",
 			     "Use eigenvector solver for K-Vg conversion");
   kvmapCmd->SetParameterName("lookup",true,false);
@@ -157,6 +234,15 @@ G4CMPConfigMessenger::G4CMPConfigMessenger(G4CMPConfigManager* mgr)
   ehCloudCmd = CreateCommand<G4UIcmdWithABool>("createChargeCloud",
        "Produce e/h pairs in cloud surrounding energy deposit position");
   ehCloudCmd->SetDefaultValue(true);
+
+  phononBulkCmd = CreateCommand<G4UIcmdWithABool>("combinePhononBulk",
+       "Use single process for phonon scattering and downconversion");
+  phononBulkCmd->SetDefaultValue(true);
+  phononBulkCmd->AvailableForStates(G4State_PreInit);
+
+  fastBallisticCmd = CreateCommand<G4UIcmdWithABool>("fastBallistic",
+       "Follow phonon reflections in box or tube crystals within one step");
+  fastBallisticCmd->SetDefaultValue(true);
 }
 
 
@@ -166,6 +252,10 @@ G4CMPConfigMessenger::~G4CMPConfigMessenger() {
   delete versionCmd; versionCmd=0;
   delete ehBounceCmd; ehBounceCmd=0;
   delete pBounceCmd; pBounceCmd=0;
+  delete clusterCmd; clusterCmd=0;
+  delete phononBudgetCmd; phononBudgetCmd=0;
+  delete chargeBudgetCmd; chargeBudgetCmd=0;
+  delete trackBatchCmd; trackBatchCmd=0;
   delete clearCmd; clearCmd=0;
   delete minEPhononCmd; minEPhononCmd=0;
   delete minEChargeCmd; minEChargeCmd=0;
@@ -180,10 +270,16 @@ G4CMPConfigMessenger::~G4CMPConfigMessenger() {
   delete makePhononCmd; makePhononCmd=0;
   delete makeChargeCmd; makeChargeCmd=0;
   delete lukePhononCmd; lukePhononCmd=0;
+  delete cascadeCmd; cascadeCmd=0;
+  delete rouletteECmd; rouletteECmd=0;
+  delete splitWeightCmd; splitWeightCmd=0;
+  delete splitDistCmd; splitDistCmd=0;
   delete dirCmd; dirCmd=0;
   delete kvmapCmd; kvmapCmd=0;
   delete fanoStatsCmd; fanoStatsCmd=0;
   delete ehCloudCmd; ehCloudCmd=0;
+  delete phononBulkCmd; phononBulkCmd=0;
+  delete fastBallisticCmd; fastBallisticCmd=0;
   delete ivRateModelCmd; ivRateModelCmd=0;
   delete nielPartitionCmd; nielPartitionCmd=0;
 }
@@ -197,13 +293,25 @@ void G4CMPConfigMessenger::SetNewValue(G4UIcommand* cmd, G4String value) {
   if (cmd == makePhononCmd) theManager->SetGenPhonons(StoD(value));
   if (cmd == makeChargeCmd) theManager->SetGenCharges(StoD(value));
   if (cmd == lukePhononCmd) theManager->SetLukeSampling(StoD(value));
+  if (cmd == cascadeCmd) theManager->SetCascadeScale(StoD(value));
+  if (cmd == splitWeightCmd) theManager->SetSplitWeight(StoD(value));
   if (cmd == ehBounceCmd) theManager->SetMaxChargeBounces(StoI(value));
   if (cmd == pBounceCmd) theManager->SetMaxPhononBounces(StoI(value));
+  if (cmd == clusterCmd) theManager->SetSecondaryClusters(StoI(value));
+  if (cmd == phononBudgetCmd) theManager->SetPhononBudget(StoI(value));
+  if (cmd == chargeBudgetCmd) theManager->SetChargeBudget(StoI(value));
+  if (cmd == trackBatchCmd) theManager->SetTrackBatch(StoI(value));
   if (cmd == dirCmd) theManager->SetLatticeDir(value);
 
   if (cmd == clearCmd)
     theManager->SetSurfaceClearance(clearCmd->GetNewDoubleValue(value));
 
+  if (cmd == rouletteECmd)
+    theManager->SetRouletteEnergy(rouletteECmd->GetNewDoubleValue(value));
+
+  if (cmd == splitDistCmd)
+    theManager->SetSplitDistance(splitDistCmd->GetNewDoubleValue(value));
+
   if (cmd == minEPhononCmd)
     theManager->SetMinPhononEnergy(minEPhononCmd->GetNewDoubleValue(value));
 
@@ -236,6 +344,8 @@ void G4CMPConfigMessenger::SetNewValue(G4UIcommand* cmd, G4String value) {
   if (cmd == ivRateModelCmd) theManager->SetIVRateModel(value);
   if (cmd == nielPartitionCmd) theManager->SetNIELPartition(value);
   if (cmd == ehCloudCmd) theManager->CreateChargeCloud(StoB(value));
+  if (cmd == phononBulkCmd) theManager->CombinePhononBulk(StoB(value));
+  if (cmd == fastBallisticCmd) theManager->UseFastBallistic(StoB(value));
 
   if (cmd == versionCmd)
     G4cout << "G4CMP version: " << theManager->Version() << G4endl;
@@ -15,12 +15,15 @@
 // 20170802  M. Kelsey -- Replace phonon production with G4CMPEnergyPartition
 // 20171215  Replace boundary-point check with CheckStepBoundary()
 // 20180827  M. Kelsey -- Prevent partitioner from recomputing sampling factors
+// 20201025  Pass sampling factors from track to partitioner
+// 20201030  Select reproducible random stream for partitioning
 
 #include "G4CMPDriftBoundaryProcess.hh"
 #include "G4CMPConfigManager.hh"
 #include "G4CMPDriftElectron.hh"
 #include "G4CMPDriftHole.hh"
 #include "G4CMPEnergyPartition.hh"
+#include "G4CMPRandomStream.hh"
 #include "G4CMPGeometryUtils.hh"
 #include "G4CMPSecondaryUtils.hh"
 #include "G4CMPSurfaceProperty.hh"
@@ -44,7 +47,7 @@
 G4CMPDriftBoundaryProcess::G4CMPDriftBoundaryProcess(const G4String& name)
   : G4CMPVDriftProcess(name, fChargeBoundary), G4CMPBoundaryUtils(this),
     partitioner(new G4CMPEnergyPartition) {
-  partitioner->UseDownsampling(false);		// Apply preset scaling factors
+  partitioner->UseDownsampling(false);		// Apply track's scaling factors
 }
 
 G4CMPDriftBoundaryProcess::~G4CMPDriftBoundaryProcess() {
@@ -138,6 +141,8 @@ void G4CMPDriftBoundaryProcess::DoAbsorption(const G4Track& aTrack,
 
   *(G4CMPProcessUtils*)partitioner = *(G4CMPProcessUtils*)this;
   partitioner->UseVolume(aTrack.GetVolume());
+  partitioner->SetSampling(aTrack);
+  G4CMPRandomStream::SetStream(aTrack, GetProcessSubType());
 
   G4double eKin = GetKineticEnergy(aTrack);
 
@@ -6,12 +6,15 @@
 // 20170620  M. Kelsey -- Follow interface changes in G4CMPSecondaryUtils
 // 20170802  M. Kelsey -- Replace phonon production with G4CMPEnergyPartition
 // 20180827  M. Kelsey -- Prevent partitioner from recomputing sampling factors
+// 20201025  Pass sampling factors from track to partitioner
+// 20201030  Select reproducible random stream for partitioning
 
 #include "G4CMPDriftRecombinationProcess.hh"
 #include "G4CMPConfigManager.hh"
 #include "G4CMPDriftElectron.hh"
 #include "G4CMPDriftHole.hh"
 #include "G4CMPEnergyPartition.hh"
+#include "G4CMPRandomStream.hh"
 #include "G4CMPSecondaryUtils.hh"
 #include "G4CMPUtils.hh"
 #include "G4LatticePhysical.hh"
@@ -25,7 +28,7 @@
 G4CMPDriftRecombinationProcess::
 G4CMPDriftRecombinationProcess(const G4String &name, G4CMPProcessSubType type)
   : G4CMPVDriftProcess(name, type), partitioner(new G4CMPEnergyPartition) {
-  partitioner->UseDownsampling(false);		// Apply preset scaling factors
+  partitioner->UseDownsampling(false);		// Apply track's scaling factors
 }
 
 G4CMPDriftRecombinationProcess::~G4CMPDriftRecombinationProcess() {
@@ -61,6 +64,8 @@ G4CMPDriftRecombinationProcess::PostStepDoIt(const G4Track& aTrack,
 
   *(G4CMPProcessUtils*)partitioner = *(G4CMPProcessUtils*)this;
   partitioner->UseVolume(aTrack.GetVolume());
+  partitioner->SetSampling(aTrack);
+  G4CMPRandomStream::SetStream(aTrack, GetProcessSubType());
 
   // FIXME: Each charge carrier is independent, so it only gives back 0.5 times
   // the band gap. Really electrons and holes should recombine, killing both
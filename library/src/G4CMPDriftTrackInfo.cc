@@ -12,12 +12,14 @@
 // $Id$
 //
 // 20161111 Initial commit - R. Agnese
+// 20201028 Use thread-local G4Allocator for memory management
 
 #include "G4CMPDriftTrackInfo.hh"
 #include "G4LatticePhysical.hh"
 #include "G4ParticleDefinition.hh"
 
-//G4Allocator<G4CMPDriftTrackInfo> G4CMPDriftTrackInfoAllocator;
+G4ThreadLocal
+G4Allocator<G4CMPDriftTrackInfo>* G4CMPDriftTrackInfoAllocator = 0;
 
 G4CMPDriftTrackInfo::G4CMPDriftTrackInfo(const G4LatticePhysical* lat,
                                          G4int valIdx) :
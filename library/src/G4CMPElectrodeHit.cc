@@ -3,6 +3,8 @@
  * License version 3 or later. See G4CMP/LICENSE for the full license. *
 \***********************************************************************/
 
+// 20201107  Store particle definition instead of name
+
 #include "G4CMPElectrodeHit.hh"
 
 #include "G4ios.hh"
@@ -12,6 +14,8 @@
 #include "G4AttDefStore.hh"
 #include "G4AttDef.hh"
 #include "G4AttValue.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleTable.hh"
 #include "G4UnitsTable.hh"
 #include "G4VisAttributes.hh"
 #include "G4SystemOfUnits.hh"
@@ -19,12 +23,23 @@
 
 G4ThreadLocal G4Allocator<G4CMPElectrodeHit> G4CMPElectrodeHitAllocator;
 
-G4CMPElectrodeHit::G4CMPElectrodeHit() {}
+G4CMPElectrodeHit::G4CMPElectrodeHit()
+  : startTime(0.), finalTime(0.), startE(0.), EDep(0.), weight(0.),
+    particle(0), trackID(0) {;}
 
 int G4CMPElectrodeHit::operator==(const G4CMPElectrodeHit &/*right*/) const {
   return 0;
 }
 
+void G4CMPElectrodeHit::SetParticleName(const G4String& name) {
+  particle = G4ParticleTable::GetParticleTable()->FindParticle(name);
+}
+
+const G4String& G4CMPElectrodeHit::GetParticleName() const {
+  static const G4String noName;
+  return particle ? particle->GetParticleName() : noName;
+}
+
 void G4CMPElectrodeHit::Draw() {
   G4VVisManager* pVVisManager = G4VVisManager::GetConcreteInstance();
   if(pVVisManager)
@@ -39,6 +39,22 @@
 // 20200316  Improve calculations of charge and phonon energy summaries
 // 20200328  Protect against invalid energy inputs
 // 20200805  Use electric field in volume to estimate Luke gain, sampling
+// 20201023  Draw downsampled number of charge pairs from binomial
+// 20201024  Draw downsampled phonon count and polarizations in bulk
+// 20201025  Keep downsampling factors locally, instead of in global config;
+//		pass factors to secondaries through track information.
+// 20201026  Use vector of vertices indexed by charge cloud bin
+// 20201027  Create secondaries with shared G4CMP::SecondaryContext
+// 20201030  Draw random numbers from per-thread G4CMPRandomStream
+// 20201031  Skip records below tracking thresholds before creating tracks;
+//		reuse track and primary buffers between calls.
+// 20201101  Adjust downsampling to per-event track budgets; record weights
+// 20201110  Only phonons are skipped (charges may be accelerated); their
+//		energy is recorded for deposit, as G4CMPTrackLimiter does.
+// 20201111  Fano noise drawn from stream; select event stream if no track;
+//		attach sampling factors to primaries with G4CMPPrimaryInfo.
+// 20201112  Create at most one batch of tracks per deposit; the remaining
+//		records are staged in G4CMPPendingTracks.
 
 #include "G4CMPEnergyPartition.hh"
 #include "G4CMPChargeCloud.hh"
@@ -49,11 +65,17 @@
 #include "G4CMPGeometryUtils.hh"
 #include "G4CMPPartitionData.hh"
 #include "G4CMPPartitionSummary.hh"
+#include "G4CMPPendingTracks.hh"
+#include "G4CMPPrimaryInfo.hh"
+#include "G4CMPRandomStream.hh"
 #include "G4CMPSecondaryUtils.hh"
+#include "G4CMPTrackUtils.hh"
+#include "G4CMPVTrackInfo.hh"
 #include "G4CMPUtils.hh"
 #include "G4VNIELPartition.hh"
 #include "G4DynamicParticle.hh"
 #include "G4Event.hh"
+#include "G4EventManager.hh"
 #include "G4HCofThisEvent.hh"
 #include "G4IonTable.hh"
 #include "G4LatticePhysical.hh"
@@ -66,13 +88,15 @@
 #include "G4PhysicalConstants.hh"
 #include "G4PrimaryParticle.hh"
 #include "G4PrimaryVertex.hh"
-#include "G4RandomDirection.hh"
 #include "G4RunManager.hh"
 #include "G4SDManager.hh"
+#include "G4SteppingManager.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4TrackingManager.hh"
 #include "G4VParticleChange.hh"
 #include "G4VPhysicalVolume.hh"
 #include "Randomize.hh"
+#include "CLHEP/Random/RandBinomial.hh"
 #include <cmath>
 #include <vector>
 
@@ -84,9 +108,10 @@ G4CMPEnergyPartition::G4CMPEnergyPartition(G4Material* mat,
   : G4CMPProcessUtils(), verboseLevel(G4CMPConfigManager::GetVerboseLevel()),
     fillSummaryData(false), material(mat), biasVoltage(0.), 
     holeFraction(0.5), nParticlesMinimum(10),
-    applyDownsampling(true), cloud(new G4CMPChargeCloud), nCharges(0),
+    applyDownsampling(true), phononSampling(-1.), chargeSampling(-1.),
+    lukeSampling(-1.), cloud(new G4CMPChargeCloud), nCharges(0),
     nPairs(0), chargeEnergyLeft(0.), nPhonons(0), phononEnergyLeft(0.),
-    summary(0) {
+    summary(0), skippedEnergy(0.) {
   SetLattice(lat);
 }
 
@@ -192,7 +217,7 @@ G4double G4CMPEnergyPartition::MeasuredChargeEnergy(G4double eTrue) const {
   if (verboseLevel>1) 
     G4cout << "Using sigma " << sigmaE/eV << " eV for Fano noise." << G4endl;
 
-  return G4RandGauss::shoot(eTrue, sigmaE);
+  return G4CMPRandomStream::Instance()->Gauss(eTrue, sigmaE);
 }
 
 
@@ -265,6 +290,9 @@ void G4CMPEnergyPartition::DoPartition(G4double eIon, G4double eNIEL) {
     return;
   }
 
+  // Primary generators call here without a track to select a stream
+  G4CMPRandomStream::SelectEventStream();
+
   particles.clear();		// Discard previous results
   nPairs = nPhonons = 0;
 
@@ -275,13 +303,26 @@ void G4CMPEnergyPartition::DoPartition(G4double eIon, G4double eNIEL) {
   summary->trueNIEL = eNIEL;
   summary->lindhardYield = eIon / (eIon+eNIEL);
 
-  // Apply downsampling if requested
-  if (applyDownsampling) ComputeDownsampling(eIon, eNIEL);
+  // Apply downsampling if requested, otherwise use preset factors
+  if (applyDownsampling) {
+    ResetSampling();
+    ComputeDownsampling(eIon, eNIEL);
+    ApplyTrackBudget(eIon, eNIEL);
+  }
 
   chargeEnergyLeft = 0.;
   GenerateCharges(eIon);
   GeneratePhonons(eNIEL + chargeEnergyLeft);
 
+  // Record weights of generated tracks, and count them against budget
+  size_t nGenPhonons = particles.size() - 2*nCharges;
+  summary->chargeWeight = nCharges>0 ? G4double(nPairs)/nCharges : 0.;
+  summary->phononWeight = nGenPhonons>0 ? G4double(nPhonons)/nGenPhonons : 0.;
+  summary->lukeSampling = GetLukeSampling();
+
+  G4CMPPartitionSummary::CountCharges(2*nCharges);
+  G4CMPPartitionSummary::CountPhonons(nGenPhonons);
+
   particles.shrink_to_fit();	// Reduce size to match generated particles
 
   if (verboseLevel) summary->Print();
@@ -299,6 +340,41 @@ NuclearRecoil(G4double energy, G4double Z, G4double A) {
 }
 
 
+// Downsampling factors for current energy deposit
+
+void G4CMPEnergyPartition::SetSampling(G4double phonon, G4double charge,
+				       G4double luke) {
+  phononSampling = phonon;
+  chargeSampling = charge;
+  lukeSampling = luke;
+}
+
+void G4CMPEnergyPartition::SetSampling(const G4Track& track) {
+  const G4CMPVTrackInfo* info = G4CMP::GetTrackInfo<G4CMPVTrackInfo>(track);
+  if (info) {
+    SetSampling(info->PhononSampling(), info->ChargeSampling(),
+		info->LukeSampling());
+  } else {
+    ResetSampling();
+  }
+}
+
+G4double G4CMPEnergyPartition::GetPhononSampling() const {
+  return (phononSampling<0. ? G4CMPConfigManager::GetGenPhonons()
+	  : phononSampling);
+}
+
+G4double G4CMPEnergyPartition::GetChargeSampling() const {
+  return (chargeSampling<0. ? G4CMPConfigManager::GetGenCharges()
+	  : chargeSampling);
+}
+
+G4double G4CMPEnergyPartition::GetLukeSampling() const {
+  return (lukeSampling<0. ? G4CMPConfigManager::GetLukeSampling()
+	  : lukeSampling);
+}
+
+
 // Generate charge carriers and phonons with maximum energy scaling
 
 void G4CMPEnergyPartition::ComputeDownsampling(G4double eIon, G4double eNIEL) {
@@ -311,25 +387,25 @@ void G4CMPEnergyPartition::ComputeDownsampling(G4double eIon, G4double eNIEL) {
   }
 
   // Compute phonon scaling factor only if not fully suppressed
-  if (G4CMPConfigManager::GetGenPhonons() > 0.) {
+  if (GetPhononSampling() > 0.) {
     G4double phononSamp = (eNIEL>samplingScale) ? samplingScale/eNIEL : 1.;
     if (verboseLevel>2)
       G4cout << " Downsample " << phononSamp << " primary phonons" << G4endl;
 
-    G4CMPConfigManager::SetGenPhonons(phononSamp);
+    phononSampling = phononSamp;
   }
 
   // Compute charge scaling factor only if not fully suppressed
-  if (G4CMPConfigManager::GetGenCharges() > 0.) {
+  if (GetChargeSampling() > 0.) {
     G4double chargeSamp = (eIon>samplingScale)? samplingScale/eIon : 1.;
     if (verboseLevel>2)
       G4cout << " Downsample " << chargeSamp << " primary charges" << G4endl;
     
-    G4CMPConfigManager::SetGenCharges(chargeSamp);
+    chargeSampling = chargeSamp;
   }
 
   // Compute Luke scaling factor only if not fully suppressed
-  if (G4CMPConfigManager::GetLukeSampling() > 0.) {
+  if (GetLukeSampling() > 0.) {
     // Estimate generated Luke phonon energy from bias and charge pairs
     G4double ePair = theLattice->GetPairProductionEnergy();
     G4double eLuke = (samplingScale/ePair)*fabs(biasVoltage)*eplus;
@@ -341,12 +417,61 @@ void G4CMPEnergyPartition::ComputeDownsampling(G4double eIon, G4double eNIEL) {
     if (verboseLevel>2)
       G4cout << " Downsample " << lukeSamp << " Luke-phonon emission" << G4endl;
     
-    G4CMPConfigManager::SetLukeSampling(lukeSamp);
+    lukeSampling = lukeSamp;
+  }
+}
+
+// Reduce sampling so that expected tracks fit in remainder of event budget
+
+void G4CMPEnergyPartition::ApplyTrackBudget(G4double eIon, G4double eNIEL) {
+  G4int chargeBudget = G4CMPConfigManager::GetChargeBudget();
+  G4int phononBudget = G4CMPConfigManager::GetPhononBudget();
+  if (chargeBudget <= 0 && phononBudget <= 0) return;	// Avoid extra work
+
+  // Each deposit may always produce a minimal sample
+  G4double nMinimum = std::max(nParticlesMinimum, 1);
+
+  // Expected number of e/h tracks, two per pair
+  G4double nCharge = 2.*eIon/theLattice->GetPairProductionEnergy()
+    * GetChargeSampling();
+
+  if (chargeBudget > 0 && nCharge > 0.) {
+    G4double nLeft = chargeBudget - G4CMPPartitionSummary::ChargesThisEvent();
+    nLeft = std::max(nLeft, nMinimum);
+
+    if (nCharge > nLeft) {
+      chargeSampling = GetChargeSampling() * nLeft/nCharge;
+      nCharge = nLeft;
+    }
+  }
+
+  // Primary phonons and Luke phonons from charges share phonon budget;
+  // each pair drifting across bias emits at least eV/Debye Luke phonons
+  G4double eDebye = theLattice->GetDebyeEnergy();
+  G4double nPhonon = eNIEL/eDebye * GetPhononSampling();
+  G4double nLuke = 0.5*nCharge * fabs(biasVoltage)*eplus/eDebye
+    * GetLukeSampling();
+
+  if (phononBudget > 0 && nPhonon+nLuke > 0.) {
+    G4double nLeft = phononBudget - G4CMPPartitionSummary::PhononsThisEvent();
+    nLeft = std::max(nLeft, nMinimum);
+
+    if (nPhonon+nLuke > nLeft) {
+      G4double scale = nLeft / (nPhonon+nLuke);
+      if (GetPhononSampling() > 0.) phononSampling = GetPhononSampling()*scale;
+      if (GetLukeSampling() > 0.) lukeSampling = GetLukeSampling()*scale;
+    }
+  }
+
+  if (verboseLevel>1) {
+    G4cout << "G4CMPEnergyPartition::ApplyTrackBudget: sampling phonons "
+	   << GetPhononSampling() << " charges " << GetChargeSampling()
+	   << " Luke " << GetLukeSampling() << G4endl;
   }
 }
 
 void G4CMPEnergyPartition::GenerateCharges(G4double energy) {
-  if (G4CMPConfigManager::GetGenCharges() <= 0.) return;	// Suppressed
+  if (GetChargeSampling() <= 0.) return;	// Suppressed
 
   if (verboseLevel)
     G4cout << " GenerateCharges " << energy/MeV << " MeV" << G4endl;
@@ -367,7 +492,7 @@ void G4CMPEnergyPartition::GenerateCharges(G4double energy) {
 
   // Only apply downsampling to sufficiently large statistics
   G4double scale = ((G4int)nPairs<=nParticlesMinimum ? 1.
-		    : G4CMPConfigManager::GetGenCharges());
+		    : GetChargeSampling());
 
   if (verboseLevel>1) {
     G4cout << " eMeas " << eMeas/MeV << " MeV => " << nPairs << " pairs"
@@ -378,34 +503,27 @@ void G4CMPEnergyPartition::GenerateCharges(G4double energy) {
   nCharges = 0;
   if (nPairs == 0) return;		// No charges could be produced
 
-  particles.reserve(particles.size() + int(2.2*scale*nPairs));	// 10% overhead
+  // Energy is used in full pair quanta, with final pair from bandgap
+  size_t nQuanta = std::floor(eMeas / ePair);
+  chargeEnergyLeft -= nQuanta*ePair;
+
+  G4bool bandPair = (chargeEnergyLeft > eBand);
+  if (bandPair) chargeEnergyLeft -= eBand;
 
   // For downsampling, ensure that there are sufficient charge pairs
+  // Surviving pairs are drawn directly, rather than one quantum at a time
+  size_t nFull = 0;
   while (nCharges < scale*nPairs) {
-    if (nCharges > 0)
-      particles.erase(particles.end()-2*nCharges, particles.end());
-
-    chargeEnergyLeft = eMeas;
-    nCharges = 0;
-
-    while (chargeEnergyLeft >= ePair) {
-      if (G4UniformRand()<scale) {	// Apply downsampling up front
-	AddChargePair(ePair);
-	nCharges++;
-      }
-
-      chargeEnergyLeft -= ePair;
-    }	// while (chargeEnergyLeft
-
-    if (chargeEnergyLeft > eBand) {  // Final charge pair from bandgap
-      AddChargePair(eBand);
-      nCharges++;
-      chargeEnergyLeft -= eBand;
-    }
+    nFull = (scale < 1. ? SampleSurvivors(nQuanta, scale) : nQuanta);
+    nCharges = nFull + (bandPair ? 1 : 0);
 
     if (verboseLevel>2)
       G4cout << " generated " << nCharges << " e-h pairs" << G4endl;
-  }	// while (nCharges==0
+  }	// while (nCharges < ...
+
+  particles.reserve(particles.size() + 2*nCharges);
+  for (size_t i=0; i<nFull; i++) AddChargePair(ePair);
+  if (bandPair) AddChargePair(eBand);	// Final charge pair from bandgap
 
   if (chargeEnergyLeft < 0.) chargeEnergyLeft = 0.;	// Avoid round-offs
 
@@ -419,18 +537,30 @@ void G4CMPEnergyPartition::GenerateCharges(G4double energy) {
 
 }
 
+// Number of quanta surviving downsampling, drawn in constant time
+
+size_t G4CMPEnergyPartition::SampleSurvivors(size_t nTotal,
+					     G4double scale) const {
+  if (nTotal == 0 || scale <= 0.) return 0;
+  if (scale >= 1.) return nTotal;
+
+  return (size_t)CLHEP::RandBinomial::shoot(G4CMPRandomStream::Instance(),
+					    (long)nTotal, scale);
+}
+
 void G4CMPEnergyPartition::AddChargePair(G4double ePair) {
   G4double eFree = ePair - theLattice->GetBandGapEnergy(); // TODO: Is this right?
+  G4CMPRandomStream* rng = G4CMPRandomStream::Instance();
 
-  particles.push_back(Data(G4CMPDriftElectron::Definition(),G4RandomDirection(),
-			   (1.-holeFraction)*eFree));
+  particles.push_back(Data(G4CMPDriftElectron::Definition(),
+			   rng->RandomDirection(), (1.-holeFraction)*eFree));
 
-  particles.push_back(Data(G4CMPDriftHole::Definition(), G4RandomDirection(),
-			   holeFraction*eFree));
+  particles.push_back(Data(G4CMPDriftHole::Definition(),
+			   rng->RandomDirection(), holeFraction*eFree));
 }
 
 void G4CMPEnergyPartition::GeneratePhonons(G4double energy) {
-  if (G4CMPConfigManager::GetGenPhonons() <= 0.) return;	// Suppressed
+  if (GetPhononSampling() <= 0.) return;	// Suppressed
   if (energy <= 0.) {				// Avoid unnecessary work
     nPhonons = 0;
     return;
@@ -446,43 +576,45 @@ void G4CMPEnergyPartition::GeneratePhonons(G4double energy) {
 
   // Only apply downsampling to sufficiently large statistics
   G4double scale = ((G4int)nPhonons<=nParticlesMinimum ? 1.
-		    : G4CMPConfigManager::GetGenPhonons());
+		    : GetPhononSampling());
 
   if (verboseLevel>1) {
     G4cout << " ePhon " << ePhon/eV << " eV => " << nPhonons << " phonons"
 	   << " downsample " << scale << G4endl;
   }
 
-  particles.reserve(particles.size() + int(1.1*scale*nPhonons)); // 10% overhead
-
   // For downsampling, ensure that there are sufficient phonons
-  G4double genEnergy = 0.;	// Energy sum without reweighting
+  // Surviving phonons are drawn directly, rather than one quantum at a time
   size_t nGenPhonons = 0;
   while (nGenPhonons < scale*nPhonons/2) {
-    if (nGenPhonons > 0)
-      particles.erase(particles.end()-nGenPhonons, particles.end());
+    nGenPhonons = SampleSurvivors(nPhonons, scale);
 
-    phononEnergyLeft = energy;
-    nGenPhonons = 0;
-    
-    while (phononEnergyLeft >= ePhon) {
-      if (G4UniformRand()<scale) {	// Apply downsampling up front
-	AddPhonon(ePhon);
-	genEnergy += ePhon;
-	nGenPhonons++;
-      }
-      
-      phononEnergyLeft -= ePhon;
-
-      if (phononEnergyLeft > 0 && phononEnergyLeft < ePhon)
-	phononEnergyLeft = ePhon;	// Correct for round-off issues
-    }	// while (phononEnergyLeft
-    
     if (verboseLevel>2)
       G4cout << " generated " << nGenPhonons << " phonons" << G4endl;
   }	// while (nGenPhonons
 
-  if (nGenPhonons == nPhonons+1) nPhonons++;	// Pick up residual phonon
+  phononEnergyLeft = 0.;		// All quanta are accounted for
+
+  // Split survivors among polarizations according to lattice DOS
+  G4double ldos  = theLattice->GetLDOS();
+  G4double stdos = theLattice->GetSTDOS();
+  G4double ftdos = theLattice->GetFTDOS();
+  G4double norm  = ldos + stdos + ftdos;
+
+  size_t nST = SampleSurvivors(nGenPhonons, stdos/norm);
+  size_t nFT = (ldos+ftdos > 0.) ? SampleSurvivors(nGenPhonons-nST,
+						     ftdos/(ldos+ftdos)) : 0;
+  size_t nL  = nGenPhonons - nST - nFT;
+
+  if (verboseLevel>2) {
+    G4cout << " " << nL << " L, " << nST << " ST, " << nFT << " FT phonons"
+	   << G4endl;
+  }
+
+  particles.reserve(particles.size() + nGenPhonons);
+  AddPhonons(G4PhononPolarization::Long, ePhon, nL);
+  AddPhonons(G4PhononPolarization::TransSlow, ePhon, nST);
+  AddPhonons(G4PhononPolarization::TransFast, ePhon, nFT);
 
   // Store generated information in summary block
   summary->phononGenerated = energy;
@@ -494,7 +626,17 @@ void G4CMPEnergyPartition::AddPhonon(G4double ePhon) {
   G4ParticleDefinition* pd =
     G4PhononPolarization::Get(ChoosePhononPolarization());
 
-  particles.push_back(Data(pd, G4RandomDirection(), ePhon));
+  particles.push_back(Data(pd, G4CMPRandomStream::Instance()->RandomDirection(),
+			   ePhon));
+}
+
+void G4CMPEnergyPartition::AddPhonons(G4int mode, G4double ePhon, size_t n) {
+  G4ParticleDefinition* pd = G4PhononPolarization::Get(mode);
+  G4CMPRandomStream* rng = G4CMPRandomStream::Instance();
+
+  for (size_t i=0; i<n; i++) {
+    particles.push_back(Data(pd, rng->RandomDirection(), ePhon));
+  }
 }
 
 
@@ -502,8 +644,17 @@ void G4CMPEnergyPartition::AddPhonon(G4double ePhon) {
 
 void G4CMPEnergyPartition::
 GetPrimaries(std::vector<G4PrimaryParticle*>& primaries) const {
+  FillPrimaries(primaries, particles.size());
+}
+
+// Create up to nMax primaries; return index of first record not used
+
+size_t G4CMPEnergyPartition::
+FillPrimaries(std::vector<G4PrimaryParticle*>& primaries, size_t nMax) const {
   if (verboseLevel) G4cout << "G4CMPEnergyPartition::GetPrimaries" << G4endl;
 
+  G4CMPRandomStream::SelectEventStream();	// Cloud positions use stream
+
   primaries.clear();
   primaries.reserve(particles.size());
 
@@ -514,10 +665,24 @@ GetPrimaries(std::vector<G4PrimaryParticle*>& primaries) const {
   G4double phononWt = nGenPhonons>0 ? G4double(nPhonons)/nGenPhonons : 0.;
   G4double chargeWt = nCharges>0 ? G4double(nPairs)/nCharges : 0.;
 
+  const G4double samples[3] = { GetPhononSampling(), GetChargeSampling(),
+				GetLukeSampling() };
+
+  // Phonons below tracking threshold would be killed by G4CMPTrackLimiter
+  // on their first step; their energy is recorded instead
+  G4double eMinPhonon = G4CMPConfigManager::GetMinPhononEnergy();
+  skippedEnergy = 0.;
+
   G4double weight = 0.;
   G4PrimaryParticle* thePrim = 0;
   for (size_t i=0; i<particles.size(); i++) {
+    if (primaries.size() >= nMax) return i;	// Remainder will be staged
+
     const Data& p = particles[i];	// For convenience below
+    if (G4CMP::IsPhonon(p.pd) && p.ekin < eMinPhonon) {
+      skippedEnergy += phononWt * p.ekin;
+      continue;
+    }
 
     // Set weight so that generated particles map back to expected true number
     weight = (G4CMP::IsPhonon(p.pd) ? phononWt : chargeWt);
@@ -529,6 +694,10 @@ GetPrimaries(std::vector<G4PrimaryParticle*>& primaries) const {
     thePrim->SetWeight(weight);
     primaries.push_back(thePrim);
 
+    // Primaries carry this deposit's sampling factors to G4CMPStackingAction
+    thePrim->SetUserInformation(new G4CMPPrimaryInfo(samples[0], samples[1],
+						     samples[2]));
+
     if (verboseLevel==3) {
       G4cout << i << " : " << p.pd->GetParticleName() << " " << p.ekin/eV
 	     << " eV along " << p.dir << " (w " << weight << ")"
@@ -538,6 +707,8 @@ GetPrimaries(std::vector<G4PrimaryParticle*>& primaries) const {
       thePrim->Print();
     }
   }
+
+  return particles.size();
 }
 
 // Return primary particles from partitioning directly into event
@@ -556,8 +727,12 @@ GetPrimaries(G4Event* event, const G4ThreeVector& pos, G4double time,
   summary->position[2] = pos[2];
   summary->position[3] = time;
 
-  std::vector<G4PrimaryParticle*> primaries;	// Can we make this mutable?
-  GetPrimaries(primaries);
+  // Particles beyond the batch size are tracked later, if possible
+  size_t nMax = (G4CMPPendingTracks::Enabled()
+		 ? G4CMPConfigManager::GetTrackBatch() : particles.size());
+
+  std::vector<G4PrimaryParticle*>& primaries = primaryBuffer;
+  size_t firstStaged = FillPrimaries(primaries, nMax);
 
   G4double chargeEtot = 0.;		// Cumulative buffers for diagnostics
   G4double phononEtot = 0.;
@@ -571,15 +746,17 @@ GetPrimaries(G4Event* event, const G4ThreeVector& pos, G4double time,
     cloud->Generate(nCharges, pos);
   }
 
-  // Buffer for active vertices, for use with charge cloud
-  std::map<G4int, G4PrimaryVertex*> activeVtx;
+  // Buffer for active vertices, indexed by charge cloud bin (last for -1)
+  std::vector<G4PrimaryVertex*> activeVtx(doCloud ? cloud->GetNumberOfBins()+1
+					  : 1, nullptr);
 
   G4int ichg = 0;		// Counter to track charge cloud entries
   for (size_t i=0; i<primaries.size(); i++) {
     G4bool qcloud = doCloud && !G4CMP::IsPhonon(primaries[i]->GetG4code());
     G4int chgbin = qcloud ? cloud->GetPositionBin(ichg++) : -1;
 
-    G4PrimaryVertex*& vertex = activeVtx[chgbin];	// Ref for convenience
+    size_t ivtx = (chgbin>=0 ? chgbin : activeVtx.size()-1);
+    G4PrimaryVertex*& vertex = activeVtx[ivtx];	// Ref for convenience
 
     // Create new vertex at pos if needed, or if current one is full
     if (!vertex ||
@@ -607,6 +784,15 @@ GetPrimaries(G4Event* event, const G4ThreeVector& pos, G4double time,
 	   << " in " << event->GetNumberOfPrimaryVertex() << " vertices"
            << G4endl;
   }
+
+  primaries.clear();		// Particles are now owned by the event
+
+  if (firstStaged < particles.size()) {
+    StageRecords(firstStaged, G4CMP::CreateTouchableAtPoint(pos), pos, time,
+		 1., 0);
+  }
+
+  summary->phononSkipped = skippedEnergy;
 }
 
 G4PrimaryVertex* 
@@ -623,6 +809,14 @@ G4CMPEnergyPartition::CreateVertex(G4Event* evt, const G4ThreeVector& pos,
 
 void G4CMPEnergyPartition::
 GetSecondaries(std::vector<G4Track*>& secondaries, G4double trkWeight) const {
+  FillSecondaries(secondaries, trkWeight, particles.size());
+}
+
+// Create up to nMax secondaries; return index of first record not used
+
+size_t G4CMPEnergyPartition::
+FillSecondaries(std::vector<G4Track*>& secondaries, G4double trkWeight,
+		size_t nMax) const {
   if (verboseLevel) {
     G4cout << "G4CMPEnergyPartition::GetSecondaries, parent weight "
 	   << trkWeight << G4endl;
@@ -653,23 +847,54 @@ GetSecondaries(std::vector<G4Track*>& secondaries, G4double trkWeight) const {
   G4double phononWt = nGenPhonons>0 ? G4double(nPhonons)/nGenPhonons : 0.;
   G4double chargeWt = nCharges>0 ? G4double(nPairs)/nCharges : 0.;
 
+  const G4double samples[3] = { GetPhononSampling(), GetChargeSampling(),
+				GetLukeSampling() };
+
+  // All secondaries share volume, lattice and parent position
+  const G4Track* parent = GetCurrentTrack();
+  const G4CMP::SecondaryContext context(GetCurrentTouchable(),
+					parent->GetPosition());
+
+  // Phonons below tracking threshold would be killed by G4CMPTrackLimiter
+  // on their first step; their energy is recorded instead
+  G4double eMinPhonon = G4CMPConfigManager::GetMinPhononEnergy();
+  skippedEnergy = 0.;
+
   G4double weight = 0.;
   G4Track* theSec = 0;
   G4int ichg = 0;			// Index to deal with charge cloud
 
-  for (size_t i=0; i<particles.size(); i++) {
+  size_t i = 0;
+  for (; i<particles.size(); i++) {
+    if (secondaries.size() >= nMax) break;	// Remainder will be staged
+
     const Data& p = particles[i];	// For convenience below
 
+    // Cloud positions are assigned in order, even to failed charges
+    G4int icloud = (doCloud && G4CMP::IsChargeCarrier(p.pd)) ? ichg++ : -1;
+    if (G4CMP::IsPhonon(p.pd) && p.ekin < eMinPhonon) {
+      skippedEnergy += phononWt * p.ekin;
+      continue;
+    }
+
     // Set weights so that generated particles map back to expected true number
     weight = (G4CMP::IsPhonon(p.pd) ? phononWt : chargeWt);
 
-    theSec = G4CMP::CreateSecondary(*GetCurrentTrack(), p.pd, p.dir, p.ekin);
+    theSec = G4CMP::CreateSecondary(context, p.pd, p.dir, p.ekin,
+				    parent->GetGlobalTime(),
+				    parent->GetPosition());
+    if (!theSec) continue;
+
     theSec->SetWeight(trkWeight*weight);
     secondaries.push_back(theSec);
 
+    // Secondaries carry this deposit's sampling factors for later use
+    G4CMP::GetTrackInfo<G4CMPVTrackInfo>(*theSec)->SetSampling(samples[0],
+							       samples[1],
+							       samples[2]);
+
     // Adjust positions of charges according to generated distribution
-    if (doCloud && G4CMP::IsChargeCarrier(theSec))
-      theSec->SetPosition(cloud->GetPosition(ichg++));
+    if (icloud >= 0) theSec->SetPosition(cloud->GetPosition(icloud));
 
     if (verboseLevel==3) {
       G4cout << i << " : " << p.pd->GetParticleName() << " " << p.ekin/eV
@@ -681,7 +906,10 @@ GetSecondaries(std::vector<G4Track*>& secondaries, G4double trkWeight) const {
     }
   }
 
-  secondaries.shrink_to_fit();		// Reduce footprint if biasing done
+  if (secondaries.capacity() > 2*secondaries.size())
+    secondaries.shrink_to_fit();	// Reduce footprint if biasing done
+
+  return i;
 }
 
 // Return secondary particles from partitioning directly into event
@@ -693,8 +921,27 @@ GetSecondaries(G4VParticleChange* aParticleChange) const {
 	   << G4endl;
   }
 
-  std::vector<G4Track*> secondaries;	// Can we make this a mutable buffer?
-  GetSecondaries(secondaries, aParticleChange->GetWeight());
+  // Particles beyond the batch size are tracked later, if possible
+  size_t nMax = (G4CMPPendingTracks::Enabled()
+		 ? G4CMPConfigManager::GetTrackBatch() : particles.size());
+
+  std::vector<G4Track*>& secondaries = secondaryBuffer;
+  size_t firstStaged = FillSecondaries(secondaries, aParticleChange->GetWeight(),
+				       nMax);
+
+  if (firstStaged < particles.size()) {
+    const G4Track* parent = GetCurrentTrack();
+    StageRecords(firstStaged, parent->GetTouchableHandle(),
+		 parent->GetPosition(), parent->GetGlobalTime(),
+		 aParticleChange->GetWeight(), parent);
+  }
+
+  // Untracked phonons deposit locally; if there are no secondaries at
+  // all, callers deposit the whole energy themselves
+  if (!secondaries.empty() && skippedEnergy > 0.) {
+    aParticleChange->ProposeNonIonizingEnergyDeposit(
+      aParticleChange->GetNonIonizingEnergyDeposit() + skippedEnergy);
+  }
 
   aParticleChange->SetNumberOfSecondaries(secondaries.size());
   aParticleChange->SetSecondaryWeightByProcess(true);
@@ -705,3 +952,69 @@ GetSecondaries(G4VParticleChange* aParticleChange) const {
   }
 }
 
+
+// Hand records from "first" on to G4CMPPendingTracks, to be tracked once
+// the tracks already created are finished.  Primaries have no parent.
+
+void G4CMPEnergyPartition::
+StageRecords(size_t first, const G4TouchableHandle& touch,
+	     const G4ThreeVector& pos, G4double time, G4double trkWeight,
+	     const G4Track* parent) const {
+  if (verboseLevel>1) {
+    G4cout << " staging " << particles.size()-first << " of "
+	   << particles.size() << " particles" << G4endl;
+  }
+
+  // Get number of generated phonons to compute weight below
+  size_t nGenPhonons = particles.size() - 2*nCharges;
+  G4double phononWt = nGenPhonons>0 ? G4double(nPhonons)/nGenPhonons : 0.;
+  G4double chargeWt = nCharges>0 ? G4double(nPairs)/nCharges : 0.;
+
+  const G4double samples[3] = { GetPhononSampling(), GetChargeSampling(),
+				GetLukeSampling() };
+
+  // Secondaries are attributed to the process currently being invoked
+  G4int parentID = parent ? parent->GetTrackID() : 0;
+  const G4VProcess* creator = 0;
+  if (parent) {
+    creator = G4EventManager::GetEventManager()->GetTrackingManager()
+      ->GetSteppingManager()->GetfCurrentProcess();
+  }
+
+  G4CMPPendingTracks::NewDeposit(touch, pos, time, trkWeight*phononWt,
+				 trkWeight*chargeWt, samples, parentID,
+				 creator);
+
+  // Charge cloud positions continue from those assigned to created tracks
+  G4bool doCloud = G4CMPConfigManager::CreateChargeCloud();	// Convenience
+  G4int ichg = 0;
+  if (doCloud) {
+    for (size_t i=0; i<first; i++) {
+      if (G4CMP::IsChargeCarrier(particles[i].pd)) ichg++;
+    }
+  }
+
+  G4double eMinPhonon = G4CMPConfigManager::GetMinPhononEnergy();
+
+  for (size_t i=first; i<particles.size(); i++) {
+    const Data& p = particles[i];	// For convenience below
+
+    // Primaries share vertex at cloud bin center, secondaries are spread
+    G4ThreeVector ppos = pos;
+    if (doCloud && G4CMP::IsChargeCarrier(p.pd)) {
+      G4int icloud = ichg++;
+      if (parent) ppos = cloud->GetPosition(icloud);
+      else {
+	G4int chgbin = cloud->GetPositionBin(icloud);
+	if (chgbin >= 0) ppos = cloud->GetBinCenter(chgbin);
+      }
+    }
+
+    if (G4CMP::IsPhonon(p.pd) && p.ekin < eMinPhonon) {
+      skippedEnergy += phononWt * p.ekin;
+      continue;
+    }
+
+    G4CMPPendingTracks::Add(p.pd, p.dir, p.ekin, ppos);
+  }
+}
@@ -0,0 +1,135 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/src/G4CMPHitReader.cc
+/// \brief Implementation of the G4CMPHitReader class, for reading binary
+///	hit files written by G4CMPHitWriter.
+//
+// $Id$
+//
+// 20201105  New class for binary hit input
+// 20201106  Move block definition to G4CMPHitWriter.hh, for merging
+
+#include "G4CMPHitReader.hh"
+#include <cstring>
+#include <ostream>
+
+
+// Constructor
+
+G4CMPHitReader::G4CMPHitReader(const G4String& name) {
+  if (!name.empty()) Open(name);
+}
+
+
+// Open file and validate header
+
+G4bool G4CMPHitReader::Open(const G4String& name) {
+  if (input.is_open()) input.close();
+  input.clear();
+  particleNames.clear();
+
+  fileName = name;
+  input.open(fileName, std::ios::binary);
+  if (!input.good()) {
+    G4ExceptionDescription msg;
+    msg << "Error opening input file " << fileName;
+    G4Exception("G4CMPHitReader::Open", "Hits003", JustWarning, msg);
+    return false;
+  }
+
+  char magic[sizeof(G4CMPHitWriter::Magic)];
+  uint32_t version = 0, byteOrder = 0;
+  input.read(magic, sizeof(magic));
+  Read(version);
+  Read(byteOrder);
+
+  if (!input.good() ||
+      std::memcmp(magic, G4CMPHitWriter::Magic, sizeof(magic)) != 0 ||
+      version != G4CMPHitWriter::Version ||
+      byteOrder != G4CMPHitWriter::ByteOrder) {
+    G4ExceptionDescription msg;
+    msg << fileName << " is not a G4CMP hit file, or was written with"
+	<< " a different format version or byte order.";
+    G4Exception("G4CMPHitReader::Open", "Hits004", JustWarning, msg);
+    input.close();
+    return false;
+  }
+
+  return true;
+}
+
+
+// Fill next event block from file
+
+G4bool G4CMPHitReader::ReadBlock(Block& block) {
+  if (!input.is_open()) return false;
+
+  int32_t runID = 0, eventID = 0;
+  uint32_t nHits = 0, nNames = 0;
+  if (!Read(runID)) return false;		// Normal end of file
+
+  if (!(Read(eventID) && Read(nHits) && Read(nNames))) {
+    G4Exception("G4CMPHitReader::ReadBlock", "Hits005", JustWarning,
+		"Truncated event block header.");
+    return false;
+  }
+
+  for (uint32_t i=0; i<nNames; i++) {
+    uint16_t code = 0, length = 0;
+    Read(code);
+    Read(length);
+
+    std::string name(length, ' ');
+    if (length > 0) input.read(&name[0], length);
+
+    if (code >= particleNames.size()) particleNames.resize(code+1);
+    particleNames[code] = name;
+  }
+
+  block.runID = runID;
+  block.eventID = eventID;
+  block.Resize(nHits);
+
+  G4bool good = ReadColumn(block.trackID) && ReadColumn(block.particle);
+  for (G4int i=0; good && i<G4CMPHitWriter::NumColumns; i++) {
+    good = ReadColumn(block.column[i]);
+  }
+
+  if (!good) {
+    G4Exception("G4CMPHitReader::ReadBlock", "Hits005", JustWarning,
+		"Truncated event block data.");
+  }
+
+  return good;
+}
+
+const G4String& G4CMPHitReader::ParticleName(uint16_t code) const {
+  static const G4String unknown = "unknown";
+  return (code < particleNames.size() ? particleNames[code] : unknown);
+}
+
+
+// Export in same layout as examples' CSV hit files
+
+void G4CMPHitReader::WriteCSVHeader(std::ostream& os) {
+  const std::vector<G4String>& titles = G4CMPHitWriter::ColumnTitles();
+  for (size_t i=0; i<titles.size(); i++) {
+    os << (i>0 ? "," : "") << titles[i];
+  }
+  os << '\n';
+}
+
+void G4CMPHitReader::WriteCSV(std::ostream& os, const Block& block) const {
+  for (size_t ihit=0; ihit<block.nHits; ihit++) {
+    os << block.runID << ',' << block.eventID << ','
+       << block.trackID[ihit] << ',' << ParticleName(block.particle[ihit]);
+
+    for (G4int i=0; i<G4CMPHitWriter::NumColumns; i++) {
+      os << ',' << block.column[i][ihit];
+    }
+    os << '\n';
+  }
+}
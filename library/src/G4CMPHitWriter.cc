@@ -0,0 +1,308 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/src/G4CMPHitWriter.cc
+/// \brief Implementation of the G4CMPHitWriter class, buffered binary
+///	output of G4CMPElectrodeHitsCollection.
+//
+// $Id$
+//
+// 20201105  New class for binary hit output
+// 20201106  Add per-thread file names, block copying, and ordered merge
+// 20201107  Look up hit particle codes by definition pointer
+
+#include "G4CMPHitWriter.hh"
+#include "G4CMPHitReader.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+#include <limits>
+#include <sstream>
+
+
+// File format identification
+
+const char G4CMPHitWriter::Magic[8] = { 'G','4','C','M','P','H','I','T' };
+const uint32_t G4CMPHitWriter::Version = 1;
+const uint32_t G4CMPHitWriter::ByteOrder = 0x01020304;
+
+const std::vector<G4String>& G4CMPHitWriter::ColumnTitles() {
+  static const std::vector<G4String> titles = {
+    "Run ID", "Event ID", "Track ID", "Particle Name", "Start Energy [eV]",
+    "Start X [m]", "Start Y [m]", "Start Z [m]", "Start Time [ns]",
+    "Energy Deposited [eV]", "Track Weight", "End X [m]", "End Y [m]",
+    "End Z [m]", "Final Time [ns]"
+  };
+
+  return titles;
+}
+
+G4bool G4CMPHitWriter::IsBinaryName(const G4String& name) {
+  static const G4String suffix = ".bin";
+  return (name.size() > suffix.size() &&
+	  name.compare(name.size()-suffix.size(), suffix.size(), suffix) == 0);
+}
+
+
+// Per-thread output files, distinguished by thread ID
+
+G4String G4CMPHitWriter::ThreadFileName(const G4String& name) {
+  return ThreadFileName(name, G4Threading::G4GetThreadId());
+}
+
+G4String G4CMPHitWriter::ThreadFileName(const G4String& name,
+					G4int threadID) {
+  if (threadID < 0) return name;
+
+  std::ostringstream tag;
+  tag << "_t" << threadID;
+
+  // Extension is only after last directory separator
+  size_t dot = name.rfind('.');
+  size_t slash = name.rfind('/');
+  if (dot == std::string::npos || dot == 0 ||
+      (slash != std::string::npos && dot < slash)) {
+    return name + tag.str();
+  }
+
+  return name.substr(0, dot) + tag.str() + name.substr(dot);
+}
+
+
+// Constructor and destructor
+
+G4CMPHitWriter::G4CMPHitWriter(const G4String& name, size_t flushBytes)
+  : flushSize(flushBytes) {
+  if (!name.empty()) Open(name);
+}
+
+G4CMPHitWriter::~G4CMPHitWriter() {
+  Close();
+}
+
+
+// Start new file, with header, and reset particle codes
+
+void G4CMPHitWriter::Open(const G4String& name) {
+  Close();
+
+  fileName = name;
+  output.open(fileName, std::ios::binary|std::ios::trunc);
+  if (!output.good()) {
+    G4ExceptionDescription msg;
+    msg << "Error opening output file " << fileName;
+    G4Exception("G4CMPHitWriter::Open", "Hits001", FatalException, msg);
+    return;
+  }
+
+  particleCodes.clear();
+  particleNames.clear();
+  definitionCodes.clear();
+
+  output.write(Magic, sizeof(Magic));
+  output.write(reinterpret_cast<const char*>(&Version), sizeof(Version));
+  output.write(reinterpret_cast<const char*>(&ByteOrder), sizeof(ByteOrder));
+}
+
+void G4CMPHitWriter::Close() {
+  if (!output.is_open()) return;
+
+  Flush();
+  output.close();
+
+  if (!output.good()) {
+    G4cerr << "Error closing output file, " << fileName << ".\n"
+	   << "Expect bad things like loss of data." << G4endl;
+  }
+}
+
+
+// Serialize event as one block, with columns in fixed order
+
+void G4CMPHitWriter::Write(G4int runID, G4int eventID,
+			   const G4CMPElectrodeHitsCollection* hits) {
+  if (!output.is_open() || !hits) return;
+
+  const std::vector<G4CMPElectrodeHit*>& hitVec = *hits->GetVector();
+
+  // Assign particle codes first, so that new names precede the columns
+  size_t nOldNames = particleNames.size();
+
+  hitCodes.clear();
+  for (const G4CMPElectrodeHit* hit: hitVec) {
+    hitCodes.push_back(ParticleCode(hit->GetParticle()));
+  }
+
+  AppendHeader(runID, eventID, hitVec.size(), nOldNames);
+
+  for (const G4CMPElectrodeHit* hit: hitVec) {
+    Append<int32_t>(hit->GetTrackID());
+  }
+
+  for (const uint16_t& code: hitCodes) Append(code);
+
+  for (G4int col=0; col<NumColumns; col++) {
+    AppendColumn(hitVec, HitColumn(col));
+  }
+
+  if (buffer.size() >= flushSize) Flush();
+}
+
+// Copy event from another file, translating its particle codes
+
+void G4CMPHitWriter::Write(const G4CMPHitBlock& block,
+			   const std::vector<G4String>& names) {
+  if (!output.is_open()) return;
+
+  size_t nOldNames = particleNames.size();
+
+  inputCodes.clear();
+  for (const G4String& name: names) inputCodes.push_back(ParticleCode(name));
+
+  hitCodes.clear();
+  for (const uint16_t& code: block.particle) {
+    hitCodes.push_back(code < inputCodes.size() ? inputCodes[code]
+		       : ParticleCode("unknown"));
+  }
+
+  AppendHeader(block.runID, block.eventID, block.nHits, nOldNames);
+
+  for (const G4int& id: block.trackID) Append<int32_t>(id);
+  for (const uint16_t& code: hitCodes) Append(code);
+
+  for (G4int col=0; col<NumColumns; col++) {
+    const std::vector<G4double>& values = block.column[col];
+    const char* bytes = reinterpret_cast<const char*>(values.data());
+    buffer.insert(buffer.end(), bytes, bytes+values.size()*sizeof(G4double));
+  }
+
+  if (buffer.size() >= flushSize) Flush();
+}
+
+
+// Combine per-thread files; blocks are taken from whichever input has
+// the earliest (run, event), so result does not depend on thread timing
+
+void G4CMPHitWriter::Merge(const std::vector<G4String>& inputs) {
+  if (!output.is_open()) return;
+
+  const size_t nInputs = inputs.size();
+  std::vector<G4CMPHitReader*> readers(nInputs, 0);
+  std::vector<G4CMPHitBlock> blocks(nInputs);
+  std::vector<G4bool> valid(nInputs, false);
+
+  for (size_t i=0; i<nInputs; i++) {
+    readers[i] = new G4CMPHitReader;
+    valid[i] = (readers[i]->Open(inputs[i]) &&
+		readers[i]->ReadBlock(blocks[i]));
+  }
+
+  while (true) {
+    size_t next = nInputs;
+    for (size_t i=0; i<nInputs; i++) {
+      if (valid[i] && (next == nInputs || blocks[i].Precedes(blocks[next])))
+	next = i;
+    }
+
+    if (next == nInputs) break;		// All inputs exhausted
+
+    Write(blocks[next], readers[next]->ParticleNames());
+    valid[next] = readers[next]->ReadBlock(blocks[next]);
+  }
+
+  for (size_t i=0; i<nInputs; i++) delete readers[i];
+
+  Flush();
+}
+
+
+// Run and event IDs, hit count, and any particle names new to this file
+
+void G4CMPHitWriter::AppendHeader(G4int runID, G4int eventID, size_t nHits,
+				  size_t firstNewName) {
+  Append<int32_t>(runID);
+  Append<int32_t>(eventID);
+  Append<uint32_t>(nHits);
+  Append<uint32_t>(particleNames.size()-firstNewName);
+
+  for (size_t i=firstNewName; i<particleNames.size(); i++) {
+    const G4String& name = particleNames[i];
+    Append<uint16_t>(i);
+    Append<uint16_t>(name.size());
+    buffer.insert(buffer.end(), name.begin(), name.end());
+  }
+}
+
+void G4CMPHitWriter::AppendColumn(const std::vector<G4CMPElectrodeHit*>& hits,
+				  HitColumn column) {
+  for (const G4CMPElectrodeHit* hit: hits) {
+    G4double value = 0.;
+    switch (column) {
+    case StartEnergy:   value = hit->GetStartEnergy()/eV; break;
+    case StartX:        value = hit->GetStartPosition().x()/m; break;
+    case StartY:        value = hit->GetStartPosition().y()/m; break;
+    case StartZ:        value = hit->GetStartPosition().z()/m; break;
+    case StartTime:     value = hit->GetStartTime()/ns; break;
+    case EnergyDeposit: value = hit->GetEnergyDeposit()/eV; break;
+    case Weight:        value = hit->GetWeight(); break;
+    case FinalX:        value = hit->GetFinalPosition().x()/m; break;
+    case FinalY:        value = hit->GetFinalPosition().y()/m; break;
+    case FinalZ:        value = hit->GetFinalPosition().z()/m; break;
+    case FinalTime:     value = hit->GetFinalTime()/ns; break;
+    default: break;
+    }
+
+    Append(value);
+  }
+}
+
+void G4CMPHitWriter::Flush() {
+  if (!output.is_open() || buffer.empty()) return;
+
+  output.write(buffer.data(), buffer.size());
+  buffer.clear();
+}
+
+
+// Look up particle name, assigning next code if not yet seen
+
+uint16_t G4CMPHitWriter::ParticleCode(const G4String& name) {
+  auto known = particleCodes.find(name);
+  if (known != particleCodes.end()) return known->second;
+
+  if (particleNames.size() > std::numeric_limits<uint16_t>::max()) {
+    G4Exception("G4CMPHitWriter::ParticleCode", "Hits002", FatalException,
+		"Too many distinct particle names for output file.");
+  }
+
+  uint16_t code = particleNames.size();
+  particleCodes[name] = code;
+  particleNames.push_back(name);
+
+  return code;
+}
+
+// Hits carry their particle definition, so names are only compared once
+// per distinct particle
+
+uint16_t G4CMPHitWriter::ParticleCode(const G4ParticleDefinition* pd) {
+  auto known = definitionCodes.find(pd);
+  if (known != definitionCodes.end()) return known->second;
+
+  uint16_t code = ParticleCode(pd ? pd->GetParticleName() : G4String(""));
+  definitionCodes[pd] = code;
+
+  return code;
+}
+
+
+// Event block storage
+
+void G4CMPHitBlock::Resize(size_t n) {
+  nHits = n;
+  trackID.resize(n);
+  particle.resize(n);
+  for (G4int i=0; i<G4CMPHitWriter::NumColumns; i++) column[i].resize(n);
+}
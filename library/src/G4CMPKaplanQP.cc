@@ -23,30 +23,64 @@
 // 20200629  G4CMP-217: QPs below lowQPLimit should radiate phonon energy
 //		down to gapEnergy before absorption.  Encapsulate this in
 //		a function.
+// 20201102  Replace flat-envelope rejection in *EnergyRand() with exact
+//		samplers, using substitutions which remove singularities.
+// 20201103  Keep per-thread instance for each film properties table in
+//		KaplanPhononQP(); validate table once, precompute constants.
+// 20201104  Replace per-generation temporary vectors with reusable member
+//		buffers; add summary-only AbsorbPhonon() and KaplanPhononQP().
 
 #include "globals.hh"
 #include "G4CMPKaplanQP.hh"
 #include "G4CMPConfigManager.hh"
 #include "G4MaterialPropertiesTable.hh"
+#include "G4PhysicalConstants.hh"
 #include "G4SystemOfUnits.hh"
 #include "Randomize.hh"
+#include <algorithm>
+#include <cmath>
+#include <map>
 #include <numeric>
 
 
+// Reusable factory classes, configured once for each film's properties
+
+namespace {
+  G4CMPKaplanQP* GetKaplanQP(G4MaterialPropertiesTable* prop) {
+    typedef std::map<G4MaterialPropertiesTable*, G4CMPKaplanQP*> KaplanMap;
+    static G4ThreadLocal KaplanMap* theKaplanQPs = 0;
+    static G4ThreadLocal G4CMPKaplanQP* theKaplanQP = 0;
+
+    if (!theKaplanQPs) theKaplanQPs = new KaplanMap;
+
+    // Consecutive absorptions are usually in the same film; skip lookup
+    if (!theKaplanQP || theKaplanQP->GetFilmProperties() != prop) {
+      G4CMPKaplanQP*& kaplan = (*theKaplanQPs)[prop];
+      if (!kaplan) kaplan = new G4CMPKaplanQP(prop);
+      theKaplanQP = kaplan;
+    }
+
+    // TEMPORARY:  Set verbosity using the global value
+    theKaplanQP->SetVerboseLevel(G4CMPConfigManager::GetVerboseLevel());
+
+    return theKaplanQP;
+  }
+}
+
+
 // Global function for Kaplan quasiparticle downconversion.  Retained here
 // temporarily for migration to factory class
 
 G4double G4CMP::KaplanPhononQP(G4double energy,
                                G4MaterialPropertiesTable* prop,
                                std::vector<G4double>& reflectedEnergies) {
-  // Reusable factory class, which can be reconfigured on each call
-  static G4ThreadLocal G4CMPKaplanQP* theKaplanQP = new G4CMPKaplanQP(prop);
-  theKaplanQP->SetFilmProperties(prop);
-
-  // TEMPORARY:  Set verbosity using the global value
-  theKaplanQP->SetVerboseLevel(G4CMPConfigManager::GetVerboseLevel());
+  return GetKaplanQP(prop)->AbsorbPhonon(energy, reflectedEnergies);
+}
 
-  return theKaplanQP->AbsorbPhonon(energy, reflectedEnergies);
+G4double G4CMP::KaplanPhononQP(G4double energy,
+                               G4MaterialPropertiesTable* prop,
+                               G4CMPKaplanQP::Summary& summary) {
+  return GetKaplanQP(prop)->AbsorbPhonon(energy, summary);
 }
 
 
@@ -55,7 +89,8 @@ G4double G4CMP::KaplanPhononQP(G4double energy,
 G4CMPKaplanQP::G4CMPKaplanQP(G4MaterialPropertiesTable* prop, G4int vb)
   : verboseLevel(vb), filmProperties(0), filmThickness(0.), gapEnergy(0.),
     lowQPLimit(3.), subgapAbsorption(0.), phononLifetime(0.),
-    phononLifetimeSlope(0.), vSound(0.) {
+    phononLifetimeSlope(0.), vSound(0.), gapSquared(0.), lowQPEnergy(0.),
+    escapeScale(0.) {
   SetFilmProperties(prop);
 }
 
@@ -67,6 +102,8 @@ void G4CMPKaplanQP::SetFilmProperties(G4MaterialPropertiesTable* prop) {
                 RunMustBeAborted, "Null MaterialPropertiesTable vector.");
   }
 
+  if (filmProperties == prop) return;		// Already configured
+
   // Check that the MaterialPropertiesTable has everything we need. If it came
   // from a G4CMPSurfaceProperty, then it will be fine.
   if (!(prop->ConstPropertyExists("gapEnergy") &&
@@ -80,21 +117,24 @@ void G4CMPKaplanQP::SetFilmProperties(G4MaterialPropertiesTable* prop) {
   }
 
   // Extract values from table here for convenience in functions
-  if (filmProperties != prop) {
-    filmThickness =       prop->GetConstProperty("filmThickness");
-    gapEnergy =           prop->GetConstProperty("gapEnergy");
-    phononLifetime =      prop->GetConstProperty("phononLifetime");
-    phononLifetimeSlope = prop->GetConstProperty("phononLifetimeSlope");
-    vSound =              prop->GetConstProperty("vSound");
+  filmThickness =       prop->GetConstProperty("filmThickness");
+  gapEnergy =           prop->GetConstProperty("gapEnergy");
+  phononLifetime =      prop->GetConstProperty("phononLifetime");
+  phononLifetimeSlope = prop->GetConstProperty("phononLifetimeSlope");
+  vSound =              prop->GetConstProperty("vSound");
 
-    lowQPLimit =       (prop->ConstPropertyExists("lowQPLimit")
-			? prop->GetConstProperty("lowQPLimit") : 3.);
+  lowQPLimit =       (prop->ConstPropertyExists("lowQPLimit")
+		      ? prop->GetConstProperty("lowQPLimit") : 3.);
 
-    subgapAbsorption = (prop->ConstPropertyExists("subgapAbsorption")
-			? prop->GetConstProperty("subgapAbsorption") : 0.);
+  subgapAbsorption = (prop->ConstPropertyExists("subgapAbsorption")
+		      ? prop->GetConstProperty("subgapAbsorption") : 0.);
 
-    filmProperties = prop;
-  }
+  // Energy-independent terms used by samplers and escape probability
+  gapSquared = gapEnergy*gapEnergy;
+  lowQPEnergy = lowQPLimit*gapEnergy;
+  escapeScale = 2.*filmThickness / (vSound*phononLifetime);
+
+  filmProperties = prop;
 }
 
 
@@ -139,8 +179,11 @@ AbsorbPhonon(G4double energy, std::vector<G4double>& reflectedEnergies) const {
   // quasiparticles, new phonons, and absorbed energy
   G4double EDep = 0.;
 
-  std::vector<G4double> qpEnergies;
-  std::vector<G4double> phonEnergies{energy};
+  std::vector<G4double>& qpEnergies = qpBuffer;
+  std::vector<G4double>& phonEnergies = phonBuffer;
+  qpEnergies.clear();
+  phonEnergies.assign(1, energy);
+
   while (qpEnergies.size() > 0 || phonEnergies.size() > 0) {
     if (phonEnergies.size() > 0) {
       // Partition the phonons' energies into quasi-particles according to
@@ -174,6 +217,20 @@ AbsorbPhonon(G4double energy, std::vector<G4double>& reflectedEnergies) const {
   return EDep;
 }
 
+// Summary-only absorption: re-emitted phonons are histogrammed and dropped
+
+G4double G4CMPKaplanQP::AbsorbPhonon(G4double energy,
+				     Summary& summary) const {
+  reflectBuffer.clear();
+  G4double EDep = AbsorbPhonon(energy, reflectBuffer);
+
+  summary.absorbed += EDep;
+  for (const G4double& E: reflectBuffer) summary.Fill(E);
+
+  reflectBuffer.clear();
+  return EDep;
+}
+
 
 // Compute the probability of phonon reentering the crystal without breaking
 // any Cooper pairs.
@@ -188,15 +245,16 @@ G4double G4CMPKaplanQP::CalcEscapeProbability(G4double energy,
   // Compute energy-dependent mean free path for phonons in film
   if (gapEnergy <= 0.) return 1.;
 
-  G4double mfp = vSound * phononLifetime /
-                 (1. + phononLifetimeSlope * (energy/gapEnergy - 2.));
+  // 2*thickness/mfp = escapeScale * (1 + slope*(E/gap - 2))
+  G4double pathRatio = escapeScale *
+    (1. + phononLifetimeSlope * (energy/gapEnergy - 2.));
 
   if (verboseLevel>2) {
-    G4cout << " mfp " << mfp << " returning "
-	   << std::exp(-2.* thicknessFrac * filmThickness/mfp) << G4endl;
+    G4cout << " mfp " << 2.*filmThickness/pathRatio << " returning "
+	   << std::exp(-thicknessFrac*pathRatio) << G4endl;
   }
 
-  return std::exp(-2.* thicknessFrac * filmThickness/mfp);
+  return std::exp(-thicknessFrac*pathRatio);
 }
 
 
@@ -207,13 +265,14 @@ G4double
 G4CMPKaplanQP::CalcQPEnergies(std::vector<G4double>& phonEnergies,
 			      std::vector<G4double>& qpEnergies) const {
   if (verboseLevel>1) {
-    G4cout << "G4CMPKaplanQP::CalcQPEnergies QPcut " << lowQPLimit*gapEnergy
+    G4cout << "G4CMPKaplanQP::CalcQPEnergies QPcut " << lowQPEnergy
 	   << G4endl;
   }
 
   // Phonons above the bandgap give all of its energy to the qp pair it breaks.
   G4double EDep = 0.;
-  std::vector<G4double> newPhonEnergies;
+  std::vector<G4double>& newPhonEnergies = scratchBuffer;
+  newPhonEnergies.clear();
 
   for (const G4double& E: phonEnergies) {
     if (IsSubgap(E)) {
@@ -245,12 +304,13 @@ G4CMPKaplanQP::CalcPhononEnergies(std::vector<G4double>& phonEnergies,
 				  std::vector<G4double>& qpEnergies) const {
   if (verboseLevel>1) {
     G4cout << "G4CMPKaplanQP::CalcPhononEnergies 2*gap " << 2.*gapEnergy
-	   << " QPcut " << lowQPLimit*gapEnergy << G4endl;
+	   << " QPcut " << lowQPEnergy << G4endl;
   }
 
   // Have a reference in for loop b/c qp doesn't give all of its energy away.
   G4double EDep = 0.;
-  std::vector<G4double> newQPEnergies;
+  std::vector<G4double>& newQPEnergies = scratchBuffer;
+  newQPEnergies.clear();
   for (const G4double& E: qpEnergies) {
     if (verboseLevel>2) G4cout << " qpE " << E;		// Report before change
 
@@ -286,7 +346,8 @@ CalcReflectedPhononEnergies(std::vector<G4double>& phonEnergies,
     G4cout << "G4CMPKaplanQP::CalcReflectedPhononEnergies " << G4endl;
 
   // There is a 50% chance that a phonon is headed away from (toward) substrate
-  std::vector<G4double> newPhonEnergies;
+  std::vector<G4double>& newPhonEnergies = scratchBuffer;
+  newPhonEnergies.clear();
   for (const G4double& E: phonEnergies) {
     if (verboseLevel>2) G4cout << " phononE " << E << G4endl;
 
@@ -343,7 +404,7 @@ G4CMPKaplanQP::CalcQPAbsorption(G4double qpE,
 				std::vector<G4double>& qpEnergies) const {
   G4double EDep = 0.;		// Energy lost by this QP into the film
 
-  if (qpE >= lowQPLimit*gapEnergy) {
+  if (qpE >= lowQPEnergy) {
     if (verboseLevel>2) G4cout << " Storing qpE in qpEnergies" << G4endl;
     qpEnergies.push_back(qpE);
   } else if (qpE > gapEnergy) {
@@ -358,31 +419,36 @@ G4CMPKaplanQP::CalcQPAbsorption(G4double qpE,
 }
 
 // Compute quasiparticle energy distribution from broken Cooper pair.
+//
+// PDF(E') = (E'*(Energy - E') + gapEnergy*gapEnergy)
+//           /
+//           sqrt((E'*E' - gapEnergy*gapEnergy) *
+//                ((Energy - E')*(Energy - E') - gapEnergy*gapEnergy));
+//
+// The PDF is symmetric about c = Energy/2, and diverges at both endpoints.
+// With E' = c + a*sin(theta), a = c - gapEnergy, and b = c + gapEnergy,
+//
+// PDF(theta) = (c*c + gapEnergy*gapEnergy - a*a*sin^2(theta))
+//              /
+//              sqrt(b*b - a*a*sin^2(theta))
+//
+// is finite, with its maximum at theta = 0, so a flat envelope accepts at
+// least 2/pi of the trials.
 
 G4double G4CMPKaplanQP::QPEnergyRand(G4double Energy) const {
-  // PDF is not integrable, so we can't do an inverse transform sampling.
-  // Instead, we'll do a rejection method.
-  //
-  // PDF(E') = (E'*(Energy - E') + gapEnergy*gapEnergy)
-  //           /
-  //           sqrt((E'*E' - gapEnergy*gapEnergy) *
-  //                ((Energy - E')*(Energy - E') - gapEnergy*gapEnergy));
-  // The shape of the PDF is like a U, so the max values are at the endpoints:
-  // E' = gapEnergy and E' = Energy - gapEnergy
-
-  // Add buffer so first/last bins don't give zero denominator in pdfSum
-  const G4double BUFF = 1000.;
-  G4double xmin = gapEnergy + (Energy-2.*gapEnergy)/BUFF;
-  G4double xmax = gapEnergy + (Energy-2.*gapEnergy)*(BUFF-1.)/BUFF;
-  G4double ymax = QPEnergyPDF(Energy, xmin);
-
-  G4double xtest=0., ytest=ymax;
+  const G4double c = 0.5*Energy;
+  const G4double a = c - gapEnergy;
+  if (a <= 0.) return c;			// Exactly at pair threshold
+
+  const G4double b = c + gapEnergy;
+  const G4double gmax = QPThetaPDF(c, a, b, 0.);
+
+  G4double theta = 0.;
   do {
-    ytest = G4UniformRand()*ymax;
-    xtest = G4UniformRand()*(xmax-xmin) + xmin;
-  } while (ytest > QPEnergyPDF(Energy, xtest));
+    theta = (G4UniformRand() - 0.5)*pi;
+  } while (G4UniformRand()*gmax > QPThetaPDF(c, a, b, theta));
 
-  return xtest;
+  return c + a*std::sin(theta);
 }
 
 G4double G4CMPKaplanQP::QPEnergyPDF(G4double E, G4double x) const {
@@ -390,28 +456,40 @@ G4double G4CMPKaplanQP::QPEnergyPDF(G4double E, G4double x) const {
   return ( (x*(E-x) + gapsq) / sqrt((x*x-gapsq) * ((E-x)*(E-x)-gapsq)) );
 }
 
+G4double G4CMPKaplanQP::QPThetaPDF(G4double c, G4double a, G4double b,
+				   G4double theta) const {
+  const G4double asin2 = a*a*std::sin(theta)*std::sin(theta);
+  return (c*c + gapSquared - asin2) / std::sqrt(b*b - asin2);
+}
+
 
 // Compute phonon energy distribution from quasiparticle in superconductor.
+//
+// PDF(E') = (E'*(Energy-E')*(Energy-E') * (E'-gapEnergy*gapEnergy/Energy))
+//           /
+//           sqrt(E'*E' - gapEnergy*gapEnergy);
+//
+// where E' is the final quasiparticle energy.  With y = sqrt(E'^2-gap^2),
+// dy = E'/sqrt(E'^2-gap^2) dE', so
+//
+// PDF(y) = (Energy-E')*(Energy-E') * (E'-gapEnergy*gapEnergy/Energy)
+//
+// which is a cubic in E', bounded by its value at (Energy+2*gap^2/E)/3.
+// A flat envelope in y accepts more than half of the trials.
 
 G4double G4CMPKaplanQP::PhononEnergyRand(G4double Energy) const {
-  // PDF is not integrable, so we can't do an inverse transform sampling.
-  // Instead, we'll do a rejection method.
-  //
-  // PDF(E') = (E'*(Energy-E')*(Energy-E') * (E'-gapEnergy*gapEnergy/Energy))
-  //           /
-  //           sqrt((E'*E' - gapEnergy*gapEnergy);
-
-  // Add buffer so first bin doesn't give zero denominator in pdfSum
-  const G4double BUFF = 1000.;
-  G4double xmin = gapEnergy + gapEnergy/BUFF;
-  G4double xmax = Energy;
-  G4double ymax = PhononEnergyPDF(Energy, xmin);
-
-  G4double xtest=0., ytest=ymax;
+  if (Energy <= gapEnergy) return 0.;		// No phase space
+
+  const G4double ymax = std::sqrt(Energy*Energy - gapSquared);
+
+  G4double xpeak = std::max(gapEnergy, (Energy + 2.*gapSquared/Energy)/3.);
+  const G4double rmax = PhononYPDF(Energy, xpeak);
+
+  G4double xtest = 0., y = 0.;
   do {
-    ytest = G4UniformRand()*ymax;
-    xtest = G4UniformRand()*(xmax-xmin) + xmin;
-  } while (ytest > PhononEnergyPDF(Energy, xtest));
+    y = G4UniformRand()*ymax;
+    xtest = std::sqrt(y*y + gapSquared);
+  } while (G4UniformRand()*rmax > PhononYPDF(Energy, xtest));
 
   return Energy-xtest;
 }
@@ -420,3 +498,32 @@ G4double G4CMPKaplanQP::PhononEnergyPDF(G4double E, G4double x) const {
   const G4double gapsq = gapEnergy*gapEnergy;
   return ( x*(E-x)*(E-x) * (x-gapsq/E) / sqrt(x*x - gapsq) );
 }
+
+G4double G4CMPKaplanQP::PhononYPDF(G4double E, G4double x) const {
+  return ( (E-x)*(E-x) * (x-gapSquared/E) );
+}
+
+
+// Accumulate absorbed and reflected energies across calls
+
+G4CMPKaplanQP::Summary::Summary(G4double maxEnergy, G4int nBins)
+  : absorbed(0.), reflected(0.), nReflected(0),
+    binWidth(nBins>0 ? maxEnergy/nBins : 0.),
+    histogram(std::max(nBins,0), 0) {;}
+
+void G4CMPKaplanQP::Summary::Clear() {
+  absorbed = reflected = 0.;
+  nReflected = 0;
+  std::fill(histogram.begin(), histogram.end(), 0);
+}
+
+void G4CMPKaplanQP::Summary::Fill(G4double reflectedE) {
+  reflected += reflectedE;
+  nReflected++;
+
+  if (histogram.empty()) return;
+
+  const size_t nBins = histogram.size();
+  G4double xbin = (binWidth > 0. ? reflectedE/binWidth : 0.);
+  histogram[xbin < nBins ? (size_t)xbin : nBins-1]++;
+}
@@ -20,13 +20,15 @@
 // 20170928  Hide "output" usage behind verbosity check, as well as G4CMP_DEBUG
 // 20180827  Add debugging output with weight calculation.
 // 20190816  Add flag to track secondary phonons immediately (c.f. G4Cerenkov)
+// 20201025  Get Luke sampling factor from track, not global configuration
+// 20201101  Reduce Luke sampling when event exceeds phonon track budget
 
 #include "G4CMPLukeScattering.hh"
-#include "G4CMPConfigManager.hh"
 #include "G4CMPDriftElectron.hh"
 #include "G4CMPDriftHole.hh"
 #include "G4CMPDriftTrackInfo.hh"
 #include "G4CMPLukeEmissionRate.hh"
+#include "G4CMPPartitionSummary.hh"
 #include "G4CMPSecondaryUtils.hh"
 #include "G4CMPTrackUtils.hh"
 #include "G4CMPUtils.hh"
@@ -158,8 +160,11 @@ G4VParticleChange* G4CMPLukeScattering::PostStepDoIt(const G4Track& aTrack,
   // Create real phonon to be propagated, with random polarization
   // If phonon is not created, register the energy as deposited
   G4double weight =
-    G4CMP::ChoosePhononWeight(G4CMPConfigManager::GetLukeSampling());
+    G4CMP::ChoosePhononWeight(trackInfo->LukeSampling() *
+			      G4CMPPartitionSummary::PhononBudgetScale());
   if (weight > 0.) {
+    G4CMPPartitionSummary::CountPhonons(1);
+
     MakeGlobalPhononK(qvec);  		// Convert phonon vector to real space
 
     G4Track* phonon = G4CMP::CreatePhonon(aTrack.GetTouchable(),
@@ -21,6 +21,7 @@
 // 20190513  Provide support for 2D (e.g., axisymmetric) and 3D meshes.
 // 20190919  BUG FIX:  2D project functions need 'break' in switch statements.
 // 20200519  Move local "static" buffers to class for thread safety.
+// 20201109  Add batched GetPotential() for points along a path
 
 #include "G4CMPMeshElectricField.hh"
 #include "G4CMPBiLinearInterp.hh"
@@ -217,6 +218,27 @@ G4double G4CMPMeshElectricField::GetPotential(const G4double Point[3]) const {
   }
 }
 
+void G4CMPMeshElectricField::
+GetPotential(const std::vector<G4ThreeVector>& points,
+	     std::vector<G4double>& values) const {
+  values.resize(points.size());
+
+  G4double point[3] = { 0.,0.,0. };
+  G4double proj[2] = { 0.,0. };
+  for (size_t i=0; i<points.size(); i++) {
+    point[0] = points[i].x();
+    point[1] = points[i].y();
+    point[2] = points[i].z();
+
+    if (xCoord == kUndefined) {		// Three dimensions
+      values[i] = Interp->GetValue(point, true);
+    } else {				// Two dimensions
+      Project2D(point, proj);
+      values[i] = Interp->GetValue(proj, true);
+    }
+  }
+}
+
 
 // Convert between 3D and 2D coordinates for projected meshes
 
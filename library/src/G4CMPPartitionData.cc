@@ -14,6 +14,8 @@
 //
 // 20200218  Michael Kelsey (TAMU) <kelsey@slac.stanford.edu>
 // 20200316  Add hit position; improve energy quantity calculations.
+// 20201101  Record track weights and Luke sampling used for deposit
+// 20201110  Record energy of phonons below tracking threshold
 
 #include "globals.hh"
 #include "G4CMPPartitionData.hh"
@@ -30,7 +32,8 @@ G4CMPPartitionData::G4CMPPartitionData()
   : G4VHit(), totalEnergy(0.), truedEdx(0.),
     trueNIEL(0.), lindhardYield(0.), FanoFactor(0.), chargeEnergy(0.),
     chargeFano(0.), chargeGenerated(0.), numberOfPairs(0), phononEnergy(0.),
-    phononGenerated(0.), numberOfPhonons(0) {
+    phononGenerated(0.), numberOfPhonons(0), chargeWeight(0.),
+    phononWeight(0.), lukeSampling(0.), phononSkipped(0.) {
   position[0]=position[1]=position[2]=position[3]=0.;
 }
 
@@ -52,5 +55,8 @@ void G4CMPPartitionData::Print() {	// FIXME: Base class is non-const
 	 << "\n True phonon energy " << phononEnergy/eV << " eV"
 	 << "\n Generated phonon energy " << phononGenerated/eV << " eV"
 	 << "\n Number of phonons " << numberOfPhonons
+	 << "\n Track weights: e/h " << chargeWeight
+	 << " phonons " << phononWeight << " Luke sampling " << lukeSampling
+	 << "\n Untracked phonon energy " << phononSkipped/eV << " eV"
 	 << G4endl;
 }
@@ -10,8 +10,13 @@
 // $Id$
 //
 // 20200219  Michael Kelsey (TAMU) <kelsey@slac.stanford.edu>
+// 20201101  Count tracks created in current event, for track budgets
+// 20201112  Identify event by run and event count, for repeated runs
 
 #include "G4CMPPartitionSummary.hh"
+#include "G4CMPConfigManager.hh"
+#include "G4Run.hh"
+#include "G4RunManager.hh"
 
 
 // Singleton construction
@@ -31,3 +36,34 @@ void G4CMPPartitionSummary::clear() {
   for (auto& x: summary) { delete x; x=0; }
   summary.clear();
 }
+
+// Track counts are reset at the first use in each new event.  The run
+// manager's current event is not set until primary generation is done,
+// so events are counted by the run instead; those counts restart with
+// each run, so the run ID is needed as well.
+
+G4CMPPartitionSummary* G4CMPPartitionSummary::update() {
+  const G4RunManager* runMgr = G4RunManager::GetRunManager();
+  const G4Run* run = runMgr ? runMgr->GetCurrentRun() : 0;
+
+  G4int newEvent = run ? run->GetNumberOfEvent() : -1;
+  G4int newRun = run ? run->GetRunID() : -1;
+  if (newEvent != eventID || newRun != runID) {
+    runID = newRun;
+    eventID = newEvent;
+    nPhonons = nCharges = 0.;
+  }
+
+  return this;
+}
+
+// Once the budget is exceeded, tracks are kept with probability which
+// falls as budget/count, so that the event only grows slowly beyond it
+
+G4double G4CMPPartitionSummary::PhononBudgetScale() {
+  G4int budget = G4CMPConfigManager::GetPhononBudget();
+  if (budget <= 0) return 1.;
+
+  G4double nUsed = PhononsThisEvent();
+  return (nUsed > budget) ? budget/nUsed : 1.;
+}
@@ -0,0 +1,153 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/src/G4CMPPendingTracks.cc
+/// \brief Implementation of the G4CMPPendingTracks singleton, holding
+///   particle records from energy deposits until they are tracked.
+///
+// $Id$
+//
+// 20201112  New class for staged creation of tracks from large deposits
+
+#include "G4CMPPendingTracks.hh"
+#include "G4CMPConfigManager.hh"
+#include "G4CMPSecondaryUtils.hh"
+#include "G4CMPStackingAction.hh"
+#include "G4CMPTrackUtils.hh"
+#include "G4CMPUtils.hh"
+#include "G4CMPVTrackInfo.hh"
+#include "G4EventManager.hh"
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4Track.hh"
+#include <algorithm>
+#include <climits>
+
+
+// Singleton construction
+
+G4CMPPendingTracks* G4CMPPendingTracks::Instance() {
+  static G4ThreadLocalSingleton<G4CMPPendingTracks> theInstance;
+  return theInstance.Instance();
+}
+
+// Records left in the buffer would never be tracked without NewStage()
+
+G4bool G4CMPPendingTracks::Enabled() {
+  if (G4CMPConfigManager::GetTrackBatch() <= 0) return false;
+
+  G4EventManager* evtMgr = G4EventManager::GetEventManager();
+  return (evtMgr &&
+	  dynamic_cast<G4CMPStackingAction*>(evtMgr->GetUserStackingAction()));
+}
+
+
+// Collect new deposit and its particles
+
+void G4CMPPendingTracks::
+newDeposit(const G4TouchableHandle& touch, const G4ThreeVector& pos,
+	   G4double time, G4double phononWeight, G4double chargeWeight,
+	   const G4double samples[3], G4int parentID,
+	   const G4VProcess* creator) {
+  update();
+
+  deposits.push_back(Deposit());
+  Deposit& dep = deposits.back();
+  dep.touch = touch;
+  dep.position = pos;
+  dep.time = time;
+  dep.weight[0] = phononWeight;
+  dep.weight[1] = chargeWeight;
+  std::copy(samples, samples+3, dep.samples);
+  dep.parentID = parentID;
+  dep.creator = creator;
+}
+
+void G4CMPPendingTracks::add(G4ParticleDefinition* pd,
+			     const G4ThreeVector& dir, G4double ekin,
+			     const G4ThreeVector& pos) {
+  if (deposits.empty()) {
+    G4Exception("G4CMPPendingTracks::Add", "Pending001", FatalException,
+		"Particle added without calling NewDeposit()");
+    return;
+  }
+
+  records.push_back(Record(pd, dir, pos, ekin, deposits.size()-1));
+}
+
+
+// Convert oldest records to tracks, sharing volume lookup within deposit
+
+size_t G4CMPPendingTracks::createTracks(G4TrackVector& tracks, size_t nMax) {
+  update();
+
+  size_t nMade = 0;
+  while (nextRecord < records.size() && nMade < nMax) {
+    const size_t idep = records[nextRecord].deposit;
+    const Deposit& dep = deposits[idep];
+    const G4CMP::SecondaryContext context(dep.touch(), dep.position);
+
+    for (; nextRecord < records.size() && nMade < nMax; nextRecord++) {
+      const Record& r = records[nextRecord];
+      if (r.deposit != idep) break;		// Start of next deposit
+
+      G4Track* theTrack = G4CMP::CreateSecondary(context, r.pd, r.dir, r.ekin,
+						 dep.time, r.pos);
+      if (!theTrack) continue;
+
+      theTrack->SetTrackID(nextTrackID--);
+      theTrack->SetParentID(dep.parentID);
+      theTrack->SetCreatorProcess(dep.creator);
+      theTrack->SetWeight(dep.weight[G4CMP::IsPhonon(r.pd) ? 0 : 1]);
+      theTrack->SetTouchableHandle(dep.touch);
+      theTrack->SetOriginTouchableHandle(dep.touch);
+
+      G4CMP::GetTrackInfo<G4CMPVTrackInfo>(*theTrack)->
+	SetSampling(dep.samples[0], dep.samples[1], dep.samples[2]);
+
+      tracks.push_back(theTrack);
+      nMade++;
+    }
+  }
+
+  if (nextRecord >= records.size()) clear();	// Release touchables
+
+  return nMade;
+}
+
+
+// Discard buffer contents
+
+void G4CMPPendingTracks::clear() {
+  records.clear();
+  deposits.clear();
+  nextRecord = 0;
+}
+
+// Records are reset at the first use in each new event; anything left
+// over is from an aborted event, and was never tracked.  The current
+// G4Event is not yet set during primary generation, so events are
+// counted by the run instead.
+
+void G4CMPPendingTracks::update() {
+  const G4RunManager* runMgr = G4RunManager::GetRunManager();
+  const G4Run* run = runMgr ? runMgr->GetCurrentRun() : 0;
+
+  G4int newEvent = run ? run->GetNumberOfEvent() : -1;
+  G4int newRun = run ? run->GetRunID() : -1;
+  if (newEvent == eventID && newRun == runID) return;
+
+  if (entries() > 0) {
+    G4ExceptionDescription msg;
+    msg << entries() << " staged particles from run " << runID
+	<< " were never tracked.";
+    G4Exception("G4CMPPendingTracks", "Pending002", JustWarning, msg);
+  }
+
+  clear();
+  runID = newRun;
+  eventID = newEvent;
+  nextTrackID = INT_MAX;
+}
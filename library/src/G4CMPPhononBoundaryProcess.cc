@@ -23,6 +23,11 @@
 // 20161114  Use new G4CMPPhononTrackInfo
 // 20170829  Add detailed diagnostics to identify boundary issues
 // 20170928  Replace "pol" with "mode" for phonons
+// 20201020  Use cached group velocity from track info
+// 20201021  Add fast ballistic mode, following reflections within one step
+// 20201110  Fast flights: use local frame only for solid, global for k
+// 20201112  Pass touchable for velocity; check inward velocity in local frame
+// 20201112  Fast flights use rate models of registered bulk processes
 
 #include "G4CMPPhononBoundaryProcess.hh"
 #include "G4CMPConfigManager.hh"
@@ -31,16 +36,22 @@
 #include "G4CMPSurfaceProperty.hh"
 #include "G4CMPTrackUtils.hh"
 #include "G4CMPUtils.hh"
+#include "G4CMPVScatteringRate.hh"
 #include "G4ExceptionSeverity.hh"
 #include "G4GeometryTolerance.hh"
 #include "G4LatticeManager.hh"
 #include "G4LatticePhysical.hh"
 #include "G4ParallelWorldProcess.hh"
+#include "G4ProcessManager.hh"
+#include "G4ProcessVector.hh"
 #include "G4Step.hh"
 #include "G4StepPoint.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4ThreeVector.hh"
+#include "G4Box.hh"
+#include "G4Tubs.hh"
 #include "G4VParticleChange.hh"
+#include "G4VSolid.hh"
 #include "G4LogicalSurface.hh"
 #include "G4LogicalBorderSurface.hh"
 #include "Randomize.hh"
@@ -133,35 +144,19 @@ DoReflection(const G4Track& aTrack, const G4Step& aStep,
     particleChange.ProposePosition(surfacePoint);	// IS THIS CORRECT?!?
   }
 
-  G4double specProb = GetMaterialProperty("specProb");
-
-  G4ThreeVector reflectedKDir;
-  if (G4UniformRand() < specProb) {
-    // Specular reflecton reverses momentum along normal
-    reflectedKDir = waveVector.unit();
-    G4double kPerp = reflectedKDir * surfNorm;
-    reflectedKDir -= 2.*kPerp * surfNorm;
-  } else {
-    // Lambertian distribution may produce outward wavevector
-    const G4int maxTries = 1000;
-    G4int nTries = 0;
-    do {
-      reflectedKDir = G4CMP::LambertReflection(surfNorm);
-    } while (nTries++ < maxTries &&
-	     !G4CMP::PhononVelocityIsInward(theLattice, mode,
-					    reflectedKDir, surfNorm));
-  }
-
   // If reflection failed, report problem and kill the track
-  if (!G4CMP::PhononVelocityIsInward(theLattice,mode,reflectedKDir,surfNorm)) {
+  G4ThreeVector reflectedKDir;
+  if (!ReflectWaveVector(mode, waveVector, surfNorm, reflectedKDir)) {
     G4Exception((GetProcessName()+"::DoReflection").c_str(), "Boundary010",
 		JustWarning, "Phonon reflection failed");
     DoSimpleKill(aTrack, aStep, aParticleChange);
     return;
   }
 
-  G4ThreeVector vdir = theLattice->MapKtoVDir(mode, reflectedKDir);
-  G4double v = theLattice->MapKtoV(mode, reflectedKDir);
+  const G4VTouchable* touch = aStep.GetPreStepPoint()->GetTouchable();
+  trackInfo->SetWaveVector(reflectedKDir);
+  G4ThreeVector vdir = trackInfo->VelocityDir(mode, touch, theLattice);
+  G4double v = trackInfo->GroupSpeed(mode, touch, theLattice);
 
   if (verboseLevel>2) {
     G4cout << " New wavevector direction " << reflectedKDir
@@ -186,7 +181,198 @@ DoReflection(const G4Track& aTrack, const G4Step& aStep,
 					: "on surface") << G4endl;
   }
 
-  trackInfo->SetWaveVector(reflectedKDir);
   particleChange.ProposeVelocity(v);
   particleChange.ProposeMomentumDirection(vdir);
+
+  if (UseFastBallistic(aStep))
+    DoFastFlights(aTrack, aStep, surfacePoint, particleChange);
+}
+
+
+// Specular reflection, or Lambertian distribution which may need retries.
+// Wavevector and normal are global; the lattice needs them in the local
+// frame to check the direction of the group velocity.
+
+G4bool G4CMPPhononBoundaryProcess::
+ReflectWaveVector(G4int mode, const G4ThreeVector& waveVector,
+		  const G4ThreeVector& surfNorm,
+		  G4ThreeVector& reflectedKDir) const {
+  G4double specProb = GetMaterialProperty("specProb");
+  G4ThreeVector localNorm = GetLocalDirection(surfNorm);
+
+  if (G4UniformRand() < specProb) {
+    // Specular reflecton reverses momentum along normal
+    reflectedKDir = waveVector.unit();
+    G4double kPerp = reflectedKDir * surfNorm;
+    reflectedKDir -= 2.*kPerp * surfNorm;
+  } else {
+    // Lambertian distribution may produce outward wavevector
+    const G4int maxTries = 1000;
+    G4int nTries = 0;
+    do {
+      reflectedKDir = G4CMP::LambertReflection(surfNorm);
+    } while (nTries++ < maxTries &&
+	     !G4CMP::PhononVelocityIsInward(theLattice, mode,
+					    GetLocalDirection(reflectedKDir),
+					    localNorm));
+  }
+
+  return G4CMP::PhononVelocityIsInward(theLattice, mode,
+				       GetLocalDirection(reflectedKDir),
+				       localNorm);
+}
+
+
+// Fast flights require a single surface property with no electrode
+// pattern, since there is no G4Step for the later boundary points
+
+G4bool
+G4CMPPhononBoundaryProcess::UseFastBallistic(const G4Step& aStep) const {
+  if (!G4CMPConfigManager::UseFastBallistic() || !matTable || electrode)
+    return false;
+
+  const G4VSolid* solid =
+    aStep.GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume()->GetSolid();
+
+  return (dynamic_cast<const G4Box*>(solid) ||
+	  dynamic_cast<const G4Tubs*>(solid));
+}
+
+// Fast flights must see the same bulk rate as normal tracking, so the
+// rate models of whichever phonon bulk processes are registered, and
+// active, for this particle are summed.
+
+G4double
+G4CMPPhononBoundaryProcess::GetBulkRate(const G4Track& aTrack) const {
+  G4ProcessManager* pmgr = aTrack.GetDefinition()->GetProcessManager();
+  G4ProcessVector* pvec = pmgr ? pmgr->GetProcessList() : 0;
+  if (!pvec) return 0.;
+
+  G4double rate = 0.;
+  for (size_t i=0; i<pvec->size(); i++) {
+    G4int stype = (*pvec)[i]->GetProcessSubType();
+    if (stype != fPhononBulk && stype != fPhononScattering &&
+	stype != fPhononDownconversion) continue;
+
+    if (!pmgr->GetProcessActivation((*pvec)[i])) continue;
+
+    const G4CMPVProcess* proc = dynamic_cast<const G4CMPVProcess*>((*pvec)[i]);
+    if (proc && proc->GetRateModel())
+      rate += proc->GetRateModel()->Rate(aTrack);
+  }
+
+  return rate;
+}
+
+// Phonon is propagated analytically from surface to surface, using the
+// same absorption and reflection conditions as ApplyBoundaryAction().
+// A bulk interaction length is sampled for each flight.  If it is shorter
+// than the chord, or if the next surface borders a different volume, the
+// phonon is left at the current surface point, and Geant4 tracks it from
+// there.  Since the bulk sampling is memoryless, this is unbiased.  The
+// phonon always ends on the surface, as in a regular reflection, so that
+// navigation from the post-step volume remains valid.
+
+void G4CMPPhononBoundaryProcess::
+DoFastFlights(const G4Track& aTrack, const G4Step& aStep,
+	      const G4ThreeVector& surfacePoint,
+	      G4ParticleChange& particleChange) {
+  const G4int maxFlights = 10000;	// Guard against endless reflections
+
+  auto trackInfo = G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(aTrack);
+  const G4VTouchable* touch = aStep.GetPreStepPoint()->GetTouchable();
+  const G4VSolid* solid = prePV->GetLogicalVolume()->GetSolid();
+
+  // Polarization and energy don't change with reflections
+  G4int mode = GetPolarization(aStep.GetTrack());
+  G4double rate = GetBulkRate(aTrack);
+
+  // Surface properties are the same for every flight in this volume pair
+  const G4double absProb  = GetMaterialProperty("absProb");
+  const G4double reflProb = GetMaterialProperty("reflProb");
+  const G4double absMinK  = GetMaterialProperty("absMinK");
+
+  // Position and solid are in the local frame; wavevector, velocity and
+  // surface normal used for reflection are global, as in DoReflection()
+  G4ThreeVector pos = G4CMP::GetLocalPosition(touch, surfacePoint);
+  G4double time = aTrack.GetGlobalTime();
+
+  G4ThreeVector vdir, vlocal, norm;
+  G4double vgrp=0., dist=0., lbulk=0.;
+  G4bool validNorm = false, moved = false, killed = false;
+  G4int nFlights = 0;
+  while (nFlights < maxFlights) {
+    vdir = trackInfo->VelocityDir(mode, touch, theLattice);
+    vgrp = trackInfo->GroupSpeed(mode, touch, theLattice);
+    vlocal = G4CMP::GetLocalDirection(touch, vdir);
+
+    dist = solid->DistanceToOut(pos, vlocal, true, &validNorm, &norm);
+    lbulk = (rate > 0.) ? -vgrp*std::log(G4UniformRand())/rate : DBL_MAX;
+
+    if (lbulk < dist) break;		// Bulk process will act on chord
+
+    G4ThreeVector next = pos + dist*vlocal;
+    if (!validNorm) norm = solid->SurfaceNormal(next);
+
+    // Surface properties are only known for the current pair of volumes
+    G4ThreeVector outside = next + 2.*kCarTolerance*norm;
+    G4CMP::RotateToGlobalPosition(touch, outside);
+    if (G4CMP::GetVolumeAtPoint(outside) != postPV) break;
+
+    G4CMP::RotateToGlobalDirection(touch, norm);
+
+    pos = next;
+    time += dist/vgrp;
+    moved = true;
+    nFlights++;
+
+    if (verboseLevel>2) {
+      G4cout << " Fast flight " << nFlights << " to " << pos << " at "
+	     << time/ns << " ns" << G4endl;
+    }
+
+    // Same sequence of actions as ApplyBoundaryAction()
+    if (G4UniformRand() <= absProb && trackInfo->k()*norm > absMinK) {
+      DoAbsorption(aTrack, aStep, particleChange);
+      killed = true;
+      break;
+    }
+
+    if (MaximumReflections(aTrack) ||
+	G4UniformRand() > reflProb) {
+      DoSimpleKill(aTrack, aStep, particleChange);
+      killed = true;
+      break;
+    }
+
+    G4ThreeVector reflectedKDir;
+    if (!ReflectWaveVector(mode, trackInfo->k(), norm, reflectedKDir)) {
+      G4Exception((GetProcessName()+"::DoFastFlights").c_str(), "Boundary010",
+		  JustWarning, "Phonon reflection failed");
+      DoSimpleKill(aTrack, aStep, particleChange);
+      killed = true;
+      break;
+    }
+
+    trackInfo->SetWaveVector(reflectedKDir);
+  }
+
+  if (verboseLevel>1) {
+    G4cout << GetProcessName() << "::DoFastFlights " << nFlights
+	   << " reflections, ending at " << pos << G4endl;
+  }
+
+  if (!moved) return;			// Original reflection stands
+
+  // Transfer final phonon state back to particle change
+  G4CMP::RotateToGlobalPosition(touch, pos);
+  particleChange.ProposePosition(pos);
+  particleChange.ProposeGlobalTime(time);
+
+  if (!killed) {
+    vdir = trackInfo->VelocityDir(mode, touch, theLattice);
+    particleChange.ProposeMomentumDirection(vdir);
+    particleChange.ProposeVelocity(trackInfo->GroupSpeed(mode, touch,
+							 theLattice));
+  }
 }
@@ -0,0 +1,41 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/src/G4CMPPhononBulkRate.cc
+/// \brief Compute combined rate for phonon isotope scattering and
+///	   anharmonic decay (downconversion).
+//
+// $Id$
+//
+// 20201019  New rate model for G4PhononBulkInteraction
+// 20201112  Add rate for energy and polarization, for use without tracks
+
+#include "G4CMPPhononBulkRate.hh"
+#include "G4LatticePhysical.hh"
+#include "G4PhononPolarization.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4Track.hh"
+
+
+G4double G4CMPPhononBulkRate::Rate(const G4Track& aTrack) const {
+  return Rate(GetKineticEnergy(aTrack), GetPolarization(aTrack));
+}
+
+// Same expressions as G4CMPPhononScatteringRate and G4CMPDownconversionRate,
+// sharing the powers of E/h between them
+
+G4double G4CMPPhononBulkRate::Rate(G4double energy, G4int mode) const {
+  G4double Eoverh = energy/h_Planck;
+  G4double Eoverh4 = Eoverh*Eoverh*Eoverh*Eoverh;
+
+  scatRate = Eoverh4 * theLattice->GetScatteringConstant();
+
+  // Only L-phonons decay
+  downRate = 0.;
+  if (mode == G4PhononPolarization::Long)
+    downRate = Eoverh4 * Eoverh * theLattice->GetAnhDecConstant();
+
+  return scatRate + downRate;
+}
@@ -13,14 +13,52 @@
 //
 // 20161111 Initial commit - R. Agnese
 // 20170728 M. Kelsey -- Replace "k" function args with "theK" (-Wshadow)
+// 20201020  Cache group velocity, recomputed only when wavevector changes
+// 20201028  Use thread-local G4Allocator for memory management
+// 20201112  Wavevector and cached velocity are global; pass touchable
 
 #include "G4CMPPhononTrackInfo.hh"
+#include "G4CMPGlobalLocalTransformStore.hh"
+#include "G4LatticePhysical.hh"
 
-//G4Allocator<G4CMPPhononTrackInfo> G4CMPPhononTrackInfoAllocator;
+G4ThreadLocal
+G4Allocator<G4CMPPhononTrackInfo>* G4CMPPhononTrackInfoAllocator = 0;
 
 G4CMPPhononTrackInfo::G4CMPPhononTrackInfo(const G4LatticePhysical* lat,
                                            G4ThreeVector theK)
-  : G4CMPVTrackInfo(lat), waveVec(theK) {;}
+  : G4CMPVTrackInfo(lat), waveVec(theK), velMode(-1), velLattice(0),
+    velSpeed(0.) {;}
+
+// Recompute group velocity only if inputs have changed since last call.
+// Lattice functions work in the solid's frame, so the global wavevector
+// is rotated in, and the resulting velocity rotated back out.
+
+void G4CMPPhononTrackInfo::FillVelocity(G4int mode, const G4VTouchable* touch,
+					const G4LatticePhysical* lat) const {
+  static const G4AffineTransform unrotated;
+
+  if (!lat) lat = Lattice();
+  const G4AffineTransform& toLocal =
+    touch ? G4CMPGlobalLocalTransformStore::ToLocal(touch) : unrotated;
+
+  if (mode == velMode && lat == velLattice && toLocal == velToLocal) return;
+
+  velMode = mode;
+  velLattice = lat;
+  velToLocal = toLocal;
+
+  G4ThreeVector kLocal = toLocal.TransformAxis(waveVec);
+  if (lat) {
+    velDir = lat->MapKtoVDir(mode, kLocal);
+    velSpeed = lat->MapKtoV(mode, kLocal);
+  } else {			// Should never happen, but avoid crash
+    velDir = kLocal.unit();
+    velSpeed = 0.;
+  }
+
+  if (touch)
+    G4CMPGlobalLocalTransformStore::ToGlobal(touch).ApplyAxisTransform(velDir);
+}
 
 void G4CMPPhononTrackInfo::Print() const {
 //TODO
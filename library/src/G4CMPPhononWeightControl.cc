@@ -0,0 +1,173 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/src/G4CMPPhononWeightControl.cc
+/// \brief Implementation of the G4CMPPhononWeightControl process, to apply
+///	   Russian roulette and splitting to weighted phonons.
+//
+// $Id$
+//
+// 20201022  New process for phonon Russian roulette and splitting
+// 20201112  Apply roulette and splitting on boundary steps as well
+
+#include "G4CMPPhononWeightControl.hh"
+#include "G4CMPConfigManager.hh"
+#include "G4CMPGeometryUtils.hh"
+#include "G4CMPPhononTrackInfo.hh"
+#include "G4CMPSecondaryUtils.hh"
+#include "G4CMPTrackUtils.hh"
+#include "G4ForceCondition.hh"
+#include "G4ParticleChange.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4VSolid.hh"
+#include "G4VTouchable.hh"
+#include "Randomize.hh"
+#include <cmath>
+#include <limits.h>
+
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4CMPPhononWeightControl::G4CMPPhononWeightControl(const G4String& name)
+  : G4VPhononProcess(name, fPhononWeight) {;}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Run on every step only if thresholds are configured
+
+G4double
+G4CMPPhononWeightControl::GetMeanFreePath(const G4Track&, G4double,
+					  G4ForceCondition* condition) {
+  *condition = ((RouletteEnabled() || SplittingEnabled()) ? StronglyForced
+		: NotForced);
+  return DBL_MAX;
+}
+
+G4double G4CMPPhononWeightControl::
+PostStepGetPhysicalInteractionLength(const G4Track& trk, G4double sl,
+				     G4ForceCondition* condition) {
+  return GetMeanFreePath(trk, sl, condition);	// No GPIL handling needed
+}
+
+G4bool G4CMPPhononWeightControl::RouletteEnabled() const {
+  return (G4CMPConfigManager::GetRouletteEnergy() > 0.);
+}
+
+G4bool G4CMPPhononWeightControl::SplittingEnabled() const {
+  return (G4CMPConfigManager::GetSplitWeight() > 0. &&
+	  G4CMPConfigManager::GetSplitDistance() > 0.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4VParticleChange*
+G4CMPPhononWeightControl::PostStepDoIt(const G4Track& track,
+				       const G4Step& step) {
+  aParticleChange.Initialize(track);
+
+  if (verboseLevel>1) G4cout << GetProcessName() << "::PostStepDoIt" << G4endl;
+
+  // Tracks absorbed at a surface, or otherwise killed, are left alone
+  if (track.GetTrackStatus() == fStopAndKill) return &aParticleChange;
+
+  G4double weight = track.GetWeight();
+  if (RouletteEnabled() && !ApplyRoulette(track, weight)) {
+    return &aParticleChange;
+  }
+
+  if (SplittingEnabled()) ApplySplitting(track, step, weight);
+
+  if (weight != track.GetWeight()) aParticleChange.ProposeWeight(weight);
+
+  return &aParticleChange;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Phonon energy and weight are fixed after creation, so roulette is only
+// played on the first step, whether or not that step ends on a surface.
+// Survivors carry the weight of killed tracks.
+
+G4bool G4CMPPhononWeightControl::ApplyRoulette(const G4Track& track,
+					       G4double& weight) {
+  if (track.GetCurrentStepNumber() != 1) return true;
+
+  // Copies produced by splitting must not be rouletted away again
+  if (track.GetCreatorProcess() == this) return true;
+
+  G4double eWeight = track.GetKineticEnergy() * weight;
+  G4double eRoulette = G4CMPConfigManager::GetRouletteEnergy();
+  if (eWeight >= eRoulette) return true;
+
+  G4double survive = eWeight / eRoulette;
+  if (G4UniformRand() < survive) {
+    weight /= survive;
+    if (verboseLevel>2)
+      G4cout << " phonon survived roulette, weight " << weight << G4endl;
+    return true;
+  }
+
+  if (verboseLevel>2) G4cout << " phonon killed by roulette" << G4endl;
+
+  aParticleChange.ProposeTrackStatus(fStopAndKill);
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Split phonon into copies with weight below threshold when it comes
+// within the configured distance of the volume surface.  Each copy will
+// sample its own scattering and reflection history from here on.
+//
+// On a boundary step the post-step point is in the next volume, but the
+// boundary process (registered earlier, so run first) has already moved
+// the track back to the surface and reflected it.  The pre-step volume is
+// used, and only phonons headed back into it are split.
+
+void G4CMPPhononWeightControl::ApplySplitting(const G4Track& track,
+					      const G4Step& step,
+					      G4double& weight) {
+  G4double wSplit = G4CMPConfigManager::GetSplitWeight();
+  if (weight <= wSplit) return;
+
+  const G4VTouchable* touch = step.GetPreStepPoint()->GetTouchable();
+  G4ThreeVector pos = track.GetPosition();
+  G4ThreeVector local = G4CMP::GetLocalPosition(touch, pos);
+
+  if (step.GetPostStepPoint()->GetStepStatus() == fGeomBoundary) {
+    G4ThreeVector vdir =
+      G4CMP::GetLocalDirection(touch, track.GetMomentumDirection());
+    if (vdir.dot(touch->GetSolid()->SurfaceNormal(local)) >= 0.) return;
+  } else if (touch->GetSolid()->DistanceToOut(local) >
+	     G4CMPConfigManager::GetSplitDistance()) {
+    return;
+  }
+
+  G4int nSplit = (G4int)std::ceil(weight / wSplit);
+  weight /= nSplit;
+
+  if (verboseLevel>2) {
+    G4cout << " phonon split into " << nSplit << " copies, weight "
+	   << weight << G4endl;
+  }
+
+  G4int mode = GetPolarization(track);
+  G4ThreeVector kdir =
+    G4CMP::GetLocalDirection(touch,
+		     G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(track)->k());
+
+  aParticleChange.SetSecondaryWeightByProcess(true);
+  aParticleChange.SetNumberOfSecondaries(nSplit-1);
+  for (G4int i=1; i<nSplit; i++) {
+    G4Track* sec = G4CMP::CreatePhonon(touch, mode, kdir,
+				       track.GetKineticEnergy(),
+				       track.GetGlobalTime(), pos);
+    if (!sec) continue;
+
+    sec->SetWeight(weight);
+    aParticleChange.AddSecondary(sec);
+  }
+}
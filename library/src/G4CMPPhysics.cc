@@ -17,6 +17,9 @@
 // 20200331  G4CMP-196: Added impact ionization process
 // 20200426  G4CMP-196: Change "impact" to "trap ionization", separate
 //		process instances for each beam/trap type.
+// 20201019  Optionally replace phonon scattering and downconversion with
+//		single G4PhononBulkInteraction process.
+// 20201022  Add phonon roulette and splitting process
 
 #include "G4CMPPhysics.hh"
 #include "G4CMPConfigManager.hh"
@@ -29,10 +32,12 @@
 #include "G4CMPInterValleyScattering.hh"
 #include "G4CMPLukeScattering.hh"
 #include "G4CMPPhononBoundaryProcess.hh"
+#include "G4CMPPhononWeightControl.hh"
 #include "G4CMPSecondaryProduction.hh"
 #include "G4CMPTimeStepper.hh"
 #include "G4CMPTrackLimiter.hh"
 #include "G4GenericIon.hh"
+#include "G4PhononBulkInteraction.hh"
 #include "G4ParticleTable.hh"
 #include "G4PhononDownconversion.hh"
 #include "G4PhononLong.hh"
@@ -64,9 +69,18 @@ void G4CMPPhysics::ConstructParticle() {
 
 void G4CMPPhysics::ConstructProcess() {
   // Only make processes once; will be deleted when physics list goes away
-  G4VProcess* phScat  = new G4PhononScattering;
+  G4VProcess* phScat  = 0;
+  G4VProcess* phDown  = 0;
+  G4VProcess* phBulk  = 0;
+  if (G4CMPConfigManager::CombinePhononBulk()) {
+    phBulk = new G4PhononBulkInteraction;
+  } else {
+    phScat = new G4PhononScattering;
+    phDown = new G4PhononDownconversion;
+  }
+
   G4VProcess* phRefl  = new G4CMPPhononBoundaryProcess;
-  G4VProcess* phDown  = new G4PhononDownconversion;
+  G4VProcess* phWght  = new G4CMPPhononWeightControl;
   G4VProcess* tmStep  = new G4CMPTimeStepper;
   G4VProcess* driftB  = new G4CMPDriftBoundaryProcess;
   G4VProcess* ivScat  = new G4CMPInterValleyScattering;
@@ -86,9 +100,11 @@ void G4CMPPhysics::ConstructProcess() {
 
   // Set process verbosity to match physics list, for diagnostics
   if (verboseLevel>0) {
-    phScat->SetVerboseLevel(verboseLevel);
+    if (phScat) phScat->SetVerboseLevel(verboseLevel);
+    if (phDown) phDown->SetVerboseLevel(verboseLevel);
+    if (phBulk) phBulk->SetVerboseLevel(verboseLevel);
     phRefl->SetVerboseLevel(verboseLevel);
-    phDown->SetVerboseLevel(verboseLevel);
+    phWght->SetVerboseLevel(verboseLevel);
     tmStep->SetVerboseLevel(verboseLevel);
     driftB->SetVerboseLevel(verboseLevel);
     ivScat->SetVerboseLevel(verboseLevel);
@@ -106,21 +122,21 @@ void G4CMPPhysics::ConstructProcess() {
 
   // Add processes only to locally known particles
   particle = G4PhononLong::PhononDefinition();
-  RegisterProcess(phScat, particle);
-  RegisterProcess(phDown, particle);
+  RegisterPhononBulk(phScat, phDown, phBulk, particle);
   RegisterProcess(phRefl, particle);
+  RegisterProcess(phWght, particle);
   RegisterProcess(eLimit, particle);
 
   particle = G4PhononTransSlow::PhononDefinition();
-  RegisterProcess(phScat, particle);
-  RegisterProcess(phDown, particle);
+  RegisterPhononBulk(phScat, phDown, phBulk, particle);
   RegisterProcess(phRefl, particle);
+  RegisterProcess(phWght, particle);
   RegisterProcess(eLimit, particle);
 
   particle = G4PhononTransFast::PhononDefinition();
-  RegisterProcess(phScat, particle);
-  RegisterProcess(phDown, particle);
+  RegisterPhononBulk(phScat, phDown, phBulk, particle);
   RegisterProcess(phRefl, particle);
+  RegisterProcess(phWght, particle);
   RegisterProcess(eLimit, particle);
 
   particle = edrift;
@@ -148,6 +164,17 @@ void G4CMPPhysics::ConstructProcess() {
 }
 
 
+// Register either the combined or separate phonon bulk processes
+
+void G4CMPPhysics::RegisterPhononBulk(G4VProcess* scat, G4VProcess* down,
+				      G4VProcess* bulk,
+				      G4ParticleDefinition* particle) {
+  if (bulk) RegisterProcess(bulk, particle);
+  if (scat) RegisterProcess(scat, particle);
+  if (down) RegisterProcess(down, particle);
+}
+
+
 // Add charge and phonon generator to all charged particles
 
 void G4CMPPhysics::AddSecondaryProduction() {
@@ -0,0 +1,27 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/src/G4CMPPrimaryInfo.cc
+/// \brief Implementation of the G4CMPPrimaryInfo class.  Carries the
+///   downsampling factors of an energy deposit on its primary particles.
+///
+// $Id$
+//
+// 20201111  New class to carry deposit sampling factors on primaries
+
+#include "globals.hh"
+#include "G4CMPPrimaryInfo.hh"
+
+
+// Initialize allocator
+
+G4ThreadLocal G4Allocator<G4CMPPrimaryInfo>* G4CMPPrimaryInfo_Allocator = 0;
+
+// Report contents for diagnostic purposes
+
+void G4CMPPrimaryInfo::Print() const {
+  G4cout << "G4CMPPrimaryInfo: sampling phonons " << phononSample
+	 << " charges " << chargeSample << " Luke " << lukeSample << G4endl;
+}
@@ -36,6 +36,8 @@
 // 20170620  Drop local caching of transforms; call through to G4CMPUtils.
 // 20170621  Drop local initialization of TrackInfo; StackingAction only
 // 20170624  Improve initialization from track, use Navigator to infer volume
+// 20201020  Use cached group velocity from phonon track info
+// 20201112  Phonon wavevector and cached velocity are in global frame
 
 #include "G4CMPProcessUtils.hh"
 #include "G4CMPDriftElectron.hh"
@@ -104,12 +106,11 @@ void G4CMPProcessUtils::LoadDataForTrack(const G4Track* track) {
       G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(*track);
 
     // Set momentum direction using already provided wavevector
-    G4ThreeVector kdir = trackInfo->k();
-
     const G4ParticleDefinition* pd = track->GetParticleDefinition();
     G4Track* tmp_track = const_cast<G4Track*>(track);
     tmp_track->SetMomentumDirection(
-      theLattice->MapKtoVDir(G4PhononPolarization::Get(pd), kdir));
+      trackInfo->VelocityDir(G4PhononPolarization::Get(pd),
+			     GetCurrentTouchable(), theLattice));
   }
 }
 
@@ -269,7 +270,8 @@ G4ThreeVector G4CMPProcessUtils::GetLocalWaveVector(const G4Track& track) const
   if (G4CMP::IsChargeCarrier(track)) {
     return GetLocalMomentum(track) / hbarc;
   } else if (G4CMP::IsPhonon(track)) {
-    return G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(track)->k();
+    auto trackInfo = G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(track);
+    return GetLocalDirection(trackInfo->k());	// Stored in global frame
   } else {
     G4Exception("G4CMPProcessUtils::GetLocalWaveVector", "DriftProcess002",
                 EventMustBeAborted, "Unknown charge carrier");
@@ -362,6 +364,21 @@ G4int G4CMPProcessUtils::GetPolarization(const G4Track& track) const {
 }
 
 
+// Phonon group velocity from track info, recomputed only if k changes
+
+G4ThreeVector 
+G4CMPProcessUtils::GetLocalPhononVelocityDir(const G4Track& track) const {
+  return GetLocalDirection(
+	   G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(track)->VelocityDir(
+		   GetPolarization(track), GetCurrentTouchable(), theLattice));
+}
+
+G4double G4CMPProcessUtils::GetPhononGroupSpeed(const G4Track& track) const {
+  return G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(track)->GroupSpeed(
+		   GetPolarization(track), GetCurrentTouchable(), theLattice);
+}
+
+
 // Generate random polarization from density of states
 
 G4int G4CMPProcessUtils::ChoosePhononPolarization() const {
@@ -0,0 +1,278 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/src/G4CMPRandomStream.cc
+/// \brief Implementation of the G4CMPRandomStream counter-based random
+///	engine, using the Philox-4x32-10 block function (Salmon et al.,
+///	"Parallel random numbers: as easy as 1, 2, 3", SC11).
+//
+// $Id$
+//
+// 20201030  New counter-based random stream for reproducible sampling
+// 20201111  Add Gaussian draws with per-stream cache; add event-level stream
+// 20201112  Key on run and event ID; count repeated calls within one step
+
+#include "G4CMPRandomStream.hh"
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4Track.hh"
+#include "Randomize.hh"
+#include <cmath>
+#include <fstream>
+
+namespace {
+  // Philox-4x32 multipliers and Weyl key increments
+  const uint32_t PhiloxM0 = 0xD2511F53;
+  const uint32_t PhiloxM1 = 0xCD9E8D57;
+  const uint32_t PhiloxW0 = 0x9E3779B9;
+  const uint32_t PhiloxW1 = 0xBB67AE85;
+  const G4int PhiloxRounds = 10;
+
+  const G4double twoToMinus53 = 1./9007199254740992.;
+
+  inline void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo) {
+    uint64_t product = (uint64_t)a * b;
+    hi = (uint32_t)(product >> 32);
+    lo = (uint32_t)product;
+  }
+
+  // Returns -1 outside of event processing
+  G4int CurrentEventID() {
+    const G4EventManager* evtMgr = G4EventManager::GetEventManager();
+    const G4Event* event = evtMgr ? evtMgr->GetConstCurrentEvent() : 0;
+    return event ? event->GetEventID() : -1;
+  }
+
+  // Event IDs restart with each run, so both are needed to identify event
+  G4int CurrentRunID() {
+    const G4RunManager* runMgr = G4RunManager::GetRunManager();
+    const G4Run* run = runMgr ? runMgr->GetCurrentRun() : 0;
+    return run ? run->GetRunID() : -1;
+  }
+}
+
+
+// Singleton construction
+
+G4CMPRandomStream* G4CMPRandomStream::Instance() {
+  static G4ThreadLocalSingleton<G4CMPRandomStream> theInstance;
+  return theInstance.Instance();
+}
+
+G4CMPRandomStream::G4CMPRandomStream()
+  : runID(-1), eventID(-1), eventKey(0), stepTrackID(-1), stepNumber(-1),
+    stepCalls(0), nextWord(4), streamSet(false), streamRunID(-1),
+    streamEventID(-1), haveGauss(false), nextGauss(0.) {
+  SetStream(0, 0, 0, 0);
+  streamSet = false;		// Default stream is only a placeholder
+}
+
+
+// Configure stream for current step of track.  Two processes sharing a
+// subtype, or one process called twice, must not replay the same numbers,
+// so calls are counted within each step.  The order of calls within a
+// step is fixed by the process list, so the count is reproducible.
+
+void G4CMPRandomStream::SetStream(const G4Track& track, G4int use) {
+  G4CMPRandomStream* rng = Instance();
+  uint64_t oldKey = rng->eventKey;
+  rng->UpdateEventKey();
+
+  G4int trackID = track.GetTrackID();
+  G4int stepID = track.GetCurrentStepNumber();
+  if (rng->eventKey == oldKey && trackID == rng->stepTrackID &&
+      stepID == rng->stepNumber) {
+    rng->stepCalls++;
+  } else {
+    rng->stepTrackID = trackID;
+    rng->stepNumber = stepID;
+    rng->stepCalls = 0;
+  }
+
+  rng->SetStream(rng->eventKey, trackID, stepID, use, rng->stepCalls);
+}
+
+// Use is kept in the low 16 bits, call count in the high 16 bits
+
+void G4CMPRandomStream::SetStream(uint64_t evtKey, G4int trackID,
+				  G4int stepID, G4int use, G4int call) {
+  key[0] = (uint32_t)evtKey;
+  key[1] = (uint32_t)(evtKey >> 32);
+
+  counter[0] = 0;
+  counter[1] = ((uint32_t)call << 16) ^ (uint32_t)use;
+  counter[2] = (uint32_t)stepID;
+  counter[3] = (uint32_t)trackID;
+
+  nextWord = 4;			// Force new block on next draw
+  haveGauss = false;		// Spare value belongs to previous stream
+
+  streamSet = true;
+  streamRunID = CurrentRunID();
+  streamEventID = CurrentEventID();
+}
+
+// Primaries have no track; use trackID 0 to separate them from tracks
+
+void G4CMPRandomStream::SelectEventStream(G4int use) {
+  G4CMPRandomStream* rng = Instance();
+  if (rng->streamSet && rng->streamEventID == CurrentEventID() &&
+      rng->streamRunID == CurrentRunID()) return;
+
+  rng->UpdateEventKey();
+  rng->SetStream(rng->eventKey, 0, 0, use);
+}
+
+// Geant4 reseeds its engine for each event, so this draw is reproducible.
+// Event IDs restart at zero in each run, so the run ID is also compared.
+// Outside of event processing a new key is drawn on every call.
+
+void G4CMPRandomStream::UpdateEventKey() {
+  G4int newEvent = CurrentEventID();
+  G4int newRun = CurrentRunID();
+  if (newEvent >= 0 && newEvent == eventID && newRun == runID) return;
+
+  CLHEP::HepRandomEngine* engine = G4Random::getTheEngine();
+  eventKey = ((uint64_t)(unsigned int)(*engine) << 32
+	      | (uint64_t)(unsigned int)(*engine));
+  runID = newRun;
+  eventID = newEvent;
+}
+
+
+// Encrypt current counter to produce four random words
+
+void G4CMPRandomStream::NextBlock() {
+  uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+  uint32_t k0 = key[0], k1 = key[1];
+  uint32_t hi0, lo0, hi1, lo1;
+
+  for (G4int i=0; i<PhiloxRounds; i++) {
+    mulhilo(PhiloxM0, c0, hi0, lo0);
+    mulhilo(PhiloxM1, c2, hi1, lo1);
+    c0 = hi1^c1^k0;
+    c1 = lo1;
+    c2 = hi0^c3^k1;
+    c3 = lo0;
+    k0 += PhiloxW0;
+    k1 += PhiloxW1;
+  }
+
+  block[0] = c0; block[1] = c1; block[2] = c2; block[3] = c3;
+  nextWord = 0;
+
+  counter[0]++;
+}
+
+
+// Uniform (0,1) with 53 bits of precision, two per block
+
+double G4CMPRandomStream::flat() {
+  if (nextWord > 2) NextBlock();
+
+  uint64_t bits = ((uint64_t)block[nextWord] << 32) | block[nextWord+1];
+  nextWord += 2;
+
+  return ((bits >> 11) + 0.5) * twoToMinus53;
+}
+
+void G4CMPRandomStream::flatArray(const int size, double* vect) {
+  for (int i=0; i<size; i++) vect[i] = flat();
+}
+
+G4ThreeVector G4CMPRandomStream::RandomDirection() {
+  G4double cost = 2.*flat() - 1.;
+  G4double sint = std::sqrt((1.-cost)*(1.+cost));
+  G4double phi = twopi*flat();
+
+  return G4ThreeVector(sint*std::cos(phi), sint*std::sin(phi), cost);
+}
+
+
+// Box-Muller pairs; flat() never returns zero, so log() is safe
+
+G4double G4CMPRandomStream::Gauss(G4double mean, G4double sigma) {
+  if (haveGauss) {
+    haveGauss = false;
+    return mean + sigma*nextGauss;
+  }
+
+  G4double r = std::sqrt(-2.*std::log(flat()));
+  G4double phi = twopi*flat();
+
+  nextGauss = r*std::sin(phi);
+  haveGauss = true;
+
+  return mean + sigma*r*std::cos(phi);
+}
+
+void G4CMPRandomStream::GaussArray(G4int size, G4double* vect,
+				   G4double mean, G4double sigma) {
+  for (G4int i=0; i<size; i++) vect[i] = Gauss(mean, sigma);
+}
+
+
+// Seeds replace the event key, for standalone use outside of tracking
+
+void G4CMPRandomStream::setSeed(long seed, int) {
+  theSeed = seed;
+  runID = eventID = -1;
+  eventKey = (uint64_t)seed;
+  SetStream(eventKey, 0, 0, 0);
+}
+
+void G4CMPRandomStream::setSeeds(const long* seeds, int) {
+  if (!seeds || seeds[0] == 0) return;
+
+  theSeeds = seeds;
+  runID = eventID = -1;
+  eventKey = (uint64_t)(uint32_t)seeds[0];
+  if (seeds[1] != 0) eventKey |= (uint64_t)(uint32_t)seeds[1] << 32;
+  SetStream(eventKey, 0, 0, 0);
+}
+
+
+// Save and restore key and counter, for debugging
+
+void G4CMPRandomStream::saveStatus(const char filename[]) const {
+  std::ofstream out(filename);
+  if (!out) return;
+
+  out << name() << "\n" << key[0] << " " << key[1];
+  for (G4int i=0; i<4; i++) out << " " << counter[i];
+  out << " " << nextWord << std::endl;
+}
+
+void G4CMPRandomStream::restoreStatus(const char filename[]) {
+  std::ifstream in(filename);
+  if (!in) return;
+
+  std::string engineName;
+  in >> engineName;
+  if (engineName != name()) return;
+
+  in >> key[0] >> key[1];
+  for (G4int i=0; i<4; i++) in >> counter[i];
+  in >> nextWord;
+  haveGauss = false;
+
+  // Regenerate block currently being used
+  if (nextWord < 4) {
+    G4int used = nextWord;
+    counter[0]--;
+    NextBlock();
+    nextWord = used;
+  }
+}
+
+void G4CMPRandomStream::showStatus() const {
+  G4cout << "G4CMPRandomStream key " << key[0] << " " << key[1]
+	 << " counter " << counter[0] << " " << counter[1] << " "
+	 << counter[2] << " " << counter[3] << " word " << nextWord
+	 << G4endl;
+}
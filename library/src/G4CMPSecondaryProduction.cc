@@ -15,12 +15,19 @@
 // 20160825  Replace implementation with use of G4CMPEnergyPartition
 // 20191007  All normal G4 tracks should be used, not just charged.
 // 20200222  Enable collection of EnergyPartition summary data.
+// 20201029  Add optional energy-weighted clusters of secondaries along step
+// 20201030  Replace std::random_shuffle with shuffle from G4CMPRandomStream
+// 20201110  Deposit energy of phonons below tracking threshold
+// 20201111  Use Gaussian draws from stream, without shared static cache
 
 #include "G4CMPSecondaryProduction.hh"
+#include "G4CMPChargeCloud.hh"
+#include "G4CMPConfigManager.hh"
 #include "G4CMPEnergyPartition.hh"
 #include "G4CMPDriftElectron.hh"
 #include "G4CMPDriftHole.hh"
 #include "G4CMPProcessSubType.hh"
+#include "G4CMPRandomStream.hh"
 #include "G4CMPUtils.hh"
 #include "G4IonisParamMat.hh"
 #include "G4LatticeManager.hh"
@@ -39,6 +46,7 @@
 #include "G4VProcess.hh"
 #include "Randomize.hh"
 #include <algorithm>
+#include <cmath>
 #include <vector>
 
 
@@ -46,13 +54,14 @@
 
 G4CMPSecondaryProduction::G4CMPSecondaryProduction()
   : G4VContinuousProcess("G4CMPSecondaryProduction", fPhonon),
-    partitioner(new G4CMPEnergyPartition) {
+    partitioner(new G4CMPEnergyPartition), cloud(new G4CMPChargeCloud) {
   SetProcessSubType(fSecondaryProduction);
   partitioner->FillSummary(true);	// Collect partition summary data
 }
 
 G4CMPSecondaryProduction::~G4CMPSecondaryProduction() {
   delete partitioner;
+  delete cloud;
 }
 
 
@@ -83,6 +92,9 @@ void G4CMPSecondaryProduction::LoadDataForTrack(const G4Track* track) {
   *(G4CMPProcessUtils*)partitioner = *(G4CMPProcessUtils*)this;
   partitioner->UseVolume(GetCurrentVolume());
   partitioner->SetVerboseLevel(verboseLevel);
+
+  cloud->SetTouchable(GetCurrentTouchable());
+  cloud->SetVerboseLevel(verboseLevel);
 }
 
 
@@ -119,11 +131,26 @@ void G4CMPSecondaryProduction::AddSecondaries(const G4Step& stepData) {
 	   << " (" << eNIEL << " NIEL)" << G4endl;
   }
 
+  // All sampling for this step is reproducible from event and track IDs
+  G4CMPRandomStream::SetStream(*stepData.GetTrack(), GetProcessSubType());
+
   // Configure energy partitioning for EM, nuclear, or pre-determined energy
   G4int ptype = stepData.GetTrack()->GetParticleDefinition()->GetPDGEncoding();
   partitioner->DoPartition(ptype, eTotal, eNIEL);
   partitioner->GetSecondaries(theSecs);
-  std::random_shuffle(theSecs.begin(), theSecs.end(), RandomIndex);
+
+  // Phonons too soft to track are deposited here, as G4CMPTrackLimiter
+  // would have done on their first step
+  if (partitioner->GetSkippedEnergy() > 0.) {
+    aParticleChange.ProposeNonIonizingEnergyDeposit(
+      aParticleChange.GetNonIonizingEnergyDeposit() +
+      partitioner->GetSkippedEnergy());
+  }
+
+  // Fisher-Yates shuffle, so that positions are not ordered by type
+  for (size_t i=theSecs.size(); i>1; i--) {
+    std::swap(theSecs[i-1], theSecs[RandomIndex(i)]);
+  }
 
   size_t nsec = theSecs.size();
   GeneratePositions(stepData, nsec);
@@ -155,6 +182,12 @@ void G4CMPSecondaryProduction::GeneratePositions(const G4Step& stepData,
 						 size_t nsec) {
   if (verboseLevel>1) G4cout << " GeneratePositions " << nsec << G4endl;
 
+  size_t nclus = std::max(G4CMPConfigManager::GetSecondaryClusters(), 0);
+  if (nclus > 0 && nclus < nsec) {
+    GenerateClusters(stepData, nsec, nclus);
+    return;
+  }
+
   // Get average distance between secondaries along (straight) trajectory
   G4ThreeVector prePos  = stepData.GetPreStepPoint()->GetPosition();
   G4ThreeVector postPos = stepData.GetPostStepPoint()->GetPosition();
@@ -170,19 +203,89 @@ void G4CMPSecondaryProduction::GeneratePositions(const G4Step& stepData,
 	   << ": steps " << dl << " +- " << sigl << " mm" << G4endl;
   }
 
+  // Draw all substeps in one call, then accumulate along trajectory
+  randBuf.resize(nsec);
+  G4CMPRandomStream::Instance()->GaussArray((G4int)nsec, randBuf.data(),
+					    dl, sigl);
+
   posSecs.clear();
   posSecs.reserve(nsec);
 
-  G4double substep = 0.;
   G4ThreeVector lastPos = prePos;
   for (size_t i=0; i<nsec; i++) {
-    substep = G4RandGauss::shoot(dl, sigl);
-    lastPos += substep*tdir;
+    lastPos += randBuf[i]*tdir;
     posSecs.push_back(lastPos);
   }
 }
 
 
+// Divide step into segments of equal energy loss, and put one cluster in
+// each segment.  Secondaries are already shuffled, so assigning them in
+// turn gives each cluster about the same energy.  Phonons are placed at
+// the cluster center; charges are spread around it in a charge cloud.
+
+void G4CMPSecondaryProduction::GenerateClusters(const G4Step& stepData,
+						size_t nsec, size_t nclus) {
+  if (verboseLevel>1) G4cout << " GenerateClusters " << nclus << G4endl;
+
+  const G4StepPoint* preStep  = stepData.GetPreStepPoint();
+  const G4StepPoint* postStep = stepData.GetPostStepPoint();
+
+  G4ThreeVector prePos = preStep->GetPosition();
+  G4ThreeVector traj = postStep->GetPosition() - prePos;
+
+  // Stopping power rises as 1/T (Bethe, non-relativistic) as track slows;
+  // take it to change linearly along the step, limited near end of range
+  const G4double maxRatio = 10.;
+
+  G4double preE  = preStep->GetKineticEnergy();
+  G4double postE = postStep->GetKineticEnergy();
+  G4double ratio = (postE > preE/maxRatio) ? preE/postE : maxRatio;
+  G4double slope = ratio - 1.;		// dE/dx = 1 + slope*x, x = [0,1]
+
+  if (verboseLevel>1) {
+    G4cout << " Clusters along " << traj.mag()/mm << " mm, dE/dx rises by "
+	   << ratio << G4endl;
+  }
+
+  // One stratified random point within each segment of energy loss
+  randBuf.resize(nclus);
+  G4CMPRandomStream::Instance()->flatArray((G4int)nclus, randBuf.data());
+
+  posSecs.resize(nsec);
+  for (size_t j=0; j<nclus; j++) {
+    G4double qloss = (j + randBuf[j]) / nclus;
+    G4ThreeVector center = prePos + EnergyLossFraction(qloss, slope)*traj;
+
+    size_t nq = 0;
+    for (size_t i=j; i<nsec; i+=nclus) {
+      posSecs[i] = center;
+      if (G4CMP::IsChargeCarrier(theSecs[i])) nq++;
+    }
+
+    if (nq == 0) continue;
+
+    cloud->Generate((G4int)nq, center);
+
+    size_t iq = 0;
+    for (size_t i=j; i<nsec; i+=nclus) {
+      if (G4CMP::IsChargeCarrier(theSecs[i]))
+	posSecs[i] = cloud->GetPosition(iq++);
+    }
+  }
+}
+
+// Invert cumulative energy loss, (x + slope*x^2/2)/(1 + slope/2) = qloss
+
+G4double 
+G4CMPSecondaryProduction::EnergyLossFraction(G4double qloss,
+					     G4double slope) const {
+  if (std::fabs(slope) < 1e-6) return qloss;	// Uniform energy loss
+
+  return (std::sqrt(1. + slope*(2.+slope)*qloss) - 1.) / slope;
+}
+
+
 // Calculate step limit for Along Step (not needed here)
 
 G4double 
@@ -197,5 +300,5 @@ G4CMPSecondaryProduction::GetContinuousStepLimit(const G4Track& /*aTrack*/,
 // Generate random index for shuffling secondaries
 
 size_t G4CMPSecondaryProduction::RandomIndex(size_t n) {
-  return (size_t)(n*G4UniformRand());
+  return (size_t)(n*G4CMPRandomStream::Instance()->flat());
 }
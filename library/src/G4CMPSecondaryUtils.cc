@@ -10,8 +10,10 @@
 // 20170721 M. Kelsey -- Check volume in AdjustSecondaryPosition.
 // 20170815 M. Kelsey -- Move AdjustSecondaryPosition to GeometryUtils
 // 20170928 M. Kelsey -- Replace "polarization" with "mode"
+// 20201027 Add SecondaryContext to share lattice, clearance across batches
 
 #include "G4CMPSecondaryUtils.hh"
+#include "G4CMPConfigManager.hh"
 #include "G4CMPDriftHole.hh"
 #include "G4CMPDriftElectron.hh"
 #include "G4CMPDriftTrackInfo.hh"
@@ -22,6 +24,7 @@
 #include "G4GeometryTolerance.hh"
 #include "G4LatticeManager.hh"
 #include "G4LatticePhysical.hh"
+#include "G4LogicalVolume.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4PhononPolarization.hh"
 #include "G4PhysicalConstants.hh"
@@ -29,25 +32,91 @@
 #include "G4Threading.hh"
 #include "G4Track.hh"
 #include "G4VPhysicalVolume.hh"
+#include "G4VSolid.hh"
 #include "G4VTouchable.hh"
 
 
+// Shared volume information for creating secondaries
+
+G4CMP::SecondaryContext::SecondaryContext(const G4VTouchable* touchable)
+  : touch(touchable), lattice(0), safety(0.) {
+  if (!touch) return;
+
+  G4ThreadLocalStatic auto latMan = G4LatticeManager::GetLatticeManager();
+  lattice = latMan->GetLattice(touch->GetVolume());
+}
+
+G4CMP::SecondaryContext::SecondaryContext(const G4VTouchable* touchable,
+					  const G4ThreeVector& pos)
+  : SecondaryContext(touchable) {
+  if (!touch) return;
+
+  // Positions closer to center than this are guaranteed to be Inside
+  center = pos;
+  const G4VSolid* solid = touch->GetVolume()->GetLogicalVolume()->GetSolid();
+  safety = solid->DistanceToOut(GetLocalPosition(touch, center))
+    - G4CMPConfigManager::GetSurfaceClearance();
+  if (safety < 0.) safety = 0.;
+}
+
+G4ThreeVector
+G4CMP::SecondaryContext::ApplyClearance(const G4ThreeVector& pos) const {
+  return ((pos-center).mag2() < safety*safety ? pos
+	  : ApplySurfaceClearance(touch, pos));
+}
+
+
+// Create secondaries with lattice and transforms looked up for each track
+
 G4Track* G4CMP::CreateSecondary(const G4Track& track,
                                 G4ParticleDefinition* pd,
                                 const G4ThreeVector& waveVec,
                                 G4double energy) {
+  return CreateSecondary(SecondaryContext(track.GetTouchable()), pd, waveVec,
+			 energy, track.GetGlobalTime(), track.GetPosition());
+}
+
+G4Track* G4CMP::CreatePhonon(const G4VTouchable* touch, G4int mode,
+                             const G4ThreeVector& waveVec,
+                             G4double energy, G4double time, const G4ThreeVector& pos) {
+  return CreatePhonon(SecondaryContext(touch), mode, waveVec, energy, time, pos);
+}
+
+G4Track* G4CMP::CreateChargeCarrier(const G4VTouchable* touch, G4int charge,
+                                    G4int valley, G4double Ekin, G4double time,
+                                    const G4ThreeVector& pdir,
+                                    const G4ThreeVector& pos) {
+  return CreateChargeCarrier(SecondaryContext(touch), charge, valley, Ekin,
+			     time, pdir, pos);
+}
+
+G4Track* G4CMP::CreateChargeCarrier(const G4VTouchable* touch, G4int charge,
+                                    G4int valley, G4double time,
+                                    const G4ThreeVector& p,
+                                    const G4ThreeVector& pos) {
+  return CreateChargeCarrier(SecondaryContext(touch), charge, valley, time,
+			     p, pos);
+}
+
+
+// Create secondaries using shared volume information
+
+G4Track* G4CMP::CreateSecondary(const SecondaryContext& ctx,
+                                G4ParticleDefinition* pd,
+                                const G4ThreeVector& waveVec,
+                                G4double energy, G4double time,
+				const G4ThreeVector& pos) {
   if (G4CMP::IsPhonon(pd)) {
-    return CreatePhonon(track.GetTouchable(), G4PhononPolarization::Get(pd),
-                        waveVec, energy, track.GetGlobalTime(), track.GetPosition());
+    return CreatePhonon(ctx, G4PhononPolarization::Get(pd), waveVec, energy,
+			time, pos);
   }
 
   if (G4CMP::IsChargeCarrier(pd)) {
-    const G4LatticePhysical* lat = G4CMP::GetLattice(track);
-    G4int valley = G4CMP::IsElectron(pd) ? ChooseValley(lat) : -1;
+    G4int valley = (G4CMP::IsElectron(pd) && ctx.lattice)
+      ? ChooseValley(ctx.lattice) : -1;
 
-    return CreateChargeCarrier(track.GetTouchable(), G4int(pd->GetPDGCharge()/eplus),
-                               valley, energy, track.GetGlobalTime(),
-                               waveVec, track.GetPosition());
+    return CreateChargeCarrier(ctx, G4int(pd->GetPDGCharge()/eplus),
+                               valley, energy, time, waveVec, pos);
   }
 
   G4Exception("G4CMP::CreateSecondary", "Secondary001", EventMustBeAborted,
@@ -56,15 +125,13 @@ G4Track* G4CMP::CreateSecondary(const G4Track& track,
   return nullptr;
 }
 
-G4Track* G4CMP::CreatePhonon(const G4VTouchable* touch, G4int mode,
+G4Track* G4CMP::CreatePhonon(const SecondaryContext& ctx, G4int mode,
                              const G4ThreeVector& waveVec,
                              G4double energy, G4double time, const G4ThreeVector& pos) {
-  G4VPhysicalVolume* vol = touch->GetVolume();
-  G4ThreadLocalStatic auto latMan = G4LatticeManager::GetLatticeManager();
-  G4LatticePhysical* lat = latMan->GetLattice(vol);
+  const G4LatticePhysical* lat = ctx.lattice;
   if (!lat) {
     G4Exception("G4CMP::CreatePhonon", "Secondary002", EventMustBeAborted,
-                ("No lattice for volume "+vol->GetName()).c_str());
+                ("No lattice for volume "+ctx.touch->GetVolume()->GetName()).c_str());
     return nullptr;
   }
 
@@ -81,13 +148,13 @@ G4Track* G4CMP::CreatePhonon(const G4VTouchable* touch, G4int mode,
   G4ParticleDefinition* thePhonon = G4PhononPolarization::Get(mode);
 
   // Secondaries are (usually) created at the current track coordinates
-  RotateToGlobalDirection(touch, vgroup);
+  RotateToGlobalDirection(ctx.touch, vgroup);
 
   auto sec = new G4Track(new G4DynamicParticle(thePhonon, vgroup, energy),
-                         time, G4CMP::ApplySurfaceClearance(touch, pos));
+                         time, ctx.ApplyClearance(pos));
 
   // Store wavevector in auxiliary info for track
-  AttachTrackInfo(sec, GetGlobalDirection(touch, waveVec));
+  AttachTrackInfo(sec, GetGlobalDirection(ctx.touch, waveVec));
 
   sec->SetVelocity(lat->MapKtoV(mode, waveVec));
   sec->UseGivenVelocity(true);
@@ -95,16 +162,14 @@ G4Track* G4CMP::CreatePhonon(const G4VTouchable* touch, G4int mode,
   return sec;
 }
 
-G4Track* G4CMP::CreateChargeCarrier(const G4VTouchable* touch, G4int charge,
+G4Track* G4CMP::CreateChargeCarrier(const SecondaryContext& ctx, G4int charge,
                                     G4int valley, G4double Ekin, G4double time,
                                     const G4ThreeVector& pdir,
                                     const G4ThreeVector& pos) {
-  G4VPhysicalVolume* vol = touch->GetVolume();
-  G4ThreadLocalStatic auto latMan = G4LatticeManager::GetLatticeManager();
-  G4LatticePhysical* lat = latMan->GetLattice(vol);
+  const G4LatticePhysical* lat = ctx.lattice;
   if (!lat) {
     G4Exception("G4CMP::CreateChargeCarrier", "Secondary003", EventMustBeAborted,
-                ("No lattice for volume "+vol->GetName()).c_str());
+                ("No lattice for volume "+ctx.touch->GetVolume()->GetName()).c_str());
     return nullptr;
   }
 
@@ -116,12 +181,12 @@ G4Track* G4CMP::CreateChargeCarrier(const G4VTouchable* touch, G4int charge,
 
   if (charge == 1) { // Hole
     G4double pmag = std::sqrt(2. * Ekin * lat->GetHoleMass());
-    return CreateChargeCarrier(touch, charge, valley, time, pmag * pdir, pos);
+    return CreateChargeCarrier(ctx, charge, valley, time, pmag * pdir, pos);
   } else if (charge == -1) { // Electron
     G4double k_HVmag = std::sqrt(2. * Ekin * lat->GetElectronMass()) / hbar_Planck;
     G4ThreeVector k_HVdir = lat->MapV_elToK_HV(valley, pdir).unit();
     G4ThreeVector p = lat->MapK_HVtoP(valley, k_HVmag * k_HVdir);
-    return CreateChargeCarrier(touch, charge, valley, time, p, pos);
+    return CreateChargeCarrier(ctx, charge, valley, time, p, pos);
   }
 
   G4Exception("G4CMP::CreateChargeCarrier", "Secondary005", EventMustBeAborted,
@@ -129,16 +194,14 @@ G4Track* G4CMP::CreateChargeCarrier(const G4VTouchable* touch, G4int charge,
   return nullptr;
 }
 
-G4Track* G4CMP::CreateChargeCarrier(const G4VTouchable* touch, G4int charge,
+G4Track* G4CMP::CreateChargeCarrier(const SecondaryContext& ctx, G4int charge,
                                     G4int valley, G4double time,
                                     const G4ThreeVector& p,
                                     const G4ThreeVector& pos) {
-  G4VPhysicalVolume* vol = touch->GetVolume();
-  G4ThreadLocalStatic auto latMan = G4LatticeManager::GetLatticeManager();
-  G4LatticePhysical* lat = latMan->GetLattice(vol);
+  const G4LatticePhysical* lat = ctx.lattice;
   if (!lat) {
     G4Exception("G4CMP::CreateChargeCarrier", "Secondary006", EventMustBeAborted,
-                ("No lattice for volume "+vol->GetName()).c_str());
+                ("No lattice for volume "+ctx.touch->GetVolume()->GetName()).c_str());
     return nullptr;
   }
 
@@ -160,9 +223,9 @@ G4Track* G4CMP::CreateChargeCarrier(const G4VTouchable* touch, G4int charge,
   } else {
     theCarrier    = G4CMPDriftElectron::Definition();
     carrierMass   = lat->GetElectronMass();
-    G4ThreeVector p_local = G4CMP::GetLocalDirection(touch, p);
+    G4ThreeVector p_local = G4CMP::GetLocalDirection(ctx.touch, p);
     G4ThreeVector v_local = lat->MapPtoV_el(valley, p_local);
-    RotateToGlobalDirection(touch, v_local); // v_local is now actually global
+    RotateToGlobalDirection(ctx.touch, v_local); // v_local is now actually global
     carrierEnergy = 0.5 * carrierMass * v_local.mag2();// Non-relativistic
     v_unit = v_local.unit();
   }
@@ -171,7 +234,7 @@ G4Track* G4CMP::CreateChargeCarrier(const G4VTouchable* touch, G4int charge,
   auto secDP = new G4DynamicParticle(theCarrier, v_unit, carrierEnergy,
 				     carrierMass*c_squared);
 
-  auto sec = new G4Track(secDP, time, G4CMP::ApplySurfaceClearance(touch, pos));
+  auto sec = new G4Track(secDP, time, ctx.ApplyClearance(pos));
 
   // Store wavevector in auxiliary info for track
   G4CMP::AttachTrackInfo(sec, valley);
@@ -20,13 +20,21 @@
 // 20170620 Drop obsolete SetTransforms() call
 // 20170624 Clean up track initialization
 // 20170928 Replace "polarization" with "mode"
+// 20201020 Use cached phonon group velocity from track info
+// 20201111 Copy sampling factors from G4CMPPrimaryInfo to track info
+// 20201112 Use volume placement to map global wavevector to velocity
+// 20201112 Create staged tracks from G4CMPPendingTracks at each new stage
 
 #include "G4CMPStackingAction.hh"
 
+#include "G4CMPConfigManager.hh"
 #include "G4CMPDriftHole.hh"
 #include "G4CMPDriftElectron.hh"
 #include "G4CMPDriftTrackInfo.hh"
+#include "G4CMPGeometryUtils.hh"
+#include "G4CMPPendingTracks.hh"
 #include "G4CMPPhononTrackInfo.hh"
+#include "G4CMPPrimaryInfo.hh"
 #include "G4CMPTrackUtils.hh"
 #include "G4CMPUtils.hh"
 #include "G4LatticeManager.hh"
@@ -37,13 +45,16 @@
 #include "G4PhononTransFast.hh"
 #include "G4PhononTransSlow.hh"
 #include "G4PhysicalConstants.hh"
+#include "G4PrimaryParticle.hh"
 #include "G4RandomDirection.hh"
+#include "G4StackManager.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4ThreeVector.hh"
 #include "G4Track.hh"
 #include "G4TrackStatus.hh"
 #include "G4VPhysicalVolume.hh"
 #include "Randomize.hh"
+#include <algorithm>
 
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
@@ -82,6 +93,8 @@ G4CMPStackingAction::ClassifyNewTrack(const G4Track* aTrack) {
       SetChargeCarrierMass(aTrack);
       if (IsElectron()) SetElectronEnergy(aTrack);
     }
+
+    if (IsPhonon() || IsChargeCarrier()) SetSampling(aTrack);
   }
 
   ReleaseTrack();
@@ -89,27 +102,60 @@ G4CMPStackingAction::ClassifyNewTrack(const G4Track* aTrack) {
   return classification; 
 }
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Large energy deposits hold back particles beyond the batch size; these
+// are pushed (and classified above) when all earlier tracks are finished
+
+void G4CMPStackingAction::NewStage() {
+  size_t nPending = G4CMPPendingTracks::Entries();
+  if (nPending == 0) return;
+
+  G4int batch = G4CMPConfigManager::GetTrackBatch();
+  size_t nMax = (batch > 0 ? std::min(nPending, size_t(batch)) : nPending);
+
+  if (G4CMPConfigManager::GetVerboseLevel()) {
+    G4cout << "G4CMPStackingAction::NewStage creating " << nMax << " of "
+	   << nPending << " staged tracks" << G4endl;
+  }
+
+  stagedTracks.clear();
+  G4CMPPendingTracks::CreateTracks(stagedTracks, nMax);
+
+  for (G4Track* track: stagedTracks) stackManager->PushOneTrack(track);
+  stagedTracks.clear();
+}
+
 // Set velocity of phonon track appropriately for material
 
 void G4CMPStackingAction::SetPhononVelocity(const G4Track* aTrack) const {
   // Get wavevector associated with track
-  G4ThreeVector k = G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(*aTrack)->k();
+  auto trackInfo = G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(*aTrack);
   G4int mode = GetPolarization(aTrack);
 
-  // Compute direction of propagation from wave vector
+  // Primary tracks are not yet located, so find touchable for placement
+  const G4VTouchable* touch = aTrack->GetTouchable();
+  G4VTouchable* newTouch = 0;
+  if (!touch) {
+    newTouch = G4CMP::CreateTouchableAtPoint(aTrack->GetPosition());
+    touch = newTouch;
+  }
+
+  // Compute direction of propagation from (global) wave vector
   // Geant4 thinks that momentum and velocity point in same direction,
   // momentumDir here actually means velocity direction.
-  G4ThreeVector momentumDir = theLattice->MapKtoVDir(mode, k);
+  G4ThreeVector momentumDir = trackInfo->VelocityDir(mode, touch, theLattice);
+
+  //Compute true velocity of propagation
+  G4double velocity = trackInfo->GroupSpeed(mode, touch, theLattice);
+  delete newTouch;
 
   if (momentumDir.mag() < 0.9) {
-    G4cerr << " track mode " << mode << " k " << k << G4endl;
+    G4cerr << " track mode " << mode << " k " << trackInfo->k() << G4endl;
     G4Exception("G4CMPStackingAction::SetPhononVelocity", "Lattice010",
 		FatalException, "KtoVDir failed to return unit vector");
     return;
   }
-
-  //Compute true velocity of propagation
-  G4double velocity = theLattice->MapKtoV(mode, k);
   
   // Cast to non-const pointer so we can adjust non-standard kinematics
   G4Track* theTrack = const_cast<G4Track*>(aTrack);
@@ -121,6 +167,24 @@ void G4CMPStackingAction::SetPhononVelocity(const G4Track* aTrack) const {
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
+// Copy downsampling factors of primary's energy deposit, if any
+
+void G4CMPStackingAction::SetSampling(const G4Track* aTrack) const {
+  const G4PrimaryParticle* prim =
+    aTrack->GetDynamicParticle()->GetPrimaryParticle();
+  if (!prim) return;
+
+  auto primInfo =
+    dynamic_cast<const G4CMPPrimaryInfo*>(prim->GetUserInformation());
+  if (!primInfo) return;
+
+  G4CMP::GetTrackInfo<G4CMPVTrackInfo>(*aTrack)->
+    SetSampling(primInfo->PhononSampling(), primInfo->ChargeSampling(),
+		primInfo->LukeSampling());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
 // Set dynamical mass of charge carrier to scalar value for material
 
 void G4CMPStackingAction::SetChargeCarrierMass(const G4Track* aTrack) const {
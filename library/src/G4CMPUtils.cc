@@ -14,6 +14,7 @@
 // 20170802  Provide scale factor argument to ChooseWeight functions
 // 20170928  Replace "polarization" with "mode"
 // 20190906  M. Kelsey -- Add function to look up process for track
+// 20201107  FillHit() stores particle definition, not name
 
 #include "G4CMPUtils.hh"
 #include "G4CMPConfigManager.hh"
@@ -156,7 +157,7 @@ void G4CMP::FillHit(const G4Step* step, G4CMPElectrodeHit* hit) {
   // Get information from the track
   G4Track* track     = step->GetTrack();
   G4int trackID      = track->GetTrackID();
-  G4String name      = track->GetDefinition()->GetParticleName();
+  const G4ParticleDefinition* pd = track->GetParticleDefinition();
   G4double startE    = track->GetVertexKineticEnergy();
   G4double startTime = track->GetGlobalTime() - track->GetLocalTime();
   G4double finalTime = track->GetGlobalTime();
@@ -178,7 +179,7 @@ void G4CMP::FillHit(const G4Step* step, G4CMPElectrodeHit* hit) {
   hit->SetStartPosition(startPosition);
   hit->SetFinalPosition(finalPosition);
   hit->SetTrackID(trackID);
-  hit->SetParticleName(name);
+  hit->SetParticle(pd);
 }
 
 
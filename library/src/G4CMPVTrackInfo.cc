@@ -12,12 +12,35 @@
 // $Id$
 //
 // 20161111 Initial commit - R. Agnese
+// 20201025 Carry downsampling factors from energy partitioning
 
 #include "G4CMPVTrackInfo.hh"
+#include "G4CMPConfigManager.hh"
 
 G4CMPVTrackInfo::G4CMPVTrackInfo(const G4LatticePhysical* lat) :
   G4VAuxiliaryTrackInformation(), lattice(lat) {}
 
+// Sampling factors are set only for tracks from G4CMPEnergyPartition
+
+G4double G4CMPVTrackInfo::PhononSampling() const {
+  return (phononSample<0. ? G4CMPConfigManager::GetGenPhonons() : phononSample);
+}
+
+G4double G4CMPVTrackInfo::ChargeSampling() const {
+  return (chargeSample<0. ? G4CMPConfigManager::GetGenCharges() : chargeSample);
+}
+
+G4double G4CMPVTrackInfo::LukeSampling() const {
+  return (lukeSample<0. ? G4CMPConfigManager::GetLukeSampling() : lukeSample);
+}
+
+void G4CMPVTrackInfo::SetSampling(G4double phonon, G4double charge,
+				  G4double luke) {
+  phononSample = phonon;
+  chargeSample = charge;
+  lukeSample = luke;
+}
+
 void G4CMPVTrackInfo::Print() const {
 //TODO
 }
@@ -0,0 +1,91 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+/// \file library/src/G4PhononBulkInteraction.cc
+/// \brief Implementation of the G4PhononBulkInteraction class
+//
+// $Id$
+//
+// 20201019  New process to replace separate scattering and downconversion
+// 20201112  Share loaded track data with delegates, instead of reloading
+
+#include "G4PhononBulkInteraction.hh"
+#include "G4CMPPhononBulkRate.hh"
+#include "G4PhononDownconversion.hh"
+#include "G4PhononScattering.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Track.hh"
+#include "G4VParticleChange.hh"
+#include "Randomize.hh"
+
+
+G4PhononBulkInteraction::G4PhononBulkInteraction(const G4String& aName)
+  : G4VPhononProcess(aName, fPhononBulk), bulkRate(new G4CMPPhononBulkRate),
+    scattering(new G4PhononScattering),
+    downconversion(new G4PhononDownconversion) {
+  UseRateModel(bulkRate);
+}
+
+G4PhononBulkInteraction::~G4PhononBulkInteraction() {
+  delete scattering; scattering=0;
+  delete downconversion; downconversion=0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Track data are loaded once, here, and copied to the delegates.  Their
+// own rate models are never used, so they need no configuration.
+
+void G4PhononBulkInteraction::StartTracking(G4Track* track) {
+  G4VPhononProcess::StartTracking(track);
+
+  scattering->SetVerboseLevel(verboseLevel);
+  static_cast<G4CMPProcessUtils&>(*scattering) = *this;
+
+  downconversion->SetVerboseLevel(verboseLevel);
+  static_cast<G4CMPProcessUtils&>(*downconversion) = *this;
+}
+
+void G4PhononBulkInteraction::EndTracking() {
+  G4VPhononProcess::EndTracking();
+  scattering->ReleaseTrack();
+  downconversion->ReleaseTrack();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Rates were computed for this step by GetMeanFreePath(); use them to
+// choose which interaction occurs, and let that process do the work
+
+G4VParticleChange* G4PhononBulkInteraction::PostStepDoIt(const G4Track& aTrack,
+							 const G4Step& aStep) {
+  G4StepPoint* postStepPoint = aStep.GetPostStepPoint();
+  if (postStepPoint->GetStepStatus() == fGeomBoundary ||
+      postStepPoint->GetStepStatus() == fWorldBoundary) {
+    aParticleChange.Initialize(aTrack);
+    return &aParticleChange;			// Don't want to reset IL
+  }
+
+  G4double rateS = bulkRate->GetScatteringRate();
+  G4double rateD = bulkRate->GetDownconversionRate();
+
+  if (verboseLevel>1) {
+    G4cout << GetProcessName() << "::PostStepDoIt scattering " << rateS/hertz
+	   << " Hz, downconversion " << rateD/hertz << " Hz" << G4endl;
+  }
+
+  G4VParticleChange* theChange = 0;
+  if (G4UniformRand()*(rateS+rateD) < rateD)
+    theChange = downconversion->PostStepDoIt(aTrack, aStep);
+  else
+    theChange = scattering->PostStepDoIt(aTrack, aStep);
+
+  ClearNumberOfInteractionLengthLeft();		// All processes should do this!
+  return theChange;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
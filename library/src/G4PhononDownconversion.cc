@@ -25,10 +25,18 @@
 // 20170928  Hide "output" usage behind verbosity check, as well as G4CMP_DEBUG
 // 20191014  G4CMP-179:  Drop sampling of anharmonic decay (downconversion)
 // 20200604  G4CMP-208:  Report accept-reject values of u,x,q for debugging.
+// 20201018  Separate decay kinematics from track creation; add optional
+//		inline cascade of daughters far from volume surfaces.
+// 20201101  Thin daughter phonons when event exceeds phonon track budget
+// 20201112  Decay products use local wavevector, as CreatePhonon() expects;
+//		Use G4CMPPhononBulkRate for rates in inline cascade
 
 #include "G4PhononDownconversion.hh"
+#include "G4CMPConfigManager.hh"
 #include "G4CMPPhononTrackInfo.hh"
 #include "G4CMPDownconversionRate.hh"
+#include "G4CMPPhononBulkRate.hh"
+#include "G4CMPPartitionSummary.hh"
 #include "G4CMPSecondaryUtils.hh"
 #include "G4CMPTrackUtils.hh"
 #include "G4CMPUtils.hh"
@@ -40,13 +48,16 @@
 #include "G4Step.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4VParticleChange.hh"
+#include "G4VSolid.hh"
+#include "G4VTouchable.hh"
 #include "Randomize.hh"
 #include <cmath>
 
 
 G4PhononDownconversion::G4PhononDownconversion(const G4String& aName)
   : G4VPhononProcess(aName, fPhononDownconversion),
-    fBeta(0.), fGamma(0.), fLambda(0.), fMu(0.), fvLvT(1.) {
+    fBeta(0.), fGamma(0.), fLambda(0.), fMu(0.), fvLvT(1.), fKeepProb(1.),
+    fDaughters(0), cascadeRate(new G4CMPPhononBulkRate) {
   UseRateModel(new G4CMPDownconversionRate);
 
 #ifdef G4CMP_DEBUG
@@ -65,6 +76,8 @@ G4PhononDownconversion::G4PhononDownconversion(const G4String& aName)
 }
 
 G4PhononDownconversion::~G4PhononDownconversion() {
+  delete cascadeRate; cascadeRate=0;
+
 #ifdef G4CMP_DEBUG
   output.close();
 #endif
@@ -106,12 +119,20 @@ G4VParticleChange* G4PhononDownconversion::PostStepDoIt( const G4Track& aTrack,
 
   fvLvT = theLattice->GetSoundSpeed() / theLattice->GetTransverseSoundSpeed();
 
+  // Over the event's phonon budget, daughters are kept with reduced rate
+  fKeepProb = G4CMPPartitionSummary::PhononBudgetScale();
+  fDaughters = 0;
+
   //Destroy the parent phonon and create the daughter phonons.
   //74% chance that daughter phonons are both transverse
   //26% Transverse and Longitudinal
-  const G4double fracTT = theLattice->GetAnhTTFrac();
-  if (G4UniformRand() <= fracTT) MakeTTSecondaries(aTrack);
-  else MakeLTSecondaries(aTrack);
+  if (G4CMPConfigManager::GetCascadeScale() > 0.) {
+    MakeCascadeSecondaries(aTrack);
+  } else {
+    const G4double fracTT = theLattice->GetAnhTTFrac();
+    if (G4UniformRand() <= fracTT) MakeTTSecondaries(aTrack);
+    else MakeLTSecondaries(aTrack);
+  }
 
 #ifdef G4CMP_DEBUG
   output << aTrack.GetWeight() << ','
@@ -120,7 +141,7 @@ G4VParticleChange* G4PhononDownconversion::PostStepDoIt( const G4Track& aTrack,
 #endif
 
   // Only kill the track if downconversion actually happened
-  if (aParticleChange.GetNumberOfSecondaries() > 0) {
+  if (fDaughters > 0) {
     aParticleChange.ProposeEnergy(0.);
     aParticleChange.ProposeTrackStatus(fStopAndKill);    
   }
@@ -192,8 +213,9 @@ inline double G4PhononDownconversion::MakeTTDeviation(double d, double x) const
 
 
 //Generate daughter phonons from L->T+T process
-   
-void G4PhononDownconversion::MakeTTSecondaries(const G4Track& aTrack) {
+
+void G4PhononDownconversion::DecayTT(const Phonon& parent, Phonon& sec1,
+				     Phonon& sec2) {
   G4double upperBound=(1+(1/fvLvT))/2;
   G4double lowerBound=(1-(1/fvLvT))/2;
 
@@ -212,7 +234,7 @@ void G4PhononDownconversion::MakeTTSecondaries(const G4Track& aTrack) {
   //using energy fraction x to calculate daughter phonon directions
   G4double theta1=MakeTTDeviation(fvLvT, x);
   G4double theta2=MakeTTDeviation(fvLvT, 1-x);
-  G4ThreeVector dir1=G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(aTrack)->k();
+  G4ThreeVector dir1=parent.k;
   G4ThreeVector dir2=dir1;
 
   // FIXME:  These extra randoms change timing and causting outputs of example!
@@ -220,61 +242,38 @@ void G4PhononDownconversion::MakeTTSecondaries(const G4Track& aTrack) {
   // Is this issue fixed by dropping the above line?
   
   G4double ph=G4UniformRand()*twopi;
-  dir1 = dir1.rotate(dir1.orthogonal(),theta1).rotate(dir1, ph);
-  dir2 = dir2.rotate(dir2.orthogonal(),-theta2).rotate(dir2,ph);
+  sec1.k = dir1.rotate(dir1.orthogonal(),theta1).rotate(dir1, ph);
+  sec2.k = dir2.rotate(dir2.orthogonal(),-theta2).rotate(dir2,ph);
 
-  G4double E=GetKineticEnergy(aTrack);
-  G4double Esec1 = x*E;
-  G4double Esec2 = E-Esec1;
+  sec1.energy = x*parent.energy;
+  sec2.energy = parent.energy - sec1.energy;
 
   // Make FT or ST phonons (0. means no longitudinal)
-  G4int mode1 = G4CMP::ChoosePhononPolarization(0., theLattice->GetSTDOS(),
-						theLattice->GetFTDOS());
+  sec1.mode = G4CMP::ChoosePhononPolarization(0., theLattice->GetSTDOS(),
+					      theLattice->GetFTDOS());
 
   // Make FT or ST phonon (0. means no longitudinal)
-  G4int mode2 = G4CMP::ChoosePhononPolarization(0., theLattice->GetSTDOS(),
-						theLattice->GetFTDOS());
+  sec2.mode = G4CMP::ChoosePhononPolarization(0., theLattice->GetSTDOS(),
+					      theLattice->GetFTDOS());
 
-  if (verboseLevel>1) {
-    G4cout << " MakeTTSecondaries: "
-	   << G4PhononPolarization::Get(mode1)->GetParticleName() << " "
-	   << Esec1/eV << " eV toward " << dir1 << " ; "
-	   << G4PhononPolarization::Get(mode2)->GetParticleName() << " "
-	   << Esec2/eV << " eV toward " << dir2 << G4endl;
-  }
+  sec1.pos = sec2.pos = parent.pos;
+  sec1.time = sec2.time = parent.time;
 
-  // Construct the secondaries and set their wavevectors
-  // Always produce the secondaries.
-  if (verboseLevel) {
-    G4cout << " Creating secondaries using touchable for "
-	   << aTrack.GetTouchable()->GetVolume()->GetName() << G4endl;
-  }
-
-  G4Track* sec1 = G4CMP::CreatePhonon(aTrack.GetTouchable(), mode1,
-				      dir1, Esec1, aTrack.GetGlobalTime(),
-                                      aTrack.GetPosition());
-  G4Track* sec2 = G4CMP::CreatePhonon(aTrack.GetTouchable(), mode2,
-                                      dir2, Esec2, aTrack.GetGlobalTime(),
-                                      aTrack.GetPosition());
-
-#ifdef G4CMP_DEBUG
-  if (output.good()) {
-    output << theta1 << ',' << theta2 << ','
-	   << sec1->GetKineticEnergy()/eV << ','
-	   << sec2->GetKineticEnergy()/eV << ',';
+  if (verboseLevel>1) {
+    G4cout << " DecayTT: "
+	   << G4PhononPolarization::Get(sec1.mode)->GetParticleName() << " "
+	   << sec1.energy/eV << " eV toward " << sec1.k << " ; "
+	   << G4PhononPolarization::Get(sec2.mode)->GetParticleName() << " "
+	   << sec2.energy/eV << " eV toward " << sec2.k << G4endl;
   }
-#endif
-
-  aParticleChange.SetNumberOfSecondaries(2);
-  aParticleChange.AddSecondary(sec2);
-  aParticleChange.AddSecondary(sec1);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
 //Generate daughter phonons from L->L'+T process
    
-void G4PhononDownconversion::MakeLTSecondaries(const G4Track& aTrack) {
+void G4PhononDownconversion::DecayLT(const Phonon& parent, Phonon& sec1,
+				     Phonon& sec2) {
   G4double upperBound=1;
   G4double lowerBound=(fvLvT-1)/(fvLvT+1);
   
@@ -310,51 +309,224 @@ void G4PhononDownconversion::MakeLTSecondaries(const G4Track& aTrack) {
   //using energy fraction x to calculate daughter phonon directions
   G4double thetaL=MakeLDeviation(fvLvT, x);
   G4double thetaT=MakeTDeviation(fvLvT, x);
-  G4ThreeVector dir1=G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(aTrack)->k();
+  G4ThreeVector dir1=parent.k;
   G4ThreeVector dir2=dir1;
 
   G4double ph=G4UniformRand()*twopi;
-  dir1 = dir1.rotate(dir1.orthogonal(),thetaL).rotate(dir1, ph);
-  dir2 = dir2.rotate(dir2.orthogonal(),-thetaT).rotate(dir2,ph);
+  sec1.k = dir1.rotate(dir1.orthogonal(),thetaL).rotate(dir1, ph);
+  sec2.k = dir2.rotate(dir2.orthogonal(),-thetaT).rotate(dir2,ph);
 
-  G4double E=GetKineticEnergy(aTrack);
-  G4double Esec1 = x*E;
-  G4double Esec2 = E-Esec1;
+  sec1.energy = x*parent.energy;
+  sec2.energy = parent.energy - sec1.energy;
 
   // First secondary is longitudnal
-  int mode1 = G4PhononPolarization::Long;
+  sec1.mode = G4PhononPolarization::Long;
 
   // Make FT or ST phonon (0. means no longitudinal)
-  G4int mode2 = G4CMP::ChoosePhononPolarization(0., theLattice->GetSTDOS(),
-						theLattice->GetFTDOS());
+  sec2.mode = G4CMP::ChoosePhononPolarization(0., theLattice->GetSTDOS(),
+					      theLattice->GetFTDOS());
+
+  sec1.pos = sec2.pos = parent.pos;
+  sec1.time = sec2.time = parent.time;
 
   if (verboseLevel>1) {
-    G4cout << " MakeLTSecondaries: "
-	   << G4PhononPolarization::Get(mode1)->GetParticleName() << " "
-	   << Esec1/eV << " eV toward " << dir1 << " ; "
-	   << G4PhononPolarization::Get(mode2)->GetParticleName() << " "
-	   << Esec2/eV << " eV toward " << dir2 << G4endl;
+    G4cout << " DecayLT: "
+	   << G4PhononPolarization::Get(sec1.mode)->GetParticleName() << " "
+	   << sec1.energy/eV << " eV toward " << sec1.k << " ; "
+	   << G4PhononPolarization::Get(sec2.mode)->GetParticleName() << " "
+	   << sec2.energy/eV << " eV toward " << sec2.k << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void G4PhononDownconversion::MakeTTSecondaries(const G4Track& aTrack) {
+  Phonon parent, ph1, ph2;
+  parent.k =
+    GetLocalDirection(G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(aTrack)->k());
+  parent.energy = GetKineticEnergy(aTrack);
+  parent.time = aTrack.GetGlobalTime();
+  parent.pos = aTrack.GetPosition();
+
+  DecayTT(parent, ph1, ph2);
+
+  // Construct the secondaries and set their wavevectors
+  // Always produce the secondaries.
+  if (verboseLevel) {
+    G4cout << " Creating secondaries using touchable for "
+	   << aTrack.GetTouchable()->GetVolume()->GetName() << G4endl;
+  }
+
+  G4Track* sec1 = G4CMP::CreatePhonon(aTrack.GetTouchable(), ph1.mode,
+				      ph1.k, ph1.energy, ph1.time, ph1.pos);
+  G4Track* sec2 = G4CMP::CreatePhonon(aTrack.GetTouchable(), ph2.mode,
+				      ph2.k, ph2.energy, ph2.time, ph2.pos);
+
+#ifdef G4CMP_DEBUG
+  if (output.good()) {
+    output << parent.k.angle(ph1.k) << ',' << parent.k.angle(ph2.k) << ','
+	   << sec1->GetKineticEnergy()/eV << ','
+	   << sec2->GetKineticEnergy()/eV << ',';
   }
+#endif
+
+  aParticleChange.SetNumberOfSecondaries(2);
+  AddDaughter(aTrack, sec2);
+  AddDaughter(aTrack, sec1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void G4PhononDownconversion::MakeLTSecondaries(const G4Track& aTrack) {
+  Phonon parent, ph1, ph2;
+  parent.k =
+    GetLocalDirection(G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(aTrack)->k());
+  parent.energy = GetKineticEnergy(aTrack);
+  parent.time = aTrack.GetGlobalTime();
+  parent.pos = aTrack.GetPosition();
+
+  DecayLT(parent, ph1, ph2);
 
   // Construct the secondaries and set their wavevectors
-  G4Track* sec1 = G4CMP::CreatePhonon(aTrack.GetTouchable(), mode1,
-				      dir1, Esec1, aTrack.GetGlobalTime(),
-                                      aTrack.GetPosition());
-  G4Track* sec2 = G4CMP::CreatePhonon(aTrack.GetTouchable(), mode2,
-                                      dir2, Esec2, aTrack.GetGlobalTime(),
-                                      aTrack.GetPosition());
+  G4Track* sec1 = G4CMP::CreatePhonon(aTrack.GetTouchable(), ph1.mode,
+				      ph1.k, ph1.energy, ph1.time, ph1.pos);
+  G4Track* sec2 = G4CMP::CreatePhonon(aTrack.GetTouchable(), ph2.mode,
+				      ph2.k, ph2.energy, ph2.time, ph2.pos);
 
 #ifdef G4CMP_DEBUG
   if (output.good()) {
-    output << thetaL << ',' << thetaT << ',' << sec1->GetKineticEnergy()/eV
-	   << ',' << sec2->GetKineticEnergy()/eV << ',';
+    output << parent.k.angle(ph1.k) << ',' << parent.k.angle(ph2.k) << ','
+	   << sec1->GetKineticEnergy()/eV << ','
+	   << sec2->GetKineticEnergy()/eV << ',';
   }
 #endif
 
   aParticleChange.SetNumberOfSecondaries(2);
-  aParticleChange.AddSecondary(sec2);
-  aParticleChange.AddSecondary(sec1);
+  AddDaughter(aTrack, sec2);
+  AddDaughter(aTrack, sec1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Decay products whose mean free path is much shorter than the distance
+// to the volume surface are scattered and downconverted in place.  Only
+// the quasi-ballistic survivors are returned to Geant4 as tracks.
+
+void G4PhononDownconversion::MakeCascadeSecondaries(const G4Track& aTrack) {
+  const G4VTouchable* touch = aTrack.GetTouchable();
+  const G4VSolid* solid = touch->GetSolid();
+  const G4double fracTT = theLattice->GetAnhTTFrac();
+
+  // Cascade is done in local coordinates, for lattice and DistanceToOut()
+  Phonon parent, ph1, ph2;
+  parent.mode = G4PhononPolarization::Long;
+  parent.k =
+    GetLocalDirection(G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(aTrack)->k());
+  parent.energy = GetKineticEnergy(aTrack);
+  parent.time = aTrack.GetGlobalTime();
+  parent.pos = GetLocalPosition(aTrack.GetPosition());
+
+  // Track has reached its decay point, so first generation always decays
+  if (G4UniformRand() <= fracTT) DecayTT(parent, ph1, ph2);
+  else DecayLT(parent, ph1, ph2);
+
+  cascade.clear();
+  cascade.push_back(ph2);
+  cascade.push_back(ph1);
+
+  survivors.clear();
+  while (!cascade.empty()) {
+    parent = cascade.back();
+    cascade.pop_back();
+
+    if (!PropagateInline(solid, parent)) {
+      survivors.push_back(parent);
+      continue;
+    }
+
+    if (G4UniformRand() <= fracTT) DecayTT(parent, ph1, ph2);
+    else DecayLT(parent, ph1, ph2);
+
+    cascade.push_back(ph2);
+    cascade.push_back(ph1);
+  }
+
+  if (verboseLevel>1) {
+    G4cout << " MakeCascadeSecondaries: " << survivors.size()
+	   << " phonons from " << GetKineticEnergy(aTrack)/eV << " eV"
+	   << G4endl;
+  }
+
+  aParticleChange.SetNumberOfSecondaries(survivors.size());
+  for (const Phonon& phon: survivors) {
+    AddDaughter(aTrack,
+		G4CMP::CreatePhonon(touch, phon.mode, phon.k, phon.energy,
+				    phon.time, GetGlobalPosition(phon.pos)) );
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
+// Surviving daughters carry weight to conserve energy on average
+
+void G4PhononDownconversion::AddDaughter(const G4Track& parent,
+					 G4Track* sec) {
+  if (!sec) return;
+  fDaughters++;
+
+  G4double weight = G4CMP::ChoosePhononWeight(fKeepProb);
+  if (weight <= 0.) {
+    delete sec;
+    return;
+  }
+
+  sec->SetWeight(parent.GetWeight() * weight);
+  aParticleChange.SetSecondaryWeightByProcess(true);
+  aParticleChange.AddSecondary(sec);
+
+  G4CMPPartitionSummary::CountPhonons(1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Step phonon through isotope scattering and decay, returning true if it
+// has downconverted before possibly reaching the surface.  The distance to
+// the surface decreases by at most each step length, so no navigation is
+// needed.  Phonons which could reach the surface are left unchanged from
+// their last interaction, to be tracked by Geant4 from there.
+
+G4bool G4PhononDownconversion::PropagateInline(const G4VSolid* solid,
+					       Phonon& phon) const {
+  const G4double scale = G4CMPConfigManager::GetCascadeScale();
+  cascadeRate->SetLattice(theLattice);
+
+  G4double safety = solid->DistanceToOut(phon.pos);
+  while (true) {
+    G4double rate = cascadeRate->Rate(phon.energy, phon.mode);
+    G4double rateD = cascadeRate->GetDownconversionRate();
+    if (rate <= 0.) return false;
+
+    G4double vgrp = theLattice->MapKtoV(phon.mode, phon.k);
+    G4double mfp = vgrp / rate;
+    if (mfp*scale > safety) return false;		// Quasi-ballistic
+
+    G4double step = -mfp*std::log(G4UniformRand());
+    if (step >= safety) return false;			// Might reach surface
+
+    phon.pos += step*theLattice->MapKtoVDir(phon.mode, phon.k);
+    phon.time += step/vgrp;
+    safety -= step;
+
+    if (G4UniformRand()*rate < rateD) return true;
+
+    // Isotope scattering:  new direction and polarization, same energy
+    phon.k = G4RandomDirection();
+    phon.mode = G4CMP::ChoosePhononPolarization(theLattice->GetLDOS(),
+						theLattice->GetSTDOS(),
+						theLattice->GetFTDOS());
+  }
+
+  return false;		// Can't get here, but keeps compiler happy
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
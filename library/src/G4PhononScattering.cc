@@ -14,6 +14,8 @@
 // 20170620  Follow interface changes in G4CMPSecondaryUtils
 // 20170805  Move GetMeanFreePath() to scattering-rate model
 // 20170819  Overwrite track's particle definition instead of killing
+// 20201020  Use cached group velocity from track info
+// 20201112  Cached velocity is already global
 
 #include "G4PhononScattering.hh"
 #include "G4CMPPhononScatteringRate.hh"
@@ -93,10 +95,10 @@ G4VParticleChange* G4PhononScattering::PostStepDoIt( const G4Track& aTrack,
   auto trkInfo = G4CMP::GetTrackInfo<G4CMPPhononTrackInfo>(aTrack);
   trkInfo->SetWaveVector(newK);
 
-  // Set velocity and direction according to new wave vector direction
-  G4double vgrp = theLattice->MapKtoV(mode, newK);
-  G4ThreeVector vdir = theLattice->MapKtoVDir(mode, newK);
-  RotateToGlobalDirection(vdir);
+  // Set velocity and direction according to new (global) wave vector
+  const G4VTouchable* touch = GetCurrentTouchable();
+  G4double vgrp = trkInfo->GroupSpeed(mode, touch, theLattice);
+  G4ThreeVector vdir = trkInfo->VelocityDir(mode, touch, theLattice);
 
   if (verboseLevel>1)
     G4cout << " new vgrp " << vgrp << " along " << vdir << G4endl;
@@ -0,0 +1,125 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+// Usage: testBinnedElectrode
+//
+// Fill G4CMPBinnedElectrodeSensitivity with hand-made steps and check that
+// weighted energy lands in the expected channel and time bin, and that
+// hits outside the channel or time range (including invalid times) are
+// counted as lost energy.
+
+#include "globals.hh"
+#include "G4CMPBinnedElectrodeSensitivity.hh"
+#include "G4DynamicParticle.hh"
+#include "G4PhononLong.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Track.hh"
+#include <cmath>
+#include <limits>
+
+namespace {
+  G4int nErrors = 0;		// Increment counter at failed checks
+}
+
+
+// Every step is a hit; channel is passed through the track ID
+
+class TestBinnedSensitivity : public G4CMPBinnedElectrodeSensitivity {
+public:
+  TestBinnedSensitivity(size_t nChannels, size_t nBins, G4double binWidth,
+			G4double startTime)
+    : G4CMPBinnedElectrodeSensitivity("TestBinned", nChannels, nBins,
+				      binWidth, startTime) {;}
+
+  using G4CMPBinnedElectrodeSensitivity::Clear;
+
+protected:
+  virtual G4bool IsHit(const G4Step*, const G4TouchableHistory*) const {
+    return true;
+  }
+
+  virtual G4int ChannelOf(const G4Step* step) const {
+    return step->GetTrack()->GetTrackID();
+  }
+};
+
+
+// Build step for given channel, time, energy and weight, and process it
+
+void FillHit(TestBinnedSensitivity& sd, G4int chan, G4double time,
+	     G4double energy, G4double weight=1.) {
+  G4DynamicParticle* dyn =
+    new G4DynamicParticle(G4PhononLong::Definition(), G4ThreeVector(0,0,1),
+			  energy);
+  G4Track track(dyn, time, G4ThreeVector());
+  track.SetTrackID(chan);
+  track.SetWeight(weight);
+
+  G4Step step;
+  step.SetTrack(&track);
+  step.GetPostStepPoint()->SetGlobalTime(time);
+  step.SetNonIonizingEnergyDeposit(energy);
+
+  sd.Hit(&step);
+  step.SetTrack(0);		// Track is owned here, not by step
+}
+
+void Check(const char* what, G4double value, G4double expect) {
+  if (std::fabs(value-expect) > 1e-12*std::max(1.,std::fabs(expect))) {
+    G4cerr << "ERROR: " << what << " " << value << ", expected " << expect
+	   << G4endl;
+    nErrors++;
+  }
+}
+
+
+int main() {
+  G4cout << "Testing G4CMPBinnedElectrodeSensitivity" << G4endl;
+
+  // Two channels, ten 100 ns bins starting at 50 ns
+  TestBinnedSensitivity sd(2, 10, 100.*ns, 50.*ns);
+  sd.Clear();
+
+  FillHit(sd, 0, 60.*ns, 1.*meV);		// First bin
+  FillHit(sd, 0, 149.*ns, 2.*meV, 0.5);		// First bin, weighted
+  FillHit(sd, 1, 1049.*ns, 4.*meV);		// Last bin
+  FillHit(sd, 1, 350.*ns, 8.*meV, 2.);		// Fourth bin, weighted
+
+  FillHit(sd, 0, 49.*ns, 16.*meV);		// Before first bin
+  FillHit(sd, 1, 1050.*ns, 32.*meV);		// After last bin
+  FillHit(sd, 2, 500.*ns, 64.*meV);		// No such channel
+  FillHit(sd, -1, 500.*ns, 128.*meV);		// No such channel
+  FillHit(sd, 0, std::numeric_limits<G4double>::quiet_NaN(), 256.*meV);
+
+  Check("Channel 0 bin 0", sd.GetEnergy(0,0), 2.*meV);
+  Check("Channel 1 bin 9", sd.GetEnergy(1,9), 4.*meV);
+  Check("Channel 1 bin 3", sd.GetEnergy(1,3), 16.*meV);
+  Check("Lost energy", sd.GetLostEnergy(), (16.+32.+64.+128.+256.)*meV);
+
+  G4double total = 0.;
+  for (size_t c=0; c<sd.GetNumberOfChannels(); c++) {
+    const G4double* chan = sd.GetChannel(c);
+    for (size_t b=0; b<sd.GetNumberOfBins(); b++) total += chan[b];
+  }
+  Check("Binned energy", total, 22.*meV);
+
+  // Rebinning clears the arrays
+  sd.SetTimeBins(5, 1.*us);
+  Check("Bins after rebinning", sd.GetNumberOfBins(), 5);
+  Check("Lost energy after rebinning", sd.GetLostEnergy(), 0.);
+
+  FillHit(sd, 1, 4.5*us, 1.*meV);
+  Check("Channel 1 bin 4", sd.GetEnergy(1,4), 1.*meV);
+
+  if (nErrors > 0) {
+    G4cerr << nErrors << " checks failed" << G4endl;
+    return 1;
+  }
+
+  G4cout << "All checks passed" << G4endl;
+  return 0;
+}
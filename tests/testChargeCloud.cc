@@ -67,7 +67,13 @@ void testCloud(G4int n, const G4ThreeVector& pos) {
   G4double rrms = sqrt(r2sum/points.size() - ravg*ravg);
   G4cout << " at " << pos << " points span " << min/mm << " to "
 	 << max/mm << " mm\n Ravg " << ravg/nm << " rms " << rrms/nm << " nm"
-	 << "\n Maximum bin (zzzyyyxxx) " << maxbin << G4endl;
+	 << "\n Maximum bin " << maxbin << " of " << cloud->GetNumberOfBins()
+	 << G4endl;
+
+  if (maxbin+1 != cloud->GetNumberOfBins()) {
+    G4cerr << " BIN INDICES NOT SEQUENTIAL" << G4endl;
+    nErrors++;
+  }
 
   G4double rcloud = cloud->GetRadius();		// Radius used to generate
 
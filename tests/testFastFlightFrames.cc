@@ -0,0 +1,163 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+// Usage: testFastFlightFrames [N]
+//
+// Validate the coordinate-frame handling used by the phonon fast-flight
+// mode (G4CMPPhononBoundaryProcess::DoFastFlights) in a crystal placed
+// with both rotation and translation.  For N random global rays inside the
+// crystal, the solid is queried in the local frame, and the resulting
+// flight length, exit point and surface normal are compared to global
+// navigation of the same ray.  A specular reflection with the global
+// normal must match the same reflection done in the local frame.
+//
+// Default N is 10000.
+
+#include "globals.hh"
+#include "G4Box.hh"
+#include "G4CMPGeometryUtils.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Navigator.hh"
+#include "G4NistManager.hh"
+#include "G4PVPlacement.hh"
+#include "G4RandomDirection.hh"
+#include "G4RotationMatrix.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4TouchableHistory.hh"
+#include "G4VSolid.hh"
+#include "Randomize.hh"
+#include <cmath>
+#include <stdlib.h>
+
+namespace {
+  G4int nErrors = 0;		// Increment counter at failed checks
+  const G4double tolerance = 1e-6*mm;
+}
+
+
+int main(int argc, char* argv[]) {
+  G4int nRays = (argc>1) ? atoi(argv[1]) : 10000;
+
+  G4cout << "Testing fast-flight frames with " << nRays << " rays" << G4endl;
+
+  // Rectangular crystal, rotated about two axes and offset from the origin
+  G4NistManager* nist = G4NistManager::Instance();
+
+  G4Box* worldBox = new G4Box("World", 1.*m, 1.*m, 1.*m);
+  G4LogicalVolume* worldLV =
+    new G4LogicalVolume(worldBox, nist->FindOrBuildMaterial("G4_Galactic"),
+			"World");
+  G4VPhysicalVolume* worldPV =
+    new G4PVPlacement(0, G4ThreeVector(), worldLV, "World", 0, false, 0);
+
+  G4Box* crystalBox = new G4Box("Crystal", 1.*cm, 2.*cm, 3.*cm);
+  G4LogicalVolume* crystalLV =
+    new G4LogicalVolume(crystalBox, nist->FindOrBuildMaterial("G4_Si"),
+			"Crystal");
+
+  G4RotationMatrix* rot = new G4RotationMatrix;
+  rot->rotateX(30.*deg);
+  rot->rotateZ(45.*deg);
+  G4ThreeVector offset(5.*cm, -7.*cm, 3.*cm);
+  G4VPhysicalVolume* crystalPV =
+    new G4PVPlacement(rot, offset, crystalLV, "Crystal", worldLV, false, 0);
+
+  G4Navigator nav;
+  nav.SetWorldVolume(worldPV);
+
+  G4TouchableHistory* touch = new G4TouchableHistory;
+  nav.LocateGlobalPointAndUpdateTouchable(offset, touch, false);
+  if (touch->GetVolume() != crystalPV) {
+    G4cerr << "ERROR: crystal center not found in crystal" << G4endl;
+    return 1;
+  }
+
+  const G4VSolid* solid = crystalLV->GetSolid();
+  G4double maxDist = 0., maxNorm = 0.;
+
+  for (G4int i=0; i<nRays; i++) {
+    // Random start point inside crystal, converted to global frame
+    G4ThreeVector local(0.9*cm*(2.*G4UniformRand()-1.),
+			1.9*cm*(2.*G4UniformRand()-1.),
+			2.9*cm*(2.*G4UniformRand()-1.));
+    G4ThreeVector pos = G4CMP::GetGlobalPosition(touch, local);
+    G4ThreeVector vdir = G4RandomDirection();		// Global, like k
+
+    // Same sequence as DoFastFlights(): solid in local frame
+    G4ThreeVector vlocal = G4CMP::GetLocalDirection(touch, vdir);
+    G4ThreeVector norm;
+    G4bool validNorm = false;
+    G4double dist =
+      solid->DistanceToOut(local, vlocal, true, &validNorm, &norm);
+    G4ThreeVector next = local + dist*vlocal;
+    if (!validNorm) norm = solid->SurfaceNormal(next);
+
+    G4ThreeVector outside = next + 2.*kCarTolerance*norm;
+    G4CMP::RotateToGlobalPosition(touch, outside);
+    G4CMP::RotateToGlobalPosition(touch, next);
+    G4CMP::RotateToGlobalDirection(touch, norm);
+
+    // Reference:  navigate the same ray entirely in global frame
+    G4double safety = 0.;
+    nav.LocateGlobalPointAndSetup(pos, 0, false);
+    G4double navDist = nav.ComputeStep(pos, vdir, kInfinity, safety);
+
+    G4bool validExit = false;
+    nav.SetGeometricallyLimitedStep();
+    nav.LocateGlobalPointAndSetup(pos+navDist*vdir, &vdir, true);
+    G4ThreeVector navNorm = nav.GetGlobalExitNormal(pos+navDist*vdir,
+						    &validExit);
+
+    G4double dDist = std::fabs(dist-navDist);
+    G4double dNorm = validExit ? (norm-navNorm).mag() : 0.;
+    if (dDist > maxDist) maxDist = dDist;
+    if (dNorm > maxNorm) maxNorm = dNorm;
+
+    if (dDist > tolerance || (next-(pos+navDist*vdir)).mag() > tolerance) {
+      G4cerr << "ERROR: ray " << i << " flight " << dist/mm << " mm, expected "
+	     << navDist/mm << " mm" << G4endl;
+      nErrors++;
+    }
+
+    if (dNorm > 1e-9) {
+      G4cerr << "ERROR: ray " << i << " normal " << norm << ", expected "
+	     << navNorm << G4endl;
+      nErrors++;
+    }
+
+    if (nav.LocateGlobalPointAndSetup(outside, 0, false) == crystalPV) {
+      G4cerr << "ERROR: ray " << i << " outside point " << outside
+	     << " is in crystal" << G4endl;
+      nErrors++;
+    }
+
+    // Global wavevector tests and reflections use global normal
+    if (vdir*norm <= 0.) {
+      G4cerr << "ERROR: ray " << i << " not outgoing at surface" << G4endl;
+      nErrors++;
+    }
+
+    // Reflection in global frame must match reflection in local frame
+    G4ThreeVector reflected = vdir - 2.*(vdir*norm)*norm;
+    G4ThreeVector nlocal = G4CMP::GetLocalDirection(touch, norm);
+    G4ThreeVector rlocal = vlocal - 2.*(vlocal*nlocal)*nlocal;
+    if ((G4CMP::GetLocalDirection(touch, reflected)-rlocal).mag() > 1e-9) {
+      G4cerr << "ERROR: ray " << i << " reflection " << reflected
+	     << " differs from local " << rlocal << G4endl;
+      nErrors++;
+    }
+  }
+
+  G4cout << " Largest flight mismatch " << maxDist/mm << " mm"
+	 << "\n Largest normal mismatch " << maxNorm << G4endl;
+
+  if (nErrors > 0) {
+    G4cerr << nErrors << " checks failed" << G4endl;
+    return 1;
+  }
+
+  G4cout << "All checks passed" << G4endl;
+  return 0;
+}
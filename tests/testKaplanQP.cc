@@ -0,0 +1,310 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+// Usage: testKaplanQP <N> [gap-meV]
+//
+// Draw N quasiparticle and phonon energies from G4CMPKaplanQP at several
+// energies (in units of the film bandgap), and compare the histograms to
+// the exact distributions with a chi-squared test.  Expected bin contents
+// are integrated directly from the energy PDFs, not from the substituted
+// PDFs used by the samplers.  The previous flat-envelope rejection samplers
+// are run on the same inputs, for comparison of both accuracy and
+// throughput; they truncate the PDFs near the endpoints, so the first and
+// last bins are excluded from their test.
+//
+// The summary-only absorption interfaces are checked for energy
+// conservation and for consistent histogram counts.
+//
+// Default bandgap is 0.173 meV (aluminum).
+
+#include "globals.hh"
+#include "G4CMPKaplanQP.hh"
+#include "G4MaterialPropertiesTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <stdlib.h>
+#include <vector>
+
+// Global variables for use in tests
+
+namespace {
+  G4int nErrors = 0;		// Increment counter at failed checks
+
+  const G4int nBins = 50;
+  const G4double chi2Limit = 2.;	// Chi2/ndf for failure, p ~ 1e-5
+}
+
+
+// Expose samplers, and keep copies of original rejection algorithms
+
+class TestKaplanQP : public G4CMPKaplanQP {
+public:
+  TestKaplanQP(G4MaterialPropertiesTable* prop) : G4CMPKaplanQP(prop) {;}
+
+  using G4CMPKaplanQP::QPEnergyRand;
+  using G4CMPKaplanQP::QPEnergyPDF;
+  using G4CMPKaplanQP::PhononEnergyRand;
+  using G4CMPKaplanQP::PhononEnergyPDF;
+
+  G4double LegacyQPEnergyRand(G4double Energy) const {
+    const G4double gapEnergy = GetGapEnergy();
+    const G4double BUFF = 1000.;
+    G4double xmin = gapEnergy + (Energy-2.*gapEnergy)/BUFF;
+    G4double xmax = gapEnergy + (Energy-2.*gapEnergy)*(BUFF-1.)/BUFF;
+    G4double ymax = QPEnergyPDF(Energy, xmin);
+
+    G4double xtest=0., ytest=ymax;
+    do {
+      ytest = G4UniformRand()*ymax;
+      xtest = G4UniformRand()*(xmax-xmin) + xmin;
+    } while (ytest > QPEnergyPDF(Energy, xtest));
+
+    return xtest;
+  }
+
+  G4double LegacyPhononEnergyRand(G4double Energy) const {
+    const G4double gapEnergy = GetGapEnergy();
+    const G4double BUFF = 1000.;
+    G4double xmin = gapEnergy + gapEnergy/BUFF;
+    G4double xmax = Energy;
+    G4double ymax = PhononEnergyPDF(Energy, xmin);
+
+    G4double xtest=0., ytest=ymax;
+    do {
+      ytest = G4UniformRand()*ymax;
+      xtest = G4UniformRand()*(xmax-xmin) + xmin;
+    } while (ytest > PhononEnergyPDF(Energy, xtest));
+
+    return Energy-xtest;
+  }
+};
+
+
+// Integrate function with at most inverse square-root singularities at
+// the endpoints.  Each half interval is mapped to x = end -/+ s^2, which
+// cancels the singularity, and integrated with the midpoint rule so that
+// the endpoints themselves are never evaluated.
+
+G4double integrate(const std::function<G4double(G4double)>& f,
+		   G4double lo, G4double hi, G4int nStep=200) {
+  const G4double smax = std::sqrt(0.5*(hi-lo));
+  const G4double h = smax/nStep;
+
+  G4double sum = 0.;
+  for (G4int i=0; i<nStep; i++) {
+    G4double s = (i+0.5)*h;
+    sum += 2.*s * (f(lo+s*s) + f(hi-s*s));
+  }
+
+  return sum*h;
+}
+
+// Expected fraction in each of nBins equal bins of [xlo,xhi]
+
+std::vector<G4double>
+expected(G4double xlo, G4double xhi,
+	 const std::function<G4double(G4double)>& pdf) {
+  std::vector<G4double> prob(nBins, 0.);
+  G4double dx = (xhi-xlo)/nBins, total = 0.;
+  for (G4int i=0; i<nBins; i++) {
+    prob[i] = integrate(pdf, xlo+i*dx, xlo+(i+1)*dx);
+    total += prob[i];
+  }
+
+  for (G4int i=0; i<nBins; i++) prob[i] /= total;
+  return prob;
+}
+
+// Fill histogram of N samples, return chi2/ndf against expected fractions.
+// The nSkip bins at each end are excluded, and the remaining expectation
+// normalized to the samples which fell between them.
+
+G4double chi2(G4int nTotal, G4double xlo, G4double xhi,
+	      const std::vector<G4double>& prob,
+	      const std::function<G4double()>& sampler, G4double& nsPerCall,
+	      G4int nSkip=0) {
+  std::vector<G4int> hist(nBins, 0);
+  G4double dx = (xhi-xlo)/nBins;
+
+  auto start = std::chrono::steady_clock::now();
+  for (G4int n=0; n<nTotal; n++) {
+    G4int ibin = (G4int)std::floor((sampler()-xlo)/dx);
+    if (ibin >= 0 && ibin < nBins) hist[ibin]++;
+  }
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+  nsPerCall = elapsed.count()*1e9/nTotal;
+
+  G4double nUsed = 0., pUsed = 0.;
+  for (G4int i=nSkip; i<nBins-nSkip; i++) {
+    nUsed += hist[i];
+    pUsed += prob[i];
+  }
+  if (nUsed <= 0. || pUsed <= 0.) return 0.;
+
+  G4double sum = 0.;
+  for (G4int i=nSkip; i<nBins-nSkip; i++) {
+    G4double nExp = nUsed*prob[i]/pUsed;
+    if (nExp > 0.) sum += (hist[i]-nExp)*(hist[i]-nExp)/nExp;
+  }
+
+  return sum/(nBins-2*nSkip-1);
+}
+
+void report(const char* label, G4double ratio, G4double chiNew,
+	    G4double nsNew, G4double chiOld, G4double nsOld) {
+  G4cout << " " << label << " E/gap " << ratio
+	 << " : chi2/ndf " << chiNew << " (" << nsNew << " ns)"
+	 << " legacy " << chiOld << " (" << nsOld << " ns)" << G4endl;
+
+  if (chiNew > chi2Limit) {
+    G4cerr << " " << label << " DISTRIBUTION WRONG AT E/gap " << ratio
+	   << G4endl;
+    nErrors++;
+  }
+
+  if (chiOld > chi2Limit) {
+    G4cerr << " " << label << " LEGACY DISAGREES AT E/gap " << ratio
+	   << G4endl;
+    nErrors++;
+  }
+}
+
+
+// Quasiparticle energies from pair breaking, symmetric on [gap, E-gap]
+
+void testQPEnergy(const TestKaplanQP& kaplan, G4double E, G4int nTotal) {
+  const G4double gap = kaplan.GetGapEnergy();
+
+  std::vector<G4double> prob =
+    expected(gap, E-gap,
+	     [&](G4double x) { return kaplan.QPEnergyPDF(E, x); });
+
+  G4double nsNew=0., nsOld=0.;
+  G4double chiNew = chi2(nTotal, gap, E-gap, prob,
+			 [&]() { return kaplan.QPEnergyRand(E); }, nsNew);
+  G4double chiOld = chi2(nTotal, gap, E-gap, prob,
+			 [&]() { return kaplan.LegacyQPEnergyRand(E); },
+			 nsOld, 1);
+
+  report("QPEnergyRand    ", E/gap, chiNew, nsNew, chiOld, nsOld);
+}
+
+// Phonon energies from QP relaxation, binned in final QP energy [gap, E]
+
+void testPhononEnergy(const TestKaplanQP& kaplan, G4double E, G4int nTotal) {
+  const G4double gap = kaplan.GetGapEnergy();
+
+  std::vector<G4double> prob =
+    expected(gap, E,
+	     [&](G4double x) { return kaplan.PhononEnergyPDF(E, x); });
+
+  G4double nsNew=0., nsOld=0.;
+  G4double chiNew = chi2(nTotal, gap, E, prob,
+			 [&]() { return E-kaplan.PhononEnergyRand(E); }, nsNew);
+  G4double chiOld = chi2(nTotal, gap, E, prob,
+			 [&]() { return E-kaplan.LegacyPhononEnergyRand(E); },
+			 nsOld, 1);
+
+  report("PhononEnergyRand", E/gap, chiNew, nsNew, chiOld, nsOld);
+}
+
+
+// Summary absorption must conserve energy, and histogram every re-emission
+
+void checkSummary(const char* label, G4double E, G4double gap, G4int nCalls,
+		  const std::function<G4double(G4CMPKaplanQP::Summary&)>& absorb) {
+  G4CMPKaplanQP::Summary summary(E, nBins);
+
+  G4int nBad = 0;
+  for (G4int n=0; n<nCalls; n++) {
+    G4double before = summary.absorbed + summary.reflected;
+    G4double EDep = absorb(summary);
+    G4double after = summary.absorbed + summary.reflected;
+
+    if (std::fabs(after-before-E) > 1e-9*E || EDep > E) nBad++;
+  }
+
+  G4int nFilled = 0;
+  for (G4int count: summary.histogram) nFilled += count;
+
+  G4cout << " " << label << " E/gap " << E/gap << " : absorbed "
+	 << summary.absorbed/(nCalls*E) << " reflected "
+	 << summary.reflected/(nCalls*E) << " of input, " << summary.nReflected
+	 << " re-emitted" << G4endl;
+
+  if (nBad > 0) {
+    G4cerr << " " << label << " ENERGY NOT CONSERVED IN " << nBad << " OF "
+	   << nCalls << " CALLS" << G4endl;
+    nErrors++;
+  }
+
+  G4double total = summary.absorbed + summary.reflected;
+  if (std::fabs(total - nCalls*E) > 1e-9*nCalls*E) {
+    G4cerr << " " << label << " TOTAL ENERGY " << summary.absorbed
+	   << " + " << summary.reflected << " != " << nCalls*E << G4endl;
+    nErrors++;
+  }
+
+  if (nFilled != summary.nReflected) {
+    G4cerr << " " << label << " HISTOGRAM HAS " << nFilled << " ENTRIES, "
+	   << summary.nReflected << " RE-EMITTED" << G4endl;
+    nErrors++;
+  }
+}
+
+void testSummary(const TestKaplanQP& kaplan, G4MaterialPropertiesTable* film,
+		 G4double E, G4int nCalls) {
+  const G4double gap = kaplan.GetGapEnergy();
+  checkSummary("AbsorbPhonon    ", E, gap, nCalls,
+	       [&](G4CMPKaplanQP::Summary& s) {
+		 return kaplan.AbsorbPhonon(E, s); });
+  checkSummary("KaplanPhononQP  ", E, gap, nCalls,
+	       [&](G4CMPKaplanQP::Summary& s) {
+		 return G4CMP::KaplanPhononQP(E, film, s); });
+}
+
+
+// Main test is here
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    G4cerr << "Usage: " << argv[0] << " <N> [gap-meV]" << G4endl;
+    ::exit(1);
+  }
+
+  G4int nTotal = atoi(argv[1]);
+  G4double gap = (argc>2 ? strtod(argv[2],0) : 0.173) * meV;
+
+  // Film properties are needed by constructor, not used for sampling
+  G4MaterialPropertiesTable* film = new G4MaterialPropertiesTable;
+  film->AddConstProperty("gapEnergy", gap);
+  film->AddConstProperty("phononLifetime", 242.*ns);
+  film->AddConstProperty("phononLifetimeSlope", 0.29);
+  film->AddConstProperty("vSound", 3.26*km/s);
+  film->AddConstProperty("filmThickness", 600.*nm);
+
+  TestKaplanQP kaplan(film);
+
+  G4cout << "Sampling " << nTotal << " energies into " << nBins << " bins,"
+	 << " gap " << gap/meV << " meV" << G4endl;
+
+  const G4double qpRatios[] = { 2.2, 4., 20., 200., 2000. };
+  for (G4double r: qpRatios) testQPEnergy(kaplan, r*gap, nTotal);
+
+  const G4double phononRatios[] = { 1.5, 5., 50., 500., 5000. };
+  for (G4double r: phononRatios) testPhononEnergy(kaplan, r*gap, nTotal);
+
+  G4int nCalls = std::max(100, nTotal/100);	// Each call is a cascade
+  const G4double summaryRatios[] = { 1.5, 3., 10., 100. };
+  for (G4double r: summaryRatios) testSummary(kaplan, film, r*gap, nCalls);
+
+  delete film;
+  return nErrors;
+}
@@ -0,0 +1,144 @@
+/***********************************************************************\
+ * This software is licensed under the terms of the GNU General Public *
+ * License version 3 or later. See G4CMP/LICENSE for the full license. *
+\***********************************************************************/
+
+// Usage: testTrackInfoAlloc <N> <Lattice> [batch]
+//
+// Allocate and delete N phonon and drift track-info objects, in batches
+// of the specified size (default 10000), and report throughput.  The same
+// pattern is repeated with plain heap blocks of the same size, to compare
+// G4Allocator pooling against global new/delete.
+//
+// Geant4 material will be set as "G4_<Lattice>".
+
+#include "globals.hh"
+#include "G4CMPDriftTrackInfo.hh"
+#include "G4CMPPhononTrackInfo.hh"
+#include "G4LatticeManager.hh"
+#include "G4LatticePhysical.hh"
+#include "G4LogicalVolume.hh"
+#include "G4NistManager.hh"
+#include "G4PVPlacement.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ThreeVector.hh"
+#include "G4Tubs.hh"
+#include <chrono>
+#include <stdlib.h>
+#include <vector>
+
+// Global variables for use in tests
+
+namespace {
+  G4LatticePhysical* lattice = 0;
+  G4int nErrors = 0;		// Increment counter at failed checks
+
+  // Stand-ins for track info objects, using global new/delete
+  struct PhononBlock { char data[sizeof(G4CMPPhononTrackInfo)]; };
+  struct DriftBlock  { char data[sizeof(G4CMPDriftTrackInfo)]; };
+}
+
+
+// Run allocation cycle for given object type, return time in seconds
+
+template <class T, class Maker>
+G4double timeAllocation(G4int nTotal, G4int batch, Maker make) {
+  std::vector<T*> buffer;
+  buffer.reserve(batch);
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (G4int n=0; n<nTotal; n+=batch) {
+    for (G4int i=0; i<batch && n+i<nTotal; i++) buffer.push_back(make(i));
+    for (size_t i=0; i<buffer.size(); i++) delete buffer[i];
+    buffer.clear();
+  }
+
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+
+  return elapsed.count();
+}
+
+void report(const char* label, G4int nTotal, G4double seconds) {
+  G4cout << " " << label << " : " << seconds << " s, "
+	 << (seconds>0. ? nTotal/seconds/1e6 : 0.) << " M/s" << G4endl;
+}
+
+
+// Check that pooled objects are constructed correctly
+
+void testContents() {
+  G4ThreeVector k(1.,2.,3.);
+  G4CMPPhononTrackInfo* pinfo = new G4CMPPhononTrackInfo(lattice, k);
+  if (pinfo->k() != k || pinfo->Lattice() != lattice) {
+    G4cerr << " PHONON TRACK INFO CONTENTS WRONG" << G4endl;
+    nErrors++;
+  }
+  delete pinfo;
+
+  G4CMPDriftTrackInfo* dinfo = new G4CMPDriftTrackInfo(lattice, 0);
+  if (dinfo->ValleyIndex() != 0 || dinfo->Lattice() != lattice) {
+    G4cerr << " DRIFT TRACK INFO CONTENTS WRONG" << G4endl;
+    nErrors++;
+  }
+  delete dinfo;
+}
+
+
+// Main test is here
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    G4cerr << "Usage: " << argv[0] << " <N> <Lattice> [batch]" << G4endl;
+    ::exit(1);
+  }
+
+  G4int nTotal = atoi(argv[1]);
+  G4String lname = argv[2];
+  G4String mname = "G4_"+lname;
+  G4int batch = (argc>3) ? atoi(argv[3]) : 10000;
+  if (batch <= 0) batch = 1;
+
+  // MUST USE 'new', SO THAT G4SolidStore CAN DELETE
+  G4Material* mat = G4NistManager::Instance()->FindOrBuildMaterial(mname);
+  G4Tubs* crystal = new G4Tubs("Crystal", 0., 5.*cm, 1.*cm, 0., 360.*deg);
+  G4LogicalVolume* lv = new G4LogicalVolume(crystal, mat, crystal->GetName());
+  G4PVPlacement* pv = new G4PVPlacement(0, G4ThreeVector(), lv, lv->GetName(),
+					0, false, 1);
+
+  lattice = G4LatticeManager::Instance()->LoadLattice(pv,lname);
+
+  testContents();
+
+  G4ThreeVector k(0.,0.,1.);
+  G4int nValley = lattice->NumberOfValleys();
+
+  G4cout << "Allocating " << nTotal << " objects in batches of " << batch
+	 << G4endl;
+
+  // Run pooled allocations twice, so that second pass reuses pages
+  timeAllocation<G4CMPPhononTrackInfo>(nTotal, batch, [&](G4int) {
+      return new G4CMPPhononTrackInfo(lattice, k); });
+
+  report("G4CMPPhononTrackInfo (pooled)", nTotal,
+	 timeAllocation<G4CMPPhononTrackInfo>(nTotal, batch, [&](G4int) {
+	     return new G4CMPPhononTrackInfo(lattice, k); }));
+
+  report("Phonon-size block (heap)     ", nTotal,
+	 timeAllocation<PhononBlock>(nTotal, batch, [](G4int i) {
+	     auto b = new PhononBlock; b->data[0] = char(i); return b; }));
+
+  timeAllocation<G4CMPDriftTrackInfo>(nTotal, batch, [&](G4int i) {
+      return new G4CMPDriftTrackInfo(lattice, i%nValley); });
+
+  report("G4CMPDriftTrackInfo (pooled) ", nTotal,
+	 timeAllocation<G4CMPDriftTrackInfo>(nTotal, batch, [&](G4int i) {
+	     return new G4CMPDriftTrackInfo(lattice, i%nValley); }));
+
+  report("Drift-size block (heap)      ", nTotal,
+	 timeAllocation<DriftBlock>(nTotal, batch, [](G4int i) {
+	     auto b = new DriftBlock; b->data[0] = char(i); return b; }));
+
+  return nErrors;
+}
@@ -0,0 +1,58 @@
+//
+//  g4cmpHitsToCSV -- Convert binary G4CMP hit files to CSV text
+//
+//  Usage: g4cmpHitsToCSV <hits-file> [csv-file]
+//
+//  Reads event blocks written by G4CMPHitWriter and writes one line per
+//  hit, with the same columns as the examples' text hit output.  If no
+//  output file is given, text is written to standard output.
+//
+//  20201105  New utility for binary hit output
+
+#include "G4CMPHitReader.hh"
+#include <fstream>
+#include <iostream>
+#include <stdlib.h>
+using namespace std;
+
+
+int main(int argc, const char* argv[]) {
+  if (argc < 2) {
+    cerr << "Usage: " << argv[0] << " <hits-file> [csv-file]" << endl;
+    ::exit(1);
+  }
+
+  G4CMPHitReader reader;
+  if (!reader.Open(argv[1])) {
+    cerr << argv[0] << " Unable to read hits from " << argv[1] << endl;
+    ::exit(2);
+  }
+
+  ofstream csvFile;
+  if (argc > 2) {
+    csvFile.open(argv[2], ios::trunc);
+    if (!csvFile.good()) {
+      cerr << argv[0] << " Unable to open " << argv[2] << endl;
+      ::exit(3);
+    }
+  }
+
+  ostream& csv = (argc > 2) ? csvFile : cout;
+
+  G4CMPHitReader::WriteCSVHeader(csv);
+
+  G4CMPHitReader::Block block;
+  size_t nEvents = 0, nHits = 0;
+  while (reader.ReadBlock(block)) {
+    reader.WriteCSV(csv, block);
+    nEvents++;
+    nHits += block.nHits;
+  }
+
+  if (argc > 2) {
+    cout << argv[0] << " wrote " << nHits << " hits from " << nEvents
+	 << " events to " << argv[2] << endl;
+  }
+
+  return 0;
+}